@@ -28,6 +28,9 @@
 #define SDI_MAX_NAME_LEN NAME_MAX
 #define SDI_MOD          "SDI_SYS_MODULE"
 
+#define SDI_RESOURCE_TYPES         7  /**< number of resource types, see sdi_resource_names */
+#define SDI_RESOURCE_ALIAS_BUCKETS 32 /**< buckets of the alias index of an entity, power of 2 */
+
 #define SDI_ERRNO_LOG()                    EV_LOG_ERRNO(ev_log_t_BOARD, 3, SDI_MOD, errno)
 #define SDI_ERRMSG_LOG(format, args ...)   EV_LOG_ERR(ev_log_t_BOARD, 3, SDI_MOD, format, args)
 #define SDI_TRACEMSG_LOG(format, args ...) EV_LOG_TRACE(ev_log_t_BOARD, 3, SDI_MOD, format, args)
@@ -36,6 +39,12 @@
 #define STD_ERR_UNIMPLEMENTED STD_ERR_MK(e_std_err_BOARD, e_std_err_code_FAIL, ENOSYS)
 
 
+/** An opaque handle to pre-resolved SysFs attribute. */
+typedef struct sdi_sysfs_attr_s *sdi_sysfs_hdl_t;
+
+/** An opaque handle to SysFs attribute kept up to date by the watcher. */
+typedef struct sdi_sysfs_watch_s *sdi_sysfs_watch_hdl_t;
+
 /**
  * @defgroup sdi_entity_presence_t
  * List of the entity presence type.
@@ -50,11 +59,12 @@ typedef enum {
  * Used to hold presence info for the entity.
  */
 typedef struct sdi_entity_presence_s {
-    sdi_entity_presence_type_t type;    /**< presence type of the entity */
-    char                       path[PATH_MAX]; /**< path to the "presence" SysFs attribute */
-    char                       name[SDI_MAX_NAME_LEN]; /**< name of the "presence" SysFs attribute */
-    char                       present[SDI_MAX_NAME_LEN]; /**< value for the "present" state */
-    char                       not_present[SDI_MAX_NAME_LEN]; /**< value for the "not present" state */
+    sdi_entity_presence_type_t type;        /**< presence type of the entity */
+    sdi_sysfs_hdl_t            attr;        /**< "presence" SysFs attribute */
+    sdi_sysfs_watch_hdl_t      watch;       /**< watched "presence" SysFs attribute */
+    bool                       seen;        /**< whether the entity was present on the last check */
+    const char                *present;     /**< value for the "present" state */
+    const char                *not_present; /**< value for the "not present" state */
 } sdi_entity_presence_t;
 
 /**
@@ -62,11 +72,11 @@ typedef struct sdi_entity_presence_s {
  * Used to hold fault status info for the entity.
  */
 typedef struct sdi_entity_status_s {
-    bool is_supported;            /**< flag to check whether "fault status" attribute is supported */
-    char path[PATH_MAX];          /**< path to the "fault status" SysFs attribute */
-    char name[SDI_MAX_NAME_LEN];  /**< name of the "fault status" SysFs attribute */
-    char ok[SDI_MAX_NAME_LEN];    /**< value for the "ok" status */
-    char fault[SDI_MAX_NAME_LEN]; /**< value for the "fault" status */
+    bool                  is_supported;            /**< flag to check whether "fault status" attribute is supported */
+    sdi_sysfs_hdl_t       attr;                    /**< "fault status" SysFs attribute */
+    sdi_sysfs_watch_hdl_t watch;                   /**< watched "fault status" SysFs attribute */
+    const char           *ok;                      /**< value for the "ok" status */
+    const char           *fault;                   /**< value for the "fault" status */
 } sdi_entity_status_t;
 
 /**
@@ -74,14 +84,13 @@ typedef struct sdi_entity_status_s {
  * Used to hold power info for the PSU entity.
  */
 typedef struct sdi_entity_power_s {
-    bool             is_supported;             /**< flag to check whether "power" attribute is supported */
-    sdi_power_type_t type;                     /**< supported power types (AC and/or DC) */
-    char             status_path[PATH_MAX];    /**< path to the "power status" SysFs attribute */
-    char             status_name[SDI_MAX_NAME_LEN]; /**< name of the "power status" SysFs attribute */
-    char             status_present[SDI_MAX_NAME_LEN]; /**< value for the "present" power status */
-    char             status_not_present[SDI_MAX_NAME_LEN]; /**< value for the "not present" power status */
-    char             rating_path[PATH_MAX];    /**< path to the "power rating" SysFs attribute */
-    char             rating_name[SDI_MAX_NAME_LEN]; /**< name of the "power rating" SysFs attribute */
+    bool                  is_supported;             /**< flag to check whether "power" attribute is supported */
+    sdi_power_type_t      type;                     /**< supported power types (AC and/or DC) */
+    sdi_sysfs_hdl_t       status_attr;              /**< "power status" SysFs attribute */
+    sdi_sysfs_watch_hdl_t status_watch;             /**< watched "power status" SysFs attribute */
+    const char           *status_present;           /**< value for the "present" power status */
+    const char           *status_not_present;       /**< value for the "not present" power status */
+    sdi_sysfs_hdl_t       rating_attr;              /**< "power rating" SysFs attribute, NULL if not supported */
 } sdi_entity_power_t;
 
 /**
@@ -89,17 +98,33 @@ typedef struct sdi_entity_power_s {
  * Used to hold the power control info for the entity.
  */
 typedef struct sdi_entity_powerctl_s {
-    char path[PATH_MAX];                /**< path to the SysFs attributes for power reset or control*/
-    char reset[SDI_MAX_NAME_LEN];       /**< name of the SysFs attribute for component reset */
-    char powerhdl[SDI_MAX_NAME_LEN];    /**< name of the SysFs attribute for component power on/off operations */
-    char power_on[SDI_MAX_NAME_LEN];    /**< value for the "ON" power status */
-    char power_off[SDI_MAX_NAME_LEN];   /**< value for the "OFF" power status */
+    sdi_sysfs_hdl_t reset;                       /**< SysFs attribute for component reset, NULL if not supported */
+    sdi_sysfs_hdl_t powerhdl;                    /**< SysFs attribute for component power on/off operations,
+                                                      NULL if not supported */
+    const char     *power_on;                    /**< value for the "ON" power status */
+    const char     *power_off;                   /**< value for the "OFF" power status */
 } sdi_entity_powerctl_t;
 
 
+/**
+ * @struct sdi_entity_cold_t
+ * Part of the entity only needed by the registration, the lookups and the power control.
+ */
+typedef struct sdi_entity_cold_s {
+    const char           *name;                                 /**< name of the entity */
+    sdi_entity_powerctl_t power_ctl;                            /**< entity reset and power control */
+    uint_t                resource_size;                        /**< allocated slots of the resource list */
+    uint_t                resource_type_size[SDI_RESOURCE_TYPES]; /**< allocated slots of each type */
+    struct sdi_resource  *by_alias[SDI_RESOURCE_ALIAS_BUCKETS]; /**< resources by the hash of their alias */
+    uint32_t              digest;                               /**< digest of the entity config, resources excluded */
+} sdi_entity_cold_t;
+
 /**
  * @struct sdi_entity
  * Entity data structure which contains details of an entity.
+ *
+ * Holds what the getters and the iterations touch, the rest is in the cold part.
+ * Entities are allocated next to each other, see sdi_entity_arena_alloc().
  */
 struct sdi_entity {
     sdi_entity_type_t     type;             /**< type of the entity */
@@ -107,10 +132,14 @@ struct sdi_entity {
     sdi_entity_presence_t presence;         /**< entity presence info */
     sdi_entity_status_t   status;           /**< entity fault status info */
     sdi_entity_power_t    power;            /**< entity power info */
-    char                  name[SDI_MAX_NAME_LEN]; /**< name of the entity */
+    uint_t                status_state;     /**< status last reported by sdi_entity_status_snapshot() */
+    uint_t                status_gen;       /**< generation of the reported status, bumped on each change */
     sdi_resource_hdl_t    entity_info_hdl;  /**< entity_info handler of the entity */
-    std_dll_head         *resource_list;    /**< list of resources that are part of this entity */
-    sdi_entity_powerctl_t power_ctl;        /**< entity reset and power control */
+    uint_t                resource_total;   /**< number of resources */
+    sdi_resource_hdl_t   *resource_list;    /**< resources that are part of this entity, in the order added */
+    sdi_resource_hdl_t   *resources[SDI_RESOURCE_TYPES];      /**< resources of each type, in list order */
+    uint_t                resource_count[SDI_RESOURCE_TYPES]; /**< number of resources of each type */
+    sdi_entity_cold_t    *cold;             /**< rarely accessed part of the entity */
 };
 
 /** An opaque handle to entity. */
@@ -121,33 +150,55 @@ typedef struct sdi_entity *sdi_entity_priv_hdl_t;
  * Used to hold entity related data.
  */
 typedef struct sdi_entity_node {
-    std_dll          node;       /**< node to an entity */
-    sdi_entity_hdl_t entity_hdl; /**< entity specific data */
+    sdi_entity_hdl_t        entity_hdl; /**< entity specific data */
+    struct sdi_entity_node *name_next;  /**< next entity in the same bucket of the name index */
 } sdi_entity_node_t;
 
+/**
+ * @struct sdi_resource_cold_t
+ * Part of the resource only needed by the registration and the lookups.
+ */
+typedef struct sdi_resource_cold_s {
+    const char          *name;       /**< name of the resource */
+    const char          *alias;      /**< alias name of the resource */
+    const char          *reference;  /**< reference name of the resource */
+    struct sdi_resource *alias_next; /**< next resource in the same bucket of the alias index */
+    uint32_t             digest;     /**< digest of the resource config and its settings */
+} sdi_resource_cold_t;
+
 /**
  * @struct sdi_resource
  * Resource data structure which contains details of the resource.
+ *
+ * Resources of an entity are allocated next to each other, so iterating them walks
+ * adjacent records.
  */
 struct sdi_resource {
-    char                name[SDI_MAX_NAME_LEN]; /**< name of the resource */
-    sdi_resource_type_t type;         /**< type of the resource */
-    char                alias[SDI_MAX_NAME_LEN]; /**< alias name of the resource */
-    char                reference[SDI_MAX_NAME_LEN]; /**< reference name of the resource */
-    void               *settings;     /**< pointer to settings of the resource */
+    sdi_resource_type_t  type;     /**< type of the resource */
+    uint_t               index;    /**< position among the resources of its type */
+    uint_t               seq;      /**< position in the resource list of the entity */
+    void                *settings; /**< pointer to settings of the resource, see sdi_resource_settings_copy() */
+    struct sdi_entity   *entity;   /**< entity the resource belongs to */
+    sdi_resource_cold_t *cold;     /**< rarely accessed part of the resource */
 };
 
 /** An opaque handle to resource. */
 typedef struct sdi_resource *sdi_resource_priv_hdl_t;
 
 /**
- * @struct sdi_entity_resource_node_t
- * Used to hold resource related data.
+ * Copies the settings of the resource.
+ *
+ * sdi_config_reload() may replace and release them while the resource is used, so
+ * callers work on a copy. A resource of another type gets a zeroed copy.
+ *
+ * hdl[in] - handle of the resource.
+ * type[in] - type of the resource the settings are of.
+ * settings[out] - copy of the settings.
+ * size[in] - size of the settings.
+ *
+ * return None.
  */
-typedef struct sdi_entity_resource_node {
-    std_dll            node; /**< node to an resource */
-    sdi_resource_hdl_t hdl; /**< resource specific data */
-} sdi_entity_resource_node_t;
+void sdi_resource_settings_copy(sdi_resource_priv_hdl_t hdl, sdi_resource_type_t type, void *settings, size_t size);
 
 /**
  * Initializes internal data structures for the entity and creates entity-db.
@@ -159,6 +210,42 @@ typedef struct sdi_entity_resource_node {
  */
 void sdi_register_entities(const char * entity_cfg_file);
 
+/**
+ * Builds the full path of SDI config file.
+ *
+ * Config files are looked up in the directory set by SDI_CONFIG_DIR environment
+ * variable, /etc/opx/sdi by default.
+ *
+ * file[in] - name of the config file.
+ * buf[out] - buffer for the path.
+ * size[in] - size of the buffer.
+ *
+ * return None.
+ */
+void sdi_config_file_get(const char *file, char *buf, size_t size);
+
+/**
+ * Forgets the last values written to the entity and its resources.
+ *
+ * Called when the entity is re-inserted, since the new hardware doesn't have them.
+ *
+ * hdl[in] - handle of the entity.
+ *
+ * return None.
+ */
+void sdi_entity_shadow_invalidate(sdi_entity_priv_hdl_t hdl);
+
+/**
+ * Adds the entity registered at runtime to the entities watched for hotplug.
+ *
+ * Entities registered before sdi_entity_hotplug_start() are picked up by it.
+ *
+ * entity_hdl[in] - handle of the entity.
+ *
+ * return None.
+ */
+void sdi_entity_hotplug_track(sdi_entity_hdl_t entity_hdl);
+
 /**
  * Registers settings for the specified LED resource.
  *
@@ -169,6 +256,24 @@ void sdi_register_entities(const char * entity_cfg_file);
  */
 void sdi_led_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t led_node);
 
+/**
+ * Waits until the states queued for the LED are written.
+ *
+ * hdl[in] - handle of the resource.
+ *
+ * return result of the last write.
+ */
+t_std_error sdi_led_write_flush(sdi_resource_priv_hdl_t hdl);
+
+/**
+ * Forgets the last state written to the LED, so the next on/off reaches the hardware.
+ *
+ * hdl[in] - handle of the resource.
+ *
+ * return None.
+ */
+void sdi_led_shadow_invalidate(sdi_resource_priv_hdl_t hdl);
+
 /**
  * Registers settings for the specified EEPROM info resource.
  *
@@ -193,6 +298,24 @@ void sdi_info_register_settings(sdi_resource_priv_hdl_t hdl,
 void sdi_fan_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t fan_node);
 
 
+/**
+ * Waits until the speeds queued for the fan are written.
+ *
+ * hdl[in] - handle of the resource.
+ *
+ * return result of the last write.
+ */
+t_std_error sdi_fan_write_flush(sdi_resource_priv_hdl_t hdl);
+
+/**
+ * Forgets the last speed written to the fan, so the next speed set reaches the hardware.
+ *
+ * hdl[in] - handle of the resource.
+ *
+ * return None.
+ */
+void sdi_fan_shadow_invalidate(sdi_resource_priv_hdl_t hdl);
+
 /*
  * Gets the maximum speed of the fan refered by resource.
  *
@@ -0,0 +1,181 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_config_snapshot.h
+ * \brief Precompiled binary snapshot of entity.xml and device.xml
+ *****************************************************************************/
+#ifndef __SDI_CONFIG__SNAPSHOT_H
+#define __SDI_CONFIG__SNAPSHOT_H
+
+#include "sdi_common.h"
+
+#define SDI_CONFIG_SNAPSHOT_FILE    "platform.sdb" /**< snapshot next to entity.xml and device.xml */
+#define SDI_CONFIG_SNAPSHOT_MAGIC   "SDISNAP"      /**< first 8 bytes of the snapshot, terminator included */
+#define SDI_CONFIG_SNAPSHOT_VERSION 1              /**< version of the snapshot format */
+#define SDI_CONFIG_SNAPSHOT_NONE    0xffffffffu    /**< index of a missing node */
+#define SDI_CONFIG_DIGEST_INIT      2166136261u    /**< digest of no config nodes */
+
+/**
+ * @defgroup sdi_config_snapshot_root_t
+ * Config files held by the snapshot.
+ */
+typedef enum {
+    SDI_CONFIG_SNAPSHOT_ENTITY = 0, /**< root of entity.xml */
+    SDI_CONFIG_SNAPSHOT_DEVICE = 1, /**< root of device.xml */
+    SDI_CONFIG_SNAPSHOT_ROOTS  = 2  /**< number of the roots */
+} sdi_config_snapshot_root_t;
+
+/**
+ * @struct sdi_config_snapshot_hdr_t
+ * Header of the snapshot.
+ *
+ * The header is followed by node_count nodes, attr_count attributes and strings_size
+ * bytes of NUL-terminated strings. Nodes and attributes refer to each other by index
+ * and to the strings by their offset in the string table, so the file is used as
+ * mapped at any address. All integers are in the host byte order, a snapshot compiled
+ * for the other one fails the version check.
+ */
+typedef struct sdi_config_snapshot_hdr_s {
+    char     magic[8];                         /**< SDI_CONFIG_SNAPSHOT_MAGIC */
+    uint32_t version;                          /**< SDI_CONFIG_SNAPSHOT_VERSION */
+    uint32_t size;                             /**< size of the file */
+    uint32_t crc;                              /**< CRC-32 (as zlib) of everything after the header */
+    uint32_t node_count;                       /**< number of the nodes */
+    uint32_t attr_count;                       /**< number of the attributes */
+    uint32_t strings_size;                     /**< size of the string table */
+    uint32_t roots[SDI_CONFIG_SNAPSHOT_ROOTS]; /**< index of the root node of each config file */
+} sdi_config_snapshot_hdr_t;
+
+/**
+ * @struct sdi_config_snapshot_node_t
+ * XML element in the snapshot.
+ */
+typedef struct sdi_config_snapshot_node_s {
+    uint32_t tag;        /**< offset of the element name */
+    uint32_t attr;       /**< index of the first attribute */
+    uint32_t attr_count; /**< number of the attributes */
+    uint32_t child;      /**< index of the first child, SDI_CONFIG_SNAPSHOT_NONE if none */
+    uint32_t next;       /**< index of the next sibling, SDI_CONFIG_SNAPSHOT_NONE if none */
+} sdi_config_snapshot_node_t;
+
+/**
+ * @struct sdi_config_snapshot_attr_t
+ * XML attribute in the snapshot.
+ */
+typedef struct sdi_config_snapshot_attr_s {
+    uint32_t name;  /**< offset of the attribute name */
+    uint32_t value; /**< offset of the attribute value */
+} sdi_config_snapshot_attr_t;
+
+/**
+ * @struct sdi_config_snapshot_tables_t
+ * Tables of the snapshot, either mapped or compiled into the library.
+ */
+typedef struct sdi_config_snapshot_tables_s {
+    const sdi_config_snapshot_node_t *nodes;                            /**< node table */
+    const sdi_config_snapshot_attr_t *attrs;                            /**< attribute table */
+    const char                       *strings;                          /**< string table */
+    uint32_t                          node_count;                       /**< number of the nodes */
+    uint32_t                          roots[SDI_CONFIG_SNAPSHOT_ROOTS]; /**< index of each root node */
+} sdi_config_snapshot_tables_t;
+
+/**
+ * Maps the snapshot read-only.
+ *
+ * The snapshot is used only if it is not older than any of the config files it was
+ * compiled from (missing files are ignored) and its header, bounds and checksum are
+ * valid. Otherwise the caller is expected to parse the config files.
+ *
+ * file[in] - path to the snapshot.
+ * entity_file[in] - path to entity.xml.
+ * device_file[in] - path to device.xml.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_config_snapshot_open(const char *file, const char *entity_file, const char *device_file);
+
+/**
+ * Uses the tables compiled into the library instead of a snapshot file.
+ *
+ * Only the library built with a platform's configs (--with-platform-config, which
+ * defines SDI_CONFIG_BUILTIN) has them. They are released by
+ * sdi_config_snapshot_close() like the mapped snapshot.
+ *
+ * return STD_ERR_OK on success, error if the library was built without them.
+ */
+t_std_error sdi_config_snapshot_builtin_open(void);
+
+/**
+ * Gets the root node of the config file held by the open snapshot.
+ *
+ * root[in] - config file.
+ *
+ * return root node.
+ */
+std_config_node_t sdi_config_snapshot_root_get(sdi_config_snapshot_root_t root);
+
+/**
+ * Unmaps the snapshot, its nodes and strings must not be used afterwards.
+ *
+ * return None.
+ */
+void sdi_config_snapshot_close(void);
+
+/**
+ * Gets the first child of the config node, either parsed XML or snapshot node.
+ *
+ * node[in] - config node.
+ *
+ * return first child or NULL if none.
+ */
+std_config_node_t sdi_config_get_child(std_config_node_t node);
+
+/**
+ * Gets the next sibling of the config node.
+ *
+ * node[in] - config node.
+ *
+ * return next sibling or NULL if none.
+ */
+std_config_node_t sdi_config_next_node(std_config_node_t node);
+
+/**
+ * Gets the value of the attribute of the config node.
+ *
+ * node[in] - config node.
+ * attr[in] - name of the attribute.
+ *
+ * return value of the attribute or NULL if it is missing.
+ */
+const char * sdi_config_attr_get(std_config_node_t node, const char *attr);
+
+/**
+ * Gets the element name of the config node.
+ *
+ * node[in] - config node.
+ *
+ * return element name.
+ */
+const char * sdi_config_name_get(std_config_node_t node);
+
+/**
+ * Folds the config node into a digest of the config.
+ *
+ * Covers the element name and the attributes read by the registration code, so
+ * parsed XML and snapshot nodes of the same config fold the same and comments or
+ * unknown attributes don't count as a change.
+ *
+ * hash[in] - digest so far, SDI_CONFIG_DIGEST_INIT to start.
+ * node[in] - config node.
+ * subtree[in] - whether the children are folded too.
+ *
+ * return updated digest.
+ */
+uint32_t sdi_config_digest(uint32_t hash, std_config_node_t node, bool subtree);
+
+#endif /* __SDI_CONFIG__SNAPSHOT_H */
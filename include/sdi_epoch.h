@@ -0,0 +1,59 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_epoch.h
+ * \brief Epoch-based reclamation of data read without locks
+ *****************************************************************************/
+#ifndef __SDI__EPOCH_H
+#define __SDI__EPOCH_H
+
+#include "sdi_common.h"
+
+/**
+ * Releases retired data.
+ *
+ * ptr[in] - data passed to sdi_epoch_retire().
+ *
+ * return None.
+ */
+typedef void (*sdi_epoch_release_fn_t)(void *ptr);
+
+/**
+ * Enters a read-side section.
+ *
+ * Data loaded from a shared pointer inside the section stays valid until the section
+ * is left, even if a writer replaces and retires it meanwhile. Sections nest and take
+ * no locks, but a reader staying in one holds back the release of everything retired
+ * after it entered.
+ *
+ * return None.
+ */
+void sdi_epoch_enter(void);
+
+/**
+ * Leaves the read-side section entered last by the calling thread.
+ *
+ * return None.
+ */
+void sdi_epoch_exit(void);
+
+/**
+ * Releases the data once no reader may still hold it.
+ *
+ * To be called after the data was unpublished, i.e. no new reader can load it. The
+ * data is released by this or a later call, once every section entered before it
+ * was left.
+ *
+ * ptr[in] - data to release.
+ * release[in] - function releasing the data.
+ *
+ * return None.
+ */
+void sdi_epoch_retire(void *ptr, sdi_epoch_release_fn_t release);
+
+#endif /* __SDI__EPOCH_H */
@@ -0,0 +1,49 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_executor.h
+ * \brief Work-stealing executor of independent hardware operations
+ *****************************************************************************/
+#ifndef __SDI__EXECUTOR_H
+#define __SDI__EXECUTOR_H
+
+#include "sdi_common.h"
+
+#define SDI_EXECUTOR_WORKERS 7 /**< threads of the pool, the calling thread works too */
+
+/**
+ * Operation executed for each item.
+ *
+ * index[in] - index of the item, from 0 to count - 1.
+ * data[in] - user data passed to sdi_executor_run().
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+typedef t_std_error (*sdi_executor_fn_t)(uint_t index, void *data);
+
+/**
+ * Calls the function for each item on up to concurrency threads and waits for all.
+ *
+ * The items are split into equal ranges, one per thread. A thread which finishes its
+ * range steals half of the remaining items of another one, so a few slow items don't
+ * hold the others back. The calling thread executes items too, so it also works when
+ * called from the function itself or while the pool is busy with other callers.
+ *
+ * count[in] - number of items.
+ * concurrency[in] - maximal number of threads executing the items, the caller
+ *                   included; 0 for SDI_EXECUTOR_WORKERS + 1, 1 to run them in order
+ *                   on the caller.
+ * fn[in] - operation executed for each item.
+ * data[in] - user data passed to the function.
+ *
+ * return STD_ERR_OK if the function succeeded for all the items, otherwise the error
+ * of the failed item with the lowest index.
+ */
+t_std_error sdi_executor_run(uint_t count, uint_t concurrency, sdi_executor_fn_t fn, void *data);
+
+#endif /* __SDI__EXECUTOR_H */
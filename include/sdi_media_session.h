@@ -0,0 +1,26 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_media_session.h
+ * \brief SXD session shared by the media accesses
+ *****************************************************************************/
+#ifndef __SDI_MEDIA__SESSION_H
+#define __SDI_MEDIA__SESSION_H
+
+#include "sdi_sys_ext.h"
+
+/**
+ * Retrieves the state of the SXD session shared by all media accesses.
+ *
+ * info[out] - state and counters of the session.
+ *
+ * return None.
+ */
+void sdi_media_sxd_session_get(sdi_sxd_session_info_t *info);
+
+#endif /* __SDI_MEDIA__SESSION_H */
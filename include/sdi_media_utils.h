@@ -14,6 +14,7 @@
 
 #include "sdi_common.h"
 #include "sdi_media.h"
+#include "sdi_media_session.h"
 #include <sx/sxd/sxd_dpt.h>
 #include <sx/sxd/sxd_access_register.h>
 
@@ -0,0 +1,50 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_string_pool.h
+ * \brief Process-wide pool of interned names, values and paths
+ *****************************************************************************/
+#ifndef __SDI_STRING__POOL_H
+#define __SDI_STRING__POOL_H
+
+#include "sdi_common.h"
+
+/**
+ * @struct sdi_string_pool_usage_t
+ * Memory used by the string pool.
+ */
+typedef struct sdi_string_pool_usage_s {
+    uint_t   strings;   /**< number of distinct strings */
+    uint64_t requests;  /**< number of interned strings, duplicates included */
+    size_t   bytes;     /**< bytes of the distinct strings, terminators included */
+    size_t   saved;     /**< bytes a private copy of each duplicate would have taken */
+    size_t   allocated; /**< bytes allocated by the pool, index included */
+} sdi_string_pool_usage_t;
+
+/**
+ * Returns the interned copy of the string.
+ *
+ * Equal strings share one copy, so the returned pointers may be compared instead
+ * of the strings. Copies are never freed and never modified.
+ *
+ * str[in] - string to intern.
+ *
+ * return interned copy of the string, valid for the life of the process.
+ */
+const char * sdi_string_intern(const char *str);
+
+/**
+ * Reports the memory used by the pool.
+ *
+ * usage[out] - memory used by the pool.
+ *
+ * return None.
+ */
+void sdi_string_pool_usage_get(sdi_string_pool_usage_t *usage);
+
+#endif /* __SDI_STRING__POOL_H */
@@ -0,0 +1,434 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_sys_ext.h
+ * \brief SDI API extensions provided by the Mellanox SDI implementation
+ *
+ * The SDI API of this implementation, extensions included, may be called from any
+ * number of threads once sdi_sys_init() returned. Entity lookups and iterations read
+ * a snapshot of the entity database without taking locks, entities added meanwhile
+ * show up in the next call. Entity and resource handles stay valid for the life of
+ * the process. Per-resource state changed at runtime (e.g. thermal thresholds) is
+ * guarded by a lock of its own, and the SysFs attribute handles synchronize their
+ * descriptors and shadowed values themselves.
+ *****************************************************************************/
+#ifndef __SDI_SYS_EXT_H
+#define __SDI_SYS_EXT_H
+
+#include "std_error_codes.h"
+#include "std_type_defs.h"
+#include "sdi_entity.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup sdi_hotplug_event_t
+ * List of the entity hotplug events.
+ */
+typedef enum {
+    SDI_HOTPLUG_INSERTED, /**< entity became present */
+    SDI_HOTPLUG_REMOVED,  /**< entity became not present */
+    SDI_HOTPLUG_CHANGED   /**< state of the entity (e.g. fault or power status) may have changed */
+} sdi_hotplug_event_t;
+
+/**
+ * Callback, which is called on entity hotplug events.
+ *
+ * It is called from the hotplug thread after the cached state of the entity was
+ * dropped, so the entity getters return fresh values. It must not call the
+ * sdi_entity_hotplug_* functions.
+ *
+ * entity_hdl[in] - handle of the entity.
+ * event[in] - hotplug event.
+ * data[in] - user data passed to sdi_entity_hotplug_cb_register().
+ *
+ * return None.
+ */
+typedef void (*sdi_entity_hotplug_cb_t)(sdi_entity_hdl_t entity_hdl, sdi_hotplug_event_t event, void *data);
+
+/**
+ * Registers callback for the entity hotplug events.
+ *
+ * cb[in] - callback.
+ * data[in] - user data passed to the callback.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_entity_hotplug_cb_register(sdi_entity_hotplug_cb_t cb, void *data);
+
+/**
+ * Starts listening to the kernel uevents for entity hotplug.
+ *
+ * Uevents are matched to the entities by the devices of their presence, fault status
+ * and power status SysFs attributes. Must be called after sdi_sys_init().
+ *
+ * fd[in] - descriptor delivering uevent messages (e.g. one end of a socketpair() in
+ *          tests), -1 to open the kernel uevent netlink socket.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_entity_hotplug_start(int fd);
+
+/**
+ * Stops listening to the kernel uevents.
+ *
+ * return None.
+ */
+void sdi_entity_hotplug_stop(void);
+
+/**
+ * Retrieves the handle of the entity by its name (alias).
+ *
+ * The name is the alias of the entity in the entity config file, e.g. "PSU1", or
+ * "<type>-<instance>" when the alias is not set.
+ *
+ * name[in] - name of the entity.
+ *
+ * return the handle to the entity, NULL if entity is not found.
+ */
+sdi_entity_hdl_t sdi_entity_lookup_by_name(const char *name);
+
+/**
+ * Function called for each entity by sdi_entity_for_each_parallel().
+ *
+ * hdl[in] - handle of the entity.
+ * user_data[in] - user data passed to sdi_entity_for_each_parallel().
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+typedef t_std_error (*sdi_entity_parallel_fn_t)(sdi_entity_hdl_t hdl, void *user_data);
+
+/**
+ * Function called for each resource by sdi_entity_for_each_resource_parallel().
+ *
+ * hdl[in] - handle of the resource.
+ * user_data[in] - user data passed to sdi_entity_for_each_resource_parallel().
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+typedef t_std_error (*sdi_resource_parallel_fn_t)(sdi_resource_hdl_t hdl, void *user_data);
+
+/**
+ * Runs the function on every entity, on up to concurrency threads at once.
+ *
+ * Same as sdi_entity_for_each(), but the calls for different entities overlap, so
+ * slow accesses to independent FRUs (presence probes, EEPROM reads) don't add up.
+ * The function must be safe to call concurrently for different entities. Returns
+ * when all the calls are done.
+ *
+ * fn[in] - function that would be called for each entity.
+ * user_data[in] - user data that will be passed to the function.
+ * concurrency[in] - maximal number of concurrent calls (the calling thread makes
+ *                   some of them), 0 for the default of 8, 1 for sdi_entity_for_each()
+ *                   order on the calling thread.
+ *
+ * return STD_ERR_OK if all the calls succeeded, otherwise the error of the first
+ * failed entity in the order of sdi_entity_for_each().
+ */
+t_std_error sdi_entity_for_each_parallel(sdi_entity_parallel_fn_t fn, void *user_data, uint_t concurrency);
+
+/**
+ * Runs the function on each resource of the entity, on up to concurrency threads at once.
+ *
+ * Same as sdi_entity_for_each_resource(), with the calls overlapping as in
+ * sdi_entity_for_each_parallel().
+ *
+ * hdl[in] - handle of the entity.
+ * fn[in] - function that would be called for each resource.
+ * user_data[in] - user data that will be passed to the function.
+ * concurrency[in] - maximal number of concurrent calls, 0 for the default.
+ *
+ * return STD_ERR_OK if all the calls succeeded, otherwise the error of the first
+ * failed resource in the order of sdi_entity_for_each_resource().
+ */
+t_std_error sdi_entity_for_each_resource_parallel(sdi_entity_hdl_t hdl, sdi_resource_parallel_fn_t fn,
+                                                  void *user_data, uint_t concurrency);
+
+/**
+ * @struct sdi_entity_status_entry_t
+ * Status of one entity, as filled by sdi_entity_status_snapshot().
+ */
+typedef struct sdi_entity_status_entry_s {
+    sdi_entity_hdl_t hdl;          /**< handle of the entity */
+    t_std_error      rc;           /**< STD_ERR_OK if the status was read, otherwise the first error */
+    bool             presence;     /**< as sdi_entity_presence_get() */
+    bool             fault;        /**< as sdi_entity_fault_status_get() */
+    bool             power_status; /**< as sdi_entity_psu_output_power_status_get(), false for other entities */
+    uint_t           generation;   /**< changes whenever the status or rc of the entity changes */
+} sdi_entity_status_entry_t;
+
+/**
+ * Gets the presence, fault and PSU output power status of all the entities at once.
+ *
+ * Same results as the separate getters, in the order of sdi_entity_for_each(). The
+ * values cached by the SysFs watcher are used as they are, the attributes without
+ * one are read together in a single batch. A poller may compare the generation of
+ * an entry with the one seen last time and skip the entities which didn't change.
+ *
+ * entries[out] - status of each entity.
+ * count[in,out] - number of entries the array can hold; number of entities filled in,
+ *                 or needed if the array is too small.
+ *
+ * return STD_ERR_OK if the status of every entity was read, SDI_ERRCODE(ENOSPC) if
+ * the array is too small (nothing is filled in), otherwise the error of the first
+ * failed entry.
+ */
+t_std_error sdi_entity_status_snapshot(sdi_entity_status_entry_t *entries, uint_t *count);
+
+/**
+ * @defgroup sdi_sxd_session_state_t
+ * List of the states of the SXD session used by the media accesses.
+ */
+typedef enum {
+    SDI_SXD_SESSION_CLOSED = 0, /**< not needed yet, or closed to be reopened after a failed access */
+    SDI_SXD_SESSION_OPEN   = 1, /**< open */
+    SDI_SXD_SESSION_FAILED = 2  /**< the last open failed, retried by the next media access */
+} sdi_sxd_session_state_t;
+
+/**
+ * @struct sdi_sxd_session_info_t
+ * State and counters of the SXD session.
+ */
+typedef struct sdi_sxd_session_info_s {
+    sdi_sxd_session_state_t state;      /**< state of the session */
+    uint_t                  opens;      /**< number of successful opens */
+    uint_t                  failures;   /**< number of failed opens */
+    uint_t                  reconnects; /**< number of closes after a failed access, e.g. SDK restart */
+} sdi_sxd_session_info_t;
+
+/**
+ * Retrieves the state of the SXD session shared by all media accesses.
+ *
+ * The session is opened by the first access to a transceiver, not by sdi_sys_init().
+ * When an access fails, e.g. because the SDK restarted, the session is reopened and
+ * the access retried once.
+ *
+ * info[out] - state and counters of the session.
+ *
+ * return None.
+ */
+void sdi_sys_sxd_session_get(sdi_sxd_session_info_t *info);
+
+/**
+ * Retrieves counters of the LED, fan speed and power control writes.
+ *
+ * A write of the value already held by the hardware is suppressed, unless the value
+ * wasn't refreshed for a while or the entity was re-inserted since.
+ *
+ * written[out] - number of writes that reached the hardware.
+ * suppressed[out] - number of writes suppressed as unchanged.
+ *
+ * return None.
+ */
+void sdi_sys_shadow_stats_get(uint64_t *written, uint64_t *suppressed);
+
+/**
+ * Switches LED and fan speed writes to the asynchronous mode.
+ *
+ * The setters (e.g. sdi_led_on(), sdi_fan_speed_set()) then only queue the value and
+ * return, a dedicated thread writes it to the hardware. Values queued for the same
+ * resource before it gets to them are coalesced, only the last one is written.
+ * Errors of the queued writes are logged and reported by sdi_resource_write_flush().
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sys_async_write_start(void);
+
+/**
+ * Completes the queued writes and switches back to the synchronous writes.
+ *
+ * return None.
+ */
+void sdi_sys_async_write_stop(void);
+
+/**
+ * Waits until all the writes queued so far are completed.
+ *
+ * return None.
+ */
+void sdi_sys_write_flush(void);
+
+/**
+ * Waits until the writes queued for the resource so far are completed.
+ *
+ * resource_hdl[in] - handle of the resource.
+ *
+ * return result of the last write to the resource, STD_ERR_OK if it has no queued writes.
+ */
+t_std_error sdi_resource_write_flush(sdi_resource_hdl_t resource_hdl);
+
+/**
+ * Retrieves the temperature of the chip referred by resource within a deadline.
+ *
+ * The hardware is read on a worker thread, so a hung bus delays the caller no longer
+ * than the deadline. On timeout the last known value is returned with ETIMEDOUT, the
+ * read keeps running and refreshes it. A resource timing out repeatedly is
+ * quarantined: further calls fail with ETIMEDOUT at once, until it responds again.
+ *
+ * resource_hdl[in] - resource handle of the chip.
+ * timeout_ms[in] - time to wait for the chip.
+ * temp[out] - temperature, the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT on timeout (temp is set if the value is
+ * known) and standard error on failure.
+ */
+t_std_error sdi_temperature_get_timed(sdi_resource_hdl_t resource_hdl, uint_t timeout_ms, int *temp);
+
+/**
+ * Retrieves the speed of the fan referred by resource within a deadline.
+ *
+ * Same as sdi_temperature_get_timed(), for sdi_fan_speed_get().
+ *
+ * resource_hdl[in] - resource handle of the fan.
+ * timeout_ms[in] - time to wait for the fan.
+ * speed[out] - speed (in RPM), the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT on timeout and standard error on failure.
+ */
+t_std_error sdi_fan_speed_get_timed(sdi_resource_hdl_t resource_hdl, uint_t timeout_ms, uint_t *speed);
+
+/**
+ * Retrieves the fault status of the fan referred by resource within a deadline.
+ *
+ * Same as sdi_temperature_get_timed(), for sdi_fan_status_get().
+ *
+ * resource_hdl[in] - resource handle of the fan.
+ * timeout_ms[in] - time to wait for the fan.
+ * status[out] - false if the fan is faulty, the last known status on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT on timeout and standard error on failure.
+ */
+t_std_error sdi_fan_status_get_timed(sdi_resource_hdl_t resource_hdl, uint_t timeout_ms, bool *status);
+
+/**
+ * Retrieves the presence of the entity within a deadline.
+ *
+ * The presence is served by the SysFs watcher. Without a watched value the attribute
+ * is read as by sdi_temperature_get_timed(). On timeout the presence is evaluated
+ * from the last known value, an entity never read is reported absent.
+ *
+ * entity_hdl[in] - handle of the entity.
+ * timeout_ms[in] - time to wait for the presence attribute.
+ * presence[out] - true if the entity is present.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT on timeout and standard error on failure.
+ */
+t_std_error sdi_entity_presence_get_timed(sdi_entity_hdl_t entity_hdl, uint_t timeout_ms, bool *presence);
+
+/**
+ * Retrieves the fault status of the entity within a deadline.
+ *
+ * Same as sdi_entity_presence_get_timed(), for sdi_entity_fault_status_get(). An
+ * entity whose status was never read counts as faulty.
+ *
+ * entity_hdl[in] - handle of the entity.
+ * timeout_ms[in] - time to wait for the fault status attribute.
+ * fault[out] - true if the entity has a fault.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT on timeout and standard error on failure.
+ */
+t_std_error sdi_entity_fault_status_get_timed(sdi_entity_hdl_t entity_hdl, uint_t timeout_ms, bool *fault);
+
+/**
+ * Enables or disables collection of the SysFs access statistics.
+ *
+ * For each SysFs attribute the number of reads and writes, the number of failed ones
+ * and a histogram of their latencies are collected. Collection is disabled by default.
+ *
+ * enable[in] - true to enable collection.
+ *
+ * return None.
+ */
+void sdi_sys_stats_enable(bool enable);
+
+/**
+ * Writes the SysFs access statistics as text, one attribute per line, followed by
+ * the memory used by the string pool.
+ *
+ * fd[in] - descriptor to write to.
+ *
+ * return None.
+ */
+void sdi_sys_stats_dump(int fd);
+
+/**
+ * Starts recording all the hardware accesses to the trace file.
+ *
+ * Every SysFs read and write and every MCIA register access is recorded with its time,
+ * latency, result and data. sdi_sys_init() starts the recording itself if
+ * SDI_TRACE_RECORD environment variable names the file.
+ *
+ * file[in] - path to the trace file, truncated if exists.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sys_trace_record_start(const char *file);
+
+/**
+ * Starts serving all the hardware accesses from the trace file.
+ *
+ * The hardware isn't accessed, each access gets the data and the result of the next
+ * recorded access to the same attribute or register. To replay the whole workload,
+ * call it before sdi_sys_init(), which starts the replay itself if SDI_TRACE_REPLAY
+ * environment variable names the file (and SDI_TRACE_TIMED=1 for the timed replay).
+ *
+ * file[in] - path to the trace file.
+ * timed[in] - true to delay each access by its recorded latency.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sys_trace_replay_start(const char *file, bool timed);
+
+/**
+ * Stops the recording or the replay of the hardware accesses.
+ *
+ * Must not be called while the hardware is being accessed.
+ *
+ * return None.
+ */
+void sdi_sys_trace_stop(void);
+
+/**
+ * @struct sdi_config_reload_report_t
+ * Changes found by sdi_config_reload().
+ */
+typedef struct sdi_config_reload_report_s {
+    uint_t entities_added;      /**< entities registered and initialized */
+    uint_t resources_changed;   /**< resources whose settings were replaced */
+    uint_t resources_unchanged; /**< resources whose config is the same */
+    uint_t not_applied;         /**< changes which need a restart, see sdi_config_reload() */
+} sdi_config_reload_report_t;
+
+/**
+ * Applies the edited entity.xml and device.xml without a restart.
+ *
+ * The files are parsed again, every entity is checked the way the registration would
+ * assert on it, and only then the configs are compared with the registered ones.
+ * Entities new in entity.xml are registered, initialized and tracked by the hotplug
+ * monitor. Resources whose config changed switch to new settings at once; a call
+ * racing with the reload uses either the old or the new ones, and the handles stay
+ * valid. Adding or removing resources of a registered entity, removing entities and
+ * changing the presence, fault or power settings of an entity need a restart: these
+ * are logged and counted as not applied. Calls are serialized with each other, the
+ * rest of the API isn't blocked meanwhile.
+ *
+ * report[out] - changes found.
+ *
+ * return STD_ERR_OK on success, SDI_ERRCODE(EINVAL) if a config would fail the
+ * registration and SDI_ERRCODE(ENOENT) if a file can't be parsed, in which cases
+ * nothing is applied.
+ */
+t_std_error sdi_config_reload(sdi_config_reload_report_t *report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SDI_SYS_EXT_H */
@@ -0,0 +1,89 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_sysfs_codec.h
+ * \brief Parsers and formatters of SysFs attribute values
+ *****************************************************************************/
+#ifndef __SDI_SYSFS__CODEC_H
+#define __SDI_SYSFS__CODEC_H
+
+#include "sdi_common.h"
+
+#define SDI_SYSFS_MDEG_DIVIDER 1000 /**< divider to convert millidegrees to degrees (Celsius) */
+
+/**
+ * Parses the unsigned decimal value of SysFs attribute.
+ *
+ * Leading whitespace is skipped and parsing stops at the first non-digit character,
+ * so the trailing newline added by the kernel is accepted.
+ *
+ * buf[in] - raw value read from the attribute.
+ * size[in] - maximum number of characters to look at.
+ * val[out] - parsed value.
+ *
+ * return STD_ERR_OK on success, EIO if there are no digits and ERANGE on overflow.
+ */
+t_std_error sdi_sysfs_codec_uint_parse(const char *buf, size_t size, uint_t *val);
+
+/**
+ * Parses the signed decimal value of SysFs attribute.
+ *
+ * buf[in] - raw value read from the attribute.
+ * size[in] - maximum number of characters to look at.
+ * val[out] - parsed value.
+ *
+ * return STD_ERR_OK on success, EIO if there are no digits and ERANGE on overflow.
+ */
+t_std_error sdi_sysfs_codec_int_parse(const char *buf, size_t size, int *val);
+
+/**
+ * Parses the temperature in millidegrees and converts it to degrees (Celsius).
+ *
+ * buf[in] - raw value read from the attribute.
+ * size[in] - maximum number of characters to look at.
+ * val[out] - temperature in degrees.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_codec_mdeg_parse(const char *buf, size_t size, int *val);
+
+/**
+ * Extracts the first word of the string value of SysFs attribute.
+ *
+ * buf[in] - raw value read from the attribute.
+ * size[in] - maximum number of characters to look at.
+ * val[out] - NUL-terminated word, empty if the value is blank.
+ * val_size[in] - size of the val buffer.
+ *
+ * return STD_ERR_OK on success, ENOBUFS if the word doesn't fit into val.
+ */
+t_std_error sdi_sysfs_codec_str_parse(const char *buf, size_t size, char *val, size_t val_size);
+
+/**
+ * Formats the unsigned decimal value for writing to SysFs attribute.
+ *
+ * val[in] - value to format.
+ * buf[out] - buffer for the formatted value, NUL-terminated.
+ * size[in] - size of the buffer.
+ *
+ * return length of the formatted value, 0 if it doesn't fit into the buffer.
+ */
+size_t sdi_sysfs_codec_uint_format(uint_t val, char *buf, size_t size);
+
+/**
+ * Formats the signed decimal value for writing to SysFs attribute.
+ *
+ * val[in] - value to format.
+ * buf[out] - buffer for the formatted value, NUL-terminated.
+ * size[in] - size of the buffer.
+ *
+ * return length of the formatted value, 0 if it doesn't fit into the buffer.
+ */
+size_t sdi_sysfs_codec_int_format(int val, char *buf, size_t size);
+
+#endif /* __SDI_SYSFS__CODEC_H */
@@ -0,0 +1,87 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_sysfs_stats.h
+ * \brief Call counts and latency histograms of SysFs attribute accesses
+ *****************************************************************************/
+#ifndef __SDI_SYSFS__STATS_H
+#define __SDI_SYSFS__STATS_H
+
+#include "sdi_common.h"
+
+#define SDI_SYSFS_STATS_BUCKETS 20 /**< number of latency histogram buckets */
+
+/**
+ * @struct sdi_sysfs_stats_t
+ * Merged statistics of one SysFs attribute.
+ *
+ * Bucket 0 counts accesses faster than 1 us, bucket i counts the ones which took
+ * [2^(i-1), 2^i) us and the last bucket counts everything slower.
+ */
+typedef struct sdi_sysfs_stats_s {
+    const char *name;                          /**< joined path and name of the attribute */
+    uint64_t    calls;                         /**< number of accesses */
+    uint64_t    errors;                        /**< number of failed accesses */
+    uint64_t    hist[SDI_SYSFS_STATS_BUCKETS]; /**< latency histogram */
+} sdi_sysfs_stats_t;
+
+/**
+ * Enables or disables collection of the statistics.
+ *
+ * Collected statistics are kept while it is disabled.
+ *
+ * enable[in] - true to enable collection.
+ *
+ * return None.
+ */
+void sdi_sysfs_stats_enable(bool enable);
+
+/**
+ * Starts measuring an access to SysFs attribute.
+ *
+ * return start time to pass to sdi_sysfs_stats_record(), 0 if collection is disabled.
+ */
+uint64_t sdi_sysfs_stats_start(void);
+
+/**
+ * Records an access to SysFs attribute in the counters of the calling thread.
+ *
+ * path and attr are joined only when the attribute is seen by the thread for the
+ * first time, afterwards it is found by the hash and checked against the stored name.
+ *
+ * start[in] - value returned by sdi_sysfs_stats_start(), 0 is ignored.
+ * hash[in] - hash of the joined path of the attribute.
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * rc[in] - result of the access.
+ *
+ * return None.
+ */
+void sdi_sysfs_stats_record(uint64_t start, uint32_t hash, const char *path, const char *attr,
+                            t_std_error rc);
+
+/**
+ * Merges the counters of all the threads and calls the function for each attribute.
+ *
+ * fn[in] - function called for each accessed attribute.
+ * data[in] - user data passed to the function.
+ *
+ * return None.
+ */
+void sdi_sysfs_stats_walk(void (*fn)(const sdi_sysfs_stats_t *stats, void *data), void *data);
+
+/**
+ * Writes the merged statistics as text, one attribute per line.
+ *
+ * fd[in] - descriptor to write to.
+ *
+ * return None.
+ */
+void sdi_sysfs_stats_dump(int fd);
+
+#endif /* __SDI_SYSFS__STATS_H */
@@ -0,0 +1,117 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_sysfs_trace.h
+ * \brief Recording and replay of the hardware accesses
+ *****************************************************************************/
+#ifndef __SDI_SYSFS__TRACE_H
+#define __SDI_SYSFS__TRACE_H
+
+#include "sdi_common.h"
+
+#define SDI_SYSFS_TRACE_MAGIC   "SDITRACE" /**< first 8 bytes of the trace file */
+#define SDI_SYSFS_TRACE_VERSION 1          /**< version of the trace file format */
+
+/**
+ * @defgroup sdi_sysfs_trace_op_t
+ * List of the traced accesses.
+ */
+typedef enum {
+    SDI_SYSFS_TRACE_NAME    = 0, /**< not an access, assigns an ID to the accessed name */
+    SDI_SYSFS_TRACE_READ    = 1, /**< read of SysFs attribute */
+    SDI_SYSFS_TRACE_WRITE   = 2, /**< write of SysFs attribute */
+    SDI_SYSFS_TRACE_REG_GET = 3, /**< read of a device register (e.g. MCIA) */
+    SDI_SYSFS_TRACE_REG_SET = 4  /**< write of a device register */
+} sdi_sysfs_trace_op_t;
+
+/**
+ * Starts recording all the hardware accesses to the trace file.
+ *
+ * The file starts with SDI_SYSFS_TRACE_MAGIC and the 32-bit version and flags. The
+ * records follow, all integers are in the host byte order:
+ *  - name: u8 op (SDI_SYSFS_TRACE_NAME), u32 ID, u16 length, name.
+ *  - access: u8 op, u32 ID of the name, u64 time (ns) since the start of the recording,
+ *    u32 latency (ns), i32 result, u32 length, data read or written.
+ * The names of SysFs attributes don't include the SysFs root (see sdi_sysfs_root_get()).
+ *
+ * file[in] - path to the trace file, truncated if exists.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_trace_record_start(const char *file);
+
+/**
+ * Starts serving all the hardware accesses from the trace file.
+ *
+ * Each read returns the data and the result of the next recorded read of the same
+ * name, the last one is repeated when they are exhausted. Writes return the result of
+ * the next recorded write, success when they are exhausted. Names never recorded
+ * fail with ENOENT.
+ *
+ * file[in] - path to the trace file.
+ * timed[in] - true to delay each access by its recorded latency.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_trace_replay_start(const char *file, bool timed);
+
+/**
+ * Stops the recording or the replay.
+ *
+ * The recorded trace is flushed and closed. Must not be called while the hardware
+ * is being accessed.
+ *
+ * return None.
+ */
+void sdi_sysfs_trace_stop(void);
+
+/**
+ * Checks whether the accesses are served from a trace.
+ *
+ * return true if replaying, false otherwise.
+ */
+bool sdi_sysfs_trace_replaying(void);
+
+/**
+ * Starts measuring a recorded access.
+ *
+ * return start time to pass to sdi_sysfs_trace_record(), 0 if not recording.
+ */
+uint64_t sdi_sysfs_trace_start(void);
+
+/**
+ * Records an access.
+ *
+ * start[in] - value returned by sdi_sysfs_trace_start(), 0 is ignored.
+ * op[in] - accessed operation.
+ * path[in] - path to SysFs attribute or name of the register.
+ * attr[in] - name of SysFs attribute, appended to the path.
+ * data[in] - data read or written.
+ * len[in] - length of the data.
+ * rc[in] - result of the access.
+ *
+ * return None.
+ */
+void sdi_sysfs_trace_record(uint64_t start, sdi_sysfs_trace_op_t op, const char *path, const char *attr,
+                            const void *data, size_t len, t_std_error rc);
+
+/**
+ * Serves an access from the trace.
+ *
+ * op[in] - accessed operation.
+ * path[in] - path to SysFs attribute or name of the register.
+ * attr[in] - name of SysFs attribute, appended to the path.
+ * data[out] - recorded data of the read, valid until sdi_sysfs_trace_stop().
+ * len[out] - length of the recorded data.
+ *
+ * return recorded result of the access.
+ */
+t_std_error sdi_sysfs_trace_replay(sdi_sysfs_trace_op_t op, const char *path, const char *attr,
+                                   const void **data, size_t *len);
+
+#endif /* __SDI_SYSFS__TRACE_H */
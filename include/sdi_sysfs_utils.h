@@ -14,6 +14,62 @@
 
 #include "sdi_common.h"
 
+/**
+ * @defgroup sdi_sysfs_hdl_flags
+ * Flags for the SysFs attribute handle.
+ */
+#define SDI_SYSFS_HDL_F_PIN    (1 << 0) /**< keep the attribute open in the handle itself */
+#define SDI_SYSFS_HDL_F_SHADOW (1 << 1) /**< skip writes of the value, which was written last */
+#define SDI_SYSFS_HDL_F_ASYNC  (1 << 2) /**< queue writes to the writer thread while it is running */
+
+/**
+ * @defgroup sdi_sysfs_attr_type_t
+ * List of the SysFs attribute value types.
+ */
+typedef enum {
+    SDI_SYSFS_ATTR_STR,  /**< string value */
+    SDI_SYSFS_ATTR_UINT, /**< unsigned integer value */
+    SDI_SYSFS_ATTR_INT,  /**< integer value */
+    SDI_SYSFS_ATTR_DATA  /**< raw binary data */
+} sdi_sysfs_attr_type_t;
+
+/**
+ * @struct sdi_sysfs_buf_t
+ * Used to hold raw data of SysFs attribute.
+ *
+ * Data may initially point to caller storage (e.g. on the stack), it is moved to the heap
+ * only if it has to grow. Zero-initialized buffer is allocated on demand.
+ */
+typedef struct sdi_sysfs_buf_s {
+    char   *data;  /**< buffer for the data */
+    size_t  size;  /**< size of the buffer */
+    size_t  len;   /**< length of the data read */
+    bool    owned; /**< data was allocated by the reader and is freed by sdi_sysfs_buf_release() */
+} sdi_sysfs_buf_t;
+
+/**
+ * @struct sdi_sysfs_batch_item_t
+ * Used to describe one attribute read by sdi_sysfs_attr_batch_get().
+ */
+typedef struct sdi_sysfs_batch_item_s {
+    sdi_sysfs_hdl_t hdl;                         /**< [in] handle of SysFs attribute */
+    t_std_error     rc;                          /**< [out] result of reading the attribute */
+    union {
+        uint_t      uint_val;                    /**< value of SDI_SYSFS_ATTR_UINT attribute */
+        int         int_val;                     /**< value of SDI_SYSFS_ATTR_INT attribute */
+        char        str_val[SDI_MAX_NAME_LEN];   /**< value of SDI_SYSFS_ATTR_STR attribute */
+    } val;                                       /**< [out] parsed value of the attribute */
+} sdi_sysfs_batch_item_t;
+
+/**
+ * Gets the prefix of all absolute SysFs paths.
+ *
+ * Set by SDI_SYSFS_ROOT environment variable to run on a simulated SysFs tree. The
+ * tree may also add SDI_SYSFS_DELAY_US microseconds of latency to each access.
+ *
+ * return prefix of the paths, empty string if SysFs is not relocated.
+ */
+const char * sdi_sysfs_root_get(void);
 
 /**
  * Sets string value for SysFs attribute.
@@ -71,26 +127,289 @@ t_std_error sdi_sysfs_attr_uint_get(const char *path, const char *attr, uint_t *
 t_std_error sdi_sysfs_attr_int_get(const char *path, const char *attr, int *val);
 
 /**
- * Gets the size in bytes of raw data in the specified SysFs attribute.
+ * Creates handle of SysFs attribute.
+ *
+ * The path is joined once and the existence of the attribute is checked, so the getters
+ * and setters neither format the path nor call access() afterwards.
  *
  * path[in] - path to SysFs attribute.
  * attr[in] - name of SysFs attribute.
- * size[in] - size of the raw data from specified SysFs attribute.
+ * type[in] - type of the attribute value.
+ * flags[in] - SDI_SYSFS_HDL_F_* flags.
+ *
+ * return handle of the attribute.
+ */
+sdi_sysfs_hdl_t sdi_sysfs_hdl_create(const char *path, const char *attr, sdi_sysfs_attr_type_t type, uint_t flags);
+
+/**
+ * Returns the full path of SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return full path of the attribute.
+ */
+const char * sdi_sysfs_hdl_path_get(sdi_sysfs_hdl_t hdl);
+
+/**
+ * Returns the hash of the full path of SysFs attribute, the key of its statistics.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return hash of the full path.
+ */
+uint32_t sdi_sysfs_hdl_hash_get(sdi_sysfs_hdl_t hdl);
+
+/**
+ * Returns the type of SysFs attribute value.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return type of the attribute value.
+ */
+sdi_sysfs_attr_type_t sdi_sysfs_hdl_type_get(sdi_sysfs_hdl_t hdl);
+
+/**
+ * Forgets that SysFs attribute was missing, so the next access probes it right away.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return None.
+ */
+void sdi_sysfs_hdl_expire(sdi_sysfs_hdl_t hdl);
+
+/**
+ * Logs SysFs attributes, which didn't exist when their handles were created.
+ *
+ * return number of missing attributes.
+ */
+uint_t sdi_sysfs_hdl_report_missing(void);
+
+/**
+ * Gets the string value from SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[out] - retrieved value.
  *
  * return STD_ERR_OK on success and standard error on failure.
  */
-t_std_error sdi_sysfs_attr_data_size_get(const char *path, const char *attr, size_t *size);
+t_std_error sdi_sysfs_hdl_str_get(sdi_sysfs_hdl_t hdl, char *val);
 
 /**
- * Gets the raw data from the specified SysFs attribute.
+ * Gets the unsigned integer value from SysFs attribute.
  *
- * path[in] - path to SysFs attribute.
- * attr[in] - name of SysFs attribute.
- * size[in] - size the of buffer, where raw data should be stored.
- * buf[out] - buffer, where raw data should be stored.
+ * hdl[in] - handle of SysFs attribute.
+ * val[out] - retrieved value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_uint_get(sdi_sysfs_hdl_t hdl, uint_t *val);
+
+/**
+ * Gets the integer value from SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[out] - retrieved value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_int_get(sdi_sysfs_hdl_t hdl, int *val);
+
+/**
+ * Gets the temperature from SysFs attribute, which reports it in millidegrees.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[out] - retrieved temperature in degrees (Celsius).
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_mdeg_get(sdi_sysfs_hdl_t hdl, int *val);
+
+/**
+ * Sets string value for SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[in] - value which should be set.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_str_set(sdi_sysfs_hdl_t hdl, const char *val);
+
+/**
+ * Sets the unsigned integer value for SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[in] - value which should be set.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_uint_set(sdi_sysfs_hdl_t hdl, uint_t val);
+
+/**
+ * Sets the interval after which the shadowed value is re-written even if it didn't change.
+ *
+ * Attributes created with SDI_SYSFS_HDL_F_SHADOW are re-written every 60 s by default.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * refresh_ms[in] - refresh interval, 0 to never re-write the same value.
+ *
+ * return None.
+ */
+void sdi_sysfs_hdl_shadow_refresh_set(sdi_sysfs_hdl_t hdl, uint_t refresh_ms);
+
+/**
+ * Forgets the last value written to SysFs attribute, so the next write reaches it.
+ *
+ * Used when the hardware behind the attribute may have lost its state, e.g. the
+ * entity was re-inserted.
+ *
+ * hdl[in] - handle of SysFs attribute, NULL is ignored.
+ *
+ * return None.
+ */
+void sdi_sysfs_hdl_shadow_invalidate(sdi_sysfs_hdl_t hdl);
+
+/**
+ * Gets the numbers of writes to the shadowed attributes.
+ *
+ * written[out] - number of writes which reached the attributes.
+ * suppressed[out] - number of writes skipped because the value didn't change.
+ *
+ * return None.
+ */
+void sdi_sysfs_shadow_stats_get(uint64_t *written, uint64_t *suppressed);
+
+/**
+ * Starts the writer thread, so writes to SDI_SYSFS_HDL_F_ASYNC attributes are queued.
+ *
+ * A queued write returns once the value is pushed. Pending writes to the same attribute
+ * are coalesced, only the last value is written.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_async_start(void);
+
+/**
+ * Completes the queued writes and stops the writer thread.
+ *
+ * Writes issued after that are synchronous again.
+ *
+ * return None.
+ */
+void sdi_sysfs_async_stop(void);
+
+/**
+ * Waits until all the writes queued so far are completed.
+ *
+ * return None.
+ */
+void sdi_sysfs_async_flush(void);
+
+/**
+ * Waits until the writes to SysFs attribute queued so far are completed.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return result of the last completed write, STD_ERR_OK if the attribute is synchronous.
+ */
+t_std_error sdi_sysfs_hdl_flush(sdi_sysfs_hdl_t hdl);
+
+/**
+ * Gets the string value from SysFs attribute, waiting for it until the deadline.
+ *
+ * The read runs on a worker thread and keeps running past the deadline, its value
+ * becomes the last known one. The timeout starts when a worker takes the read, so a
+ * call waits at most twice the timeout when the workers are busy; busy workers stuck
+ * in wedged reads are supplemented by new ones. Attributes timing out repeatedly are
+ * quarantined: their reads fail with ETIMEDOUT without waiting for a while.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * timeout_ms[in] - time to wait for the value.
+ * val[out] - retrieved value, the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed (val is set if the
+ * value is known) and standard error on other failures.
+ */
+t_std_error sdi_sysfs_hdl_str_get_timed(sdi_sysfs_hdl_t hdl, uint_t timeout_ms, char *val);
+
+/**
+ * Gets the unsigned integer value from SysFs attribute, waiting for it until the deadline.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * timeout_ms[in] - time to wait for the value.
+ * val[out] - retrieved value, the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed (val is set if the
+ * value is known) and standard error on other failures.
+ */
+t_std_error sdi_sysfs_hdl_uint_get_timed(sdi_sysfs_hdl_t hdl, uint_t timeout_ms, uint_t *val);
+
+/**
+ * Gets the integer value from SysFs attribute, waiting for it until the deadline.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * timeout_ms[in] - time to wait for the value.
+ * val[out] - retrieved value, the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed (val is set if the
+ * value is known) and standard error on other failures.
+ */
+t_std_error sdi_sysfs_hdl_int_get_timed(sdi_sysfs_hdl_t hdl, uint_t timeout_ms, int *val);
+
+/**
+ * Gets the temperature from SysFs attribute in millidegrees, waiting for it until the deadline.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * timeout_ms[in] - time to wait for the value.
+ * val[out] - retrieved temperature in degrees (Celsius), the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed (val is set if the
+ * value is known) and standard error on other failures.
+ */
+t_std_error sdi_sysfs_hdl_mdeg_get_timed(sdi_sysfs_hdl_t hdl, uint_t timeout_ms, int *val);
+
+/**
+ * Reads the raw data of SysFs attribute.
+ *
+ * The attribute is opened once and read until EOF, the buffer grows as needed. Binary
+ * attributes which report size 0 are supported. Buffer may be reused across calls.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * buf[in,out] - buffer for the data, buf->len is set to the length of the data.
  *
  * return STD_ERR_OK on success and standard error on failure.
  */
-t_std_error sdi_sysfs_attr_data_get(const char *path, const char *attr, size_t size, char *buf);
+t_std_error sdi_sysfs_hdl_data_read(sdi_sysfs_hdl_t hdl, sdi_sysfs_buf_t *buf);
+
+/**
+ * Frees the raw data buffer, if it was allocated by the reader.
+ *
+ * buf[in,out] - buffer to free, it is reset to zero.
+ *
+ * return None.
+ */
+void sdi_sysfs_buf_release(sdi_sysfs_buf_t *buf);
+
+/**
+ * Gets the values of several SysFs attributes at once.
+ *
+ * The reads are submitted together, through io_uring when it is available and with
+ * pread() otherwise. Each value is parsed according to the type of its handle;
+ * SDI_SYSFS_ATTR_DATA attributes are not supported.
+ *
+ * items[in,out] - attributes to read, the values and results are stored in them.
+ * count[in] - number of items.
+ *
+ * return STD_ERR_OK if all attributes were read, otherwise the result of the first failed item.
+ */
+t_std_error sdi_sysfs_attr_batch_get(sdi_sysfs_batch_item_t *items, size_t count);
+
+/**
+ * Closes all SysFs attributes kept open by the fd cache.
+ *
+ * Attributes that are in use at the moment are closed once the I/O on them completes.
+ *
+ * return None.
+ */
+void sdi_sysfs_fd_cache_flush(void);
 
 #endif /* __SDI_SYSFS__UTILS_H */
@@ -0,0 +1,113 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_sysfs_watch.h
+ * \brief Watcher, which keeps cached values of SysFs attributes up to date
+ *****************************************************************************/
+#ifndef __SDI_SYSFS__WATCH_H
+#define __SDI_SYSFS__WATCH_H
+
+#include "sdi_common.h"
+
+/**
+ * @struct sdi_sysfs_watch_batch_item_t
+ * Used to describe one attribute read by sdi_sysfs_watch_batch_str_get().
+ */
+typedef struct sdi_sysfs_watch_batch_item_s {
+    sdi_sysfs_watch_hdl_t watch;                  /**< [in] handle of the watched attribute */
+    t_std_error           rc;                     /**< [out] result of getting the value */
+    char                  val[SDI_MAX_NAME_LEN];  /**< [out] retrieved value */
+} sdi_sysfs_watch_batch_item_t;
+
+/**
+ * Adds SysFs attribute to the watcher.
+ *
+ * The attribute is re-read when its driver calls sysfs_notify(). Until a notification
+ * is seen, it is re-read every poll_ms instead.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * poll_ms[in] - interval of the timed polling.
+ *
+ * return handle of the watched attribute.
+ */
+sdi_sysfs_watch_hdl_t sdi_sysfs_watch_add(sdi_sysfs_hdl_t hdl, uint_t poll_ms);
+
+/**
+ * Starts the watcher thread.
+ *
+ * All attributes added so far are read before the function returns, so the getters
+ * return cached values right away.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_watch_start(void);
+
+/**
+ * Stops the watcher thread.
+ *
+ * The getters read the attributes directly afterwards.
+ *
+ * return None.
+ */
+void sdi_sysfs_watch_stop(void);
+
+/**
+ * Drops the cached value of the watched attribute and makes the watcher re-read it.
+ *
+ * Until the re-read completes, the getter reads the attribute directly.
+ *
+ * watch[in] - handle of the watched attribute.
+ *
+ * return None.
+ */
+void sdi_sysfs_watch_expire(sdi_sysfs_watch_hdl_t watch);
+
+/**
+ * Gets the cached string value of the watched attribute.
+ *
+ * If there is no cached value (the watcher is not running or the attribute couldn't be
+ * read), the attribute is read directly.
+ *
+ * watch[in] - handle of the watched attribute.
+ * val[out] - retrieved value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_watch_str_get(sdi_sysfs_watch_hdl_t watch, char *val);
+
+/**
+ * Gets the cached string value of the watched attribute, reading it within a deadline
+ * if there is none.
+ *
+ * Same as sdi_sysfs_watch_str_get(), the direct read is done by
+ * sdi_sysfs_hdl_str_get_timed().
+ *
+ * watch[in] - handle of the watched attribute.
+ * timeout_ms[in] - time to wait for the direct read.
+ * val[out] - retrieved value, the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed (val is set if the
+ * value is known) and standard error on other failures.
+ */
+t_std_error sdi_sysfs_watch_str_get_timed(sdi_sysfs_watch_hdl_t watch, uint_t timeout_ms, char *val);
+
+/**
+ * Gets the cached string values of several watched attributes at once.
+ *
+ * The attributes without a cached value are read together by one
+ * sdi_sysfs_attr_batch_get() call, instead of one by one.
+ *
+ * items[in,out] - attributes to get, the values and results are stored in them.
+ * count[in] - number of items.
+ *
+ * return STD_ERR_OK if all values were retrieved, otherwise the result of the first
+ * failed item.
+ */
+t_std_error sdi_sysfs_watch_batch_str_get(sdi_sysfs_watch_batch_item_t *items, size_t count);
+
+#endif /* __SDI_SYSFS__WATCH_H */
@@ -0,0 +1,91 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/******************************************************************************
+ * \file sdi_uevent.h
+ * \brief Listener of kernel kobject uevents
+ *****************************************************************************/
+#ifndef __SDI_UEVENT_H
+#define __SDI_UEVENT_H
+
+#include "sdi_common.h"
+
+#define SDI_UEVENT_MSG_MAX_LEN 8192 /**< maximum length of uevent message */
+
+/**
+ * @defgroup sdi_uevent_action_t
+ * List of the uevent actions handled by SDI.
+ */
+typedef enum {
+    SDI_UEVENT_ADD,    /**< device was added */
+    SDI_UEVENT_REMOVE, /**< device was removed */
+    SDI_UEVENT_CHANGE  /**< device state changed */
+} sdi_uevent_action_t;
+
+/**
+ * @struct sdi_uevent_t
+ * Used to hold parsed uevent, the strings point into the message buffer.
+ */
+typedef struct sdi_uevent_s {
+    sdi_uevent_action_t action;    /**< action of the uevent */
+    const char         *devpath;   /**< path of the device relative to /sys */
+    const char         *subsystem; /**< subsystem of the device, empty if not reported */
+} sdi_uevent_t;
+
+/**
+ * Callback, which is called by the listener thread for every uevent.
+ *
+ * event[in] - parsed uevent.
+ * data[in] - user data passed to sdi_uevent_listener_start().
+ *
+ * return None.
+ */
+typedef void (*sdi_uevent_handler_t)(const sdi_uevent_t *event, void *data);
+
+/**
+ * Opens netlink socket, which receives kernel kobject uevents.
+ *
+ * return descriptor of the socket on success and -1 with errno set on failure.
+ */
+int sdi_uevent_socket_open(void);
+
+/**
+ * Parses uevent message.
+ *
+ * The message is "action@devpath" followed by NUL-separated KEY=value pairs.
+ *
+ * buf[in] - message, its last byte is overwritten with NUL.
+ * len[in] - length of the message.
+ * event[out] - parsed uevent.
+ *
+ * return STD_ERR_OK on success, EINVAL if the message is malformed and ENOTSUP if the
+ * action is not handled.
+ */
+t_std_error sdi_uevent_parse(char *buf, size_t len, sdi_uevent_t *event);
+
+/**
+ * Starts the thread which receives uevents from the descriptor.
+ *
+ * Any datagram descriptor delivering uevent messages may be used, e.g. one end of
+ * a socketpair() to inject synthetic uevents. The listener takes ownership of it.
+ *
+ * fd[in] - descriptor to receive uevents from.
+ * handler[in] - callback called for every handled uevent.
+ * data[in] - user data passed to the callback.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_uevent_listener_start(int fd, sdi_uevent_handler_t handler, void *data);
+
+/**
+ * Stops the listener thread and closes its descriptor.
+ *
+ * return None.
+ */
+void sdi_uevent_listener_stop(void);
+
+#endif /* __SDI_UEVENT_H */
@@ -11,6 +11,91 @@
 
 #include "sdi_entity.h"
 #include "sdi_common.h"
+#include "sdi_sysfs_watch.h"
+#include "sdi_sys_ext.h"
+
+/**
+ * @defgroup sdi_entity_state_flags
+ * Status of the entity, as last reported by sdi_entity_status_snapshot().
+ */
+#define SDI_ENTITY_STATE_F_REPORTED (1 << 0) /**< the status was reported at least once */
+#define SDI_ENTITY_STATE_F_PRESENT  (1 << 1) /**< the entity is present */
+#define SDI_ENTITY_STATE_F_FAULT    (1 << 2) /**< the entity has a fault */
+#define SDI_ENTITY_STATE_F_POWER    (1 << 3) /**< the PSU output power is good */
+#define SDI_ENTITY_STATE_F_ERROR    (1 << 4) /**< the status couldn't be read */
+
+#define SDI_ENTITY_STATUS_WATCHES 3 /**< maximal number of attributes read per entity */
+
+/**
+ * @struct sdi_entity_status_collect_t
+ * Used to collect the entities for sdi_entity_status_snapshot().
+ */
+typedef struct sdi_entity_status_collect_s {
+    sdi_entity_status_entry_t *entries; /**< entries to fill */
+    uint_t                     size;    /**< number of the entries */
+    uint_t                     count;   /**< number of the entities found */
+} sdi_entity_status_collect_t;
+
+/**
+ * Evaluates the presence of the entity from the value of its "presence" attribute.
+ *
+ * hdl[in] - handle of the entity.
+ * rc[in] - result of reading the attribute.
+ * pres[in] - value of the attribute.
+ *
+ * return true if the entity is present.
+ */
+static bool sdi_entity_presence_eval(sdi_entity_priv_hdl_t hdl, t_std_error rc, const char *pres)
+{
+    bool presence = false;
+
+    if (hdl->presence.type == SDI_ENTITY_FIXED) {
+        presence = true;
+    } else if ((rc == STD_ERR_OK) && (strncmp(hdl->presence.present, pres, SDI_MAX_NAME_LEN) == 0)) {
+        presence = true;
+    }
+
+    /* A re-inserted entity has lost everything written to the previous one */
+    if ((__atomic_exchange_n(&hdl->presence.seen, presence, __ATOMIC_ACQ_REL) == false)
+        && (presence == true)) {
+        sdi_entity_shadow_invalidate(hdl);
+    }
+
+    return presence;
+}
+
+/**
+ * Evaluates the fault status of the entity from the value of its "fault status" attribute.
+ *
+ * hdl[in] - handle of the entity.
+ * rc[in] - result of reading the attribute.
+ * status[in] - value of the attribute.
+ *
+ * return true if the entity has a fault, an unreadable status counts as one.
+ */
+static bool sdi_entity_fault_eval(sdi_entity_priv_hdl_t hdl, t_std_error rc, const char *status)
+{
+    if (hdl->status.is_supported == false) {
+        return false;
+    }
+
+    return (rc != STD_ERR_OK) || (strncmp(hdl->status.fault, status, SDI_MAX_NAME_LEN) == 0);
+}
+
+/**
+ * Evaluates the output power status of the PSU from the value of its "power status" attribute.
+ *
+ * hdl[in] - handle of the PSU entity.
+ * rc[in] - result of reading the attribute.
+ * pwr_status[in] - value of the attribute.
+ *
+ * return true if the output power is good.
+ */
+static bool sdi_entity_power_eval(sdi_entity_priv_hdl_t hdl, t_std_error rc, const char *pwr_status)
+{
+    return (hdl->power.is_supported == true) && (rc == STD_ERR_OK) &&
+           (strncmp(hdl->power.status_present, pwr_status, SDI_MAX_NAME_LEN) == 0);
+}
 
 
 /**
@@ -32,17 +117,12 @@ t_std_error sdi_entity_presence_get(sdi_entity_hdl_t entity_hdl, bool *presence)
 
     hdl = (sdi_entity_priv_hdl_t)entity_hdl;
 
-    *presence = false;
-
-    if (hdl->presence.type == SDI_ENTITY_FIXED) {
-        *presence = true;
-    } else {
-        rc = sdi_sysfs_attr_str_get(hdl->presence.path, hdl->presence.name, pres);
-        if ((rc == STD_ERR_OK) && (strncmp(hdl->presence.present, pres, sizeof(hdl->presence.present)) == 0)) {
-            *presence = true;
-        }
+    if (hdl->presence.type != SDI_ENTITY_FIXED) {
+        rc = sdi_sysfs_watch_str_get(hdl->presence.watch, pres);
     }
 
+    *presence = sdi_entity_presence_eval(hdl, rc, pres);
+
     return rc;
 }
 
@@ -65,13 +145,80 @@ t_std_error sdi_entity_fault_status_get(sdi_entity_hdl_t entity_hdl, bool *fault
 
     hdl = (sdi_entity_priv_hdl_t)entity_hdl;
 
-    *fault = false;
+    if (hdl->status.is_supported == true) {
+        rc = sdi_sysfs_watch_str_get(hdl->status.watch, status);
+    }
+
+    *fault = sdi_entity_fault_eval(hdl, rc, status);
+
+    return rc;
+}
+
+/**
+ * Retrieve presence status of given entity within a deadline.
+ *
+ * entity_hdl[in] - handle to the entity whose information has to be retrieved.
+ * timeout_ms[in] - time to wait for the presence attribute.
+ * presence[out] - true if entity is present, false otherwise, from the last known
+ *                 value on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT on timeout and standard error on failure
+ */
+t_std_error sdi_entity_presence_get_timed(sdi_entity_hdl_t entity_hdl, uint_t timeout_ms, bool *presence)
+{
+    t_std_error           rc = STD_ERR_OK;
+    sdi_entity_priv_hdl_t hdl = NULL;
+    char                  pres[SDI_MAX_NAME_LEN] = {0};
+
+    STD_ASSERT(entity_hdl != NULL);
+    STD_ASSERT(presence != NULL);
+
+    hdl = (sdi_entity_priv_hdl_t)entity_hdl;
+
+    if (hdl->presence.type != SDI_ENTITY_FIXED) {
+        rc = sdi_sysfs_watch_str_get_timed(hdl->presence.watch, timeout_ms, pres);
+    }
+
+    /* A timeout says nothing about the entity, it doesn't count as a removal */
+    if ((rc == SDI_ERRCODE(ETIMEDOUT)) && (pres[0] == '\0')) {
+        *presence = false;
+        return rc;
+    }
+
+    *presence = sdi_entity_presence_eval(hdl, (rc == SDI_ERRCODE(ETIMEDOUT)) ? STD_ERR_OK : rc, pres);
+
+    return rc;
+}
+
+/**
+ * Checks the fault status for a given entity within a deadline.
+ *
+ * entity_hdl[in] - handle to the entity whose information has to be retrieved.
+ * timeout_ms[in] - time to wait for the fault status attribute.
+ * fault[out] - true if entity has any fault, false otherwise, from the last known
+ *              value on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT on timeout and standard error on failure
+ */
+t_std_error sdi_entity_fault_status_get_timed(sdi_entity_hdl_t entity_hdl, uint_t timeout_ms, bool *fault)
+{
+    t_std_error           rc = STD_ERR_OK;
+    sdi_entity_priv_hdl_t hdl = NULL;
+    char                  status[SDI_MAX_NAME_LEN] = {0};
+
+    STD_ASSERT(entity_hdl != NULL);
+    STD_ASSERT(fault != NULL);
+
+    hdl = (sdi_entity_priv_hdl_t)entity_hdl;
 
     if (hdl->status.is_supported == true) {
-        rc = sdi_sysfs_attr_str_get(hdl->status.path, hdl->status.name, status);
-        if ((rc != STD_ERR_OK) || (strncmp(hdl->status.fault, status, sizeof(hdl->status.fault)) == 0)) {
-            *fault = true;
-        }
+        rc = sdi_sysfs_watch_str_get_timed(hdl->status.watch, timeout_ms, status);
+    }
+
+    if ((rc == SDI_ERRCODE(ETIMEDOUT)) && (status[0] != '\0')) {
+        *fault = sdi_entity_fault_eval(hdl, STD_ERR_OK, status);
+    } else {
+        *fault = sdi_entity_fault_eval(hdl, rc, status);
     }
 
     return rc;
@@ -95,15 +242,137 @@ t_std_error sdi_entity_psu_output_power_status_get(sdi_entity_hdl_t entity_hdl,
     STD_ASSERT(hdl != NULL);
     STD_ASSERT(hdl->type == SDI_ENTITY_PSU_TRAY);
 
-    *status = false;
-
     if (hdl->power.is_supported == true) {
-        rc = sdi_sysfs_attr_str_get(hdl->power.status_path, hdl->power.status_name, pwr_status);
-        if ((rc == STD_ERR_OK) &&
-            (strncmp(hdl->power.status_present, pwr_status, sizeof(hdl->power.status_present)) == 0)) {
-            *status = true;
+        rc = sdi_sysfs_watch_str_get(hdl->power.status_watch, pwr_status);
+    }
+
+    *status = sdi_entity_power_eval(hdl, rc, pwr_status);
+
+    return rc;
+}
+
+/**
+ * Adds the entity to the status snapshot.
+ *
+ * hdl[in] - handle of the entity.
+ * user_data[in] - entities collected so far.
+ *
+ * return None.
+ */
+static void sdi_entity_status_collect(sdi_entity_hdl_t hdl, void *user_data)
+{
+    sdi_entity_status_collect_t *collect = (sdi_entity_status_collect_t*)user_data;
+
+    /* Counted on, so the caller learns the size needed */
+    if (collect->count < collect->size) {
+        collect->entries[collect->count].hdl = hdl;
+    }
+    collect->count++;
+}
+
+/**
+ * Gets the presence, fault and PSU output power status of all the entities at once.
+ *
+ * entries[out] - status of each entity.
+ * count[in,out] - size of the array; number of entities filled in, or needed.
+ *
+ * return STD_ERR_OK if the status of every entity was read, SDI_ERRCODE(ENOSPC) if
+ * the array is too small, otherwise the error of the first failed entry.
+ */
+t_std_error sdi_entity_status_snapshot(sdi_entity_status_entry_t *entries, uint_t *count)
+{
+    sdi_entity_status_collect_t   collect = {0};
+    sdi_sysfs_watch_batch_item_t *items = NULL;
+    sdi_sysfs_watch_batch_item_t *item = NULL;
+    sdi_entity_status_entry_t    *entry = NULL;
+    sdi_entity_priv_hdl_t         hdl = NULL;
+    uint_t                        item_count = 0;
+    uint_t                        state = 0;
+    uint_t                        i = 0;
+    t_std_error                   rc = STD_ERR_OK;
+
+    STD_ASSERT(count != NULL);
+    STD_ASSERT((entries != NULL) || (*count == 0));
+
+    collect.entries = entries;
+    collect.size = *count;
+    sdi_entity_for_each(sdi_entity_status_collect, &collect);
+
+    *count = collect.count;
+    if (collect.count > collect.size) {
+        return SDI_ERRCODE(ENOSPC); /* No space left on device */
+    }
+
+    if (collect.count == 0) {
+        return STD_ERR_OK;
+    }
+
+    items = (sdi_sysfs_watch_batch_item_t*)calloc(collect.count * SDI_ENTITY_STATUS_WATCHES, sizeof(*items));
+    STD_ASSERT(items != NULL);
+
+    /* The attributes of all the entities, so the uncached ones are read in one round */
+    for (i = 0; i < collect.count; i++) {
+        hdl = (sdi_entity_priv_hdl_t)entries[i].hdl;
+
+        if (hdl->presence.type != SDI_ENTITY_FIXED) {
+            items[item_count++].watch = hdl->presence.watch;
+        }
+        if (hdl->status.is_supported == true) {
+            items[item_count++].watch = hdl->status.watch;
+        }
+        if ((hdl->type == SDI_ENTITY_PSU_TRAY) && (hdl->power.is_supported == true)) {
+            items[item_count++].watch = hdl->power.status_watch;
+        }
+    }
+
+    sdi_sysfs_watch_batch_str_get(items, item_count);
+
+    /* Same order as above */
+    item = items;
+    for (i = 0; i < collect.count; i++) {
+        entry = &entries[i];
+        hdl = (sdi_entity_priv_hdl_t)entry->hdl;
+
+        entry->rc = STD_ERR_OK;
+        entry->fault = false;
+        entry->power_status = false;
+
+        if (hdl->presence.type != SDI_ENTITY_FIXED) {
+            entry->rc = item->rc;
+            entry->presence = sdi_entity_presence_eval(hdl, item->rc, item->val);
+            item++;
+        } else {
+            entry->presence = sdi_entity_presence_eval(hdl, STD_ERR_OK, "");
+        }
+        if (hdl->status.is_supported == true) {
+            entry->rc = (entry->rc != STD_ERR_OK) ? entry->rc : item->rc;
+            entry->fault = sdi_entity_fault_eval(hdl, item->rc, item->val);
+            item++;
+        }
+        if ((hdl->type == SDI_ENTITY_PSU_TRAY) && (hdl->power.is_supported == true)) {
+            entry->rc = (entry->rc != STD_ERR_OK) ? entry->rc : item->rc;
+            entry->power_status = sdi_entity_power_eval(hdl, item->rc, item->val);
+            item++;
+        }
+
+        state = SDI_ENTITY_STATE_F_REPORTED |
+                (entry->presence ? SDI_ENTITY_STATE_F_PRESENT : 0) |
+                (entry->fault ? SDI_ENTITY_STATE_F_FAULT : 0) |
+                (entry->power_status ? SDI_ENTITY_STATE_F_POWER : 0) |
+                ((entry->rc != STD_ERR_OK) ? SDI_ENTITY_STATE_F_ERROR : 0);
+
+        if (__atomic_exchange_n(&hdl->status_state, state, __ATOMIC_ACQ_REL) != state) {
+            entry->generation = __atomic_add_fetch(&hdl->status_gen, 1, __ATOMIC_ACQ_REL);
+        } else {
+            entry->generation = __atomic_load_n(&hdl->status_gen, __ATOMIC_ACQUIRE);
+        }
+
+        if ((rc == STD_ERR_OK) && (entry->rc != STD_ERR_OK)) {
+            rc = entry->rc;
         }
     }
 
+    free(items);
+
     return rc;
 }
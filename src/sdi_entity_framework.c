@@ -10,22 +10,193 @@
  ***************************************************************************************/
 
 #include "sdi_common.h"
+#include "sdi_config_required.h"
+#include "sdi_config_snapshot.h"
 #include "sdi_entity.h"
+#include "sdi_epoch.h"
+#include "sdi_executor.h"
+#include "sdi_sysfs_utils.h"
+#include "sdi_sysfs_watch.h"
+#include "sdi_string_pool.h"
+#include "sdi_sys_ext.h"
+#include <pthread.h>
+
+#define SDI_DEVICE_CONFIG_FILE "device.xml"
+#define SDI_ENTITY_WATCH_POLL_MS 500   /**< polling interval of presence/status attributes without sysfs_notify() */
+#define SDI_ENTITY_TYPES         3     /**< number of entity types, see sdi_entity_names */
+#define SDI_ENTITY_NAME_BUCKETS  64    /**< number of buckets of the entity name index, power of 2 */
+#define SDI_ENTITY_ARENA_CHUNK   16384 /**< size of the chunks entity and resource records are carved from */
+#define SDI_ENTITY_CACHE_LINE    64    /**< alignment of the entity records */
+#define SDI_SETTINGS_MIN_BUCKETS 64    /**< minimal number of buckets of the settings index, power of 2 */
 
-#define SDI_DEVICE_CONFIG_FILE "/etc/opx/sdi/device.xml"
-
-
-static std_dll_head entity_list;
 
 /* Note: Names must be in the same order as defined for enum sdi_entity_type_t */
-static const char * sdi_entity_names[] = {
+static const char * sdi_entity_names[SDI_ENTITY_TYPES] = {
     "SDI_ENTITY_SYSTEM_BOARD",
     "SDI_ENTITY_FAN_TRAY",
     "SDI_ENTITY_PSU_TRAY"
 };
 
+/**
+ * @struct sdi_entity_db_t
+ * Snapshot of the registered entities.
+ *
+ * A snapshot is never modified once published: adding an entity publishes a copy
+ * holding it and retires the previous one, which is released once no reader is left
+ * in a section entered before the swap. So a reader, which loads the snapshot once
+ * inside sdi_epoch_enter()/sdi_epoch_exit(), takes no locks and sees the counts, the
+ * instance tables and the name index of the same set of entities. An instance
+ * registered twice resolves to the last one, as the list lookup did.
+ */
+typedef struct sdi_entity_db_s {
+    sdi_entity_hdl_t  *tables[SDI_ENTITY_TYPES];         /**< entity of each instance of each type */
+    uint_t             size[SDI_ENTITY_TYPES];           /**< number of instance slots of each type */
+    uint_t             count[SDI_ENTITY_TYPES];          /**< number of entities of each type */
+    uint_t             all_count;                        /**< number of all the entities */
+    sdi_entity_node_t *by_name[SDI_ENTITY_NAME_BUCKETS]; /**< entities by the hash of their name */
+    sdi_entity_hdl_t   all[];                            /**< all the entities in the order added,
+                                                              followed by the instance slots */
+} sdi_entity_db_t;
+
+/**
+ * @struct sdi_entity_index_t
+ * Index of the registered entities.
+ *
+ * It is updated with every entity added, so it stays consistent with the entities
+ * added at runtime. The entities themselves and the name index nodes are never
+ * freed, so their handles stay valid after leaving the read-side section.
+ */
+typedef struct sdi_entity_index_s {
+    pthread_mutex_t  lock; /**< serializes the writers */
+    sdi_entity_db_t *db;   /**< current snapshot */
+} sdi_entity_index_t;
+
+static sdi_entity_db_t sdi_entity_db_empty;
+
+static sdi_entity_index_t sdi_entity_index = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .db   = &sdi_entity_db_empty
+};
+
+/**
+ * @struct sdi_entity_arena_t
+ * Chunks the entity and resource records are carved from.
+ *
+ * Records allocated one after another end up adjacent, so iterations walk memory
+ * in order instead of chasing scattered heap blocks. Records are never freed.
+ */
+typedef struct sdi_entity_arena_s {
+    pthread_mutex_t lock;  /**< protects the arena */
+    char           *chunk; /**< free space of the current chunk */
+    size_t          left;  /**< bytes left in the current chunk */
+} sdi_entity_arena_t;
+
+static sdi_entity_arena_t sdi_entity_arena = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+static sdi_entity_arena_t sdi_resource_arena = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+/**
+ * @struct sdi_settings_entry_t
+ * Named node of device.xml in the settings index.
+ */
+typedef struct sdi_settings_entry_s {
+    struct sdi_settings_entry_s *next;   /**< next entry in the same bucket */
+    std_config_node_t            parent; /**< parent of the node */
+    std_config_node_t            node;   /**< the node */
+    const char                  *name;   /**< value of the "name" attribute of the node */
+} sdi_settings_entry_t;
+
+/**
+ * @struct sdi_settings_index_t
+ * Index of the device.xml nodes by their parent and name, valid while the entities
+ * are registered.
+ */
+typedef struct sdi_settings_index_s {
+    uint_t                 size;     /**< number of buckets, power of 2 */
+    sdi_settings_entry_t **buckets;  /**< entries by the hash of their parent and name */
+    sdi_settings_entry_t  *entries;  /**< storage of the entries */
+    uint_t                 capacity; /**< number of allocated entries */
+    uint_t                 count;    /**< number of used entries */
+} sdi_settings_index_t;
+
+static sdi_settings_index_t sdi_settings_index;
+
+/**
+ * @struct sdi_config_roots_t
+ * Config files the entities are registered from.
+ */
+typedef struct sdi_config_roots_s {
+    std_config_node_t entities;     /**< root of entity.xml */
+    std_config_node_t settings;     /**< root of device.xml */
+    std_config_hdl_t  entity_hdl;   /**< parsed entity.xml, NULL if the snapshot is used */
+    std_config_hdl_t  settings_hdl; /**< parsed device.xml, NULL if the snapshot is used */
+    bool              snapshot;     /**< whether the snapshot is used */
+} sdi_config_roots_t;
+
+/**
+ * @struct sdi_config_reload_state_t
+ * Used to hold what a reload needs from the registration.
+ */
+typedef struct sdi_config_reload_state_s {
+    pthread_mutex_t lock;                  /**< serializes the registration and the reloads */
+    char            entity_file[PATH_MAX]; /**< entity.xml the entities were registered from */
+} sdi_config_reload_state_t;
+
+static sdi_config_reload_state_t sdi_config_reload_state = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+/**
+ * @struct sdi_config_required_t
+ * Attributes the registration asserts on for one kind of settings.
+ */
+typedef struct sdi_config_required_s {
+    const char *kind;                           /**< entity attribute naming the settings or resource type */
+    const char *attrs[SDI_CONFIG_REQUIRED_MAX]; /**< required attributes */
+} sdi_config_required_t;
+
+/*
+ * Note: Generated from tools/sdi_config_required.txt, which tools/sdi_snapshot_compile.py
+ * checks the configs with as well. Edit the file, not the generated header.
+ */
+static const sdi_config_required_t sdi_config_required[] = {
+    SDI_CONFIG_REQUIRED_TABLE
+};
+
+/* Entity attributes naming the settings of the entity itself */
+static const char * sdi_entity_settings_refs[] = {
+    "presence",
+    "fault",
+    "power_ctl"
+};
+
+/**
+ * @struct sdi_entity_parallel_t
+ * Parallel iteration over the entities, executed by sdi_executor_run().
+ */
+typedef struct sdi_entity_parallel_s {
+    sdi_entity_hdl_t         *slots;     /**< entities in the order they were added */
+    uint_t                    count;     /**< number of the entities */
+    sdi_entity_parallel_fn_t  fn;        /**< function called for each entity */
+    void                     *user_data; /**< user data passed to the function */
+} sdi_entity_parallel_t;
+
+/**
+ * @struct sdi_resource_parallel_t
+ * Parallel iteration over the resources of an entity.
+ */
+typedef struct sdi_resource_parallel_s {
+    sdi_resource_hdl_t         *resources; /**< resource list of the entity */
+    sdi_resource_parallel_fn_t  fn;        /**< function called for each resource */
+    void                       *user_data; /**< user data passed to the function */
+} sdi_resource_parallel_t;
+
 /* Note: Names must be in the same order as defined for enum sdi_resource_type_t */
-static const char * sdi_resource_names[] = {
+static const char * sdi_resource_names[SDI_RESOURCE_TYPES] = {
     "SDI_RESOURCE_TEMPERATURE",
     "SDI_RESOURCE_FAN",
     "SDI_RESOURCE_LED",
@@ -36,25 +207,41 @@ static const char * sdi_resource_names[] = {
 };
 
 /**
- * Returns first entity from the list.
- *
- * return First entity node.
- */
-static sdi_entity_node_t * sdi_entity_find_first(void)
-{
-    return (sdi_entity_node_t*)std_dll_getfirst(&entity_list);
-}
-
-/**
- * Returns entity node, next to given node from the entity list.
+ * Allocates a zeroed record from the arena.
  *
- * node[in] - Entity node.
+ * arena[in] - arena to allocate from.
+ * size[in] - size of the record.
+ * align[in] - alignment of the record, power of 2.
  *
- * return Next to given node from the entity list.
+ * return the record.
  */
-static sdi_entity_node_t * sdi_entity_find_next(sdi_entity_node_t *node)
+static void * sdi_entity_arena_alloc(sdi_entity_arena_t *arena, size_t size, size_t align)
 {
-    return (sdi_entity_node_t*)std_dll_getnext(&entity_list, (std_dll*)node);
+    void  *record = NULL;
+    size_t pad = 0;
+
+    pthread_mutex_lock(&arena->lock);
+
+    if (arena->chunk != NULL) {
+        pad = (align - ((uintptr_t)arena->chunk & (align - 1))) & (align - 1);
+    }
+
+    if ((arena->chunk == NULL) || (pad + size > arena->left)) {
+        STD_ASSERT(size + align <= SDI_ENTITY_ARENA_CHUNK);
+
+        arena->chunk = (char*)calloc(1, SDI_ENTITY_ARENA_CHUNK);
+        STD_ASSERT(arena->chunk != NULL);
+        arena->left = SDI_ENTITY_ARENA_CHUNK;
+        pad = (align - ((uintptr_t)arena->chunk & (align - 1))) & (align - 1);
+    }
+
+    record = arena->chunk + pad;
+    arena->chunk += pad + size;
+    arena->left -= pad + size;
+
+    pthread_mutex_unlock(&arena->lock);
+
+    return record;
 }
 
 /**
@@ -92,25 +279,32 @@ static sdi_entity_type_t sdi_entity_string_to_type(const char *entity_name)
  */
 static sdi_entity_hdl_t sdi_entity_create(sdi_entity_type_t type, uint_t instance, const char *name)
 {
+    sdi_entity_priv_hdl_t entity_hdl = NULL;
+
     STD_ASSERT(name != NULL);
 
-    sdi_entity_priv_hdl_t entity_hdl = (sdi_entity_priv_hdl_t)calloc(1, sizeof(struct sdi_entity));
+    entity_hdl = (sdi_entity_priv_hdl_t)sdi_entity_arena_alloc(&sdi_entity_arena, sizeof(struct sdi_entity),
+                                                               SDI_ENTITY_CACHE_LINE);
 
-    STD_ASSERT(entity_hdl != NULL);
+    entity_hdl->cold = (sdi_entity_cold_t*)calloc(1, sizeof(sdi_entity_cold_t));
+    STD_ASSERT(entity_hdl->cold != NULL);
 
-    strncpy(entity_hdl->name, name, SDI_MAX_NAME_LEN);
+    entity_hdl->cold->name = sdi_string_intern(name);
     entity_hdl->type = type;
     entity_hdl->instance = instance;
     entity_hdl->presence.type = SDI_ENTITY_FIXED;
+    entity_hdl->presence.present = sdi_string_intern("");
+    entity_hdl->presence.not_present = sdi_string_intern("");
     entity_hdl->status.is_supported = false;
+    entity_hdl->status.ok = sdi_string_intern("");
+    entity_hdl->status.fault = sdi_string_intern("");
     entity_hdl->power.is_supported = false;
+    entity_hdl->power.status_present = sdi_string_intern("");
+    entity_hdl->power.status_not_present = sdi_string_intern("");
+    entity_hdl->cold->power_ctl.power_on = sdi_string_intern("");
+    entity_hdl->cold->power_ctl.power_off = sdi_string_intern("");
     entity_hdl->entity_info_hdl = NULL;
 
-    entity_hdl->resource_list = (std_dll_head*)calloc(1, sizeof(std_dll_head));
-    STD_ASSERT(entity_hdl->resource_list != NULL);
-
-    std_dll_init(entity_hdl->resource_list);
-
     return (sdi_entity_hdl_t)entity_hdl;
 }
 
@@ -138,6 +332,25 @@ static sdi_resource_type_t sdi_resource_string_to_type(const char *resource_name
     return (sdi_resource_type_t)entity_index;
 }
 
+/**
+ * Calculates the hash of an entity or resource name.
+ *
+ * name[in] - name to hash.
+ *
+ * return hash of the name.
+ */
+static uint32_t sdi_entity_name_hash(const char *name)
+{
+    uint32_t hash = 2166136261u;
+
+    /* FNV-1a */
+    while (*name != '\0') {
+        hash = (hash ^ (uint8_t)*name++) * 16777619u;
+    }
+
+    return hash;
+}
+
 /**
  * Adds the specified resource to specified entity.
  *
@@ -149,19 +362,193 @@ static sdi_resource_type_t sdi_resource_string_to_type(const char *resource_name
  */
 static void sdi_entity_add_resource(sdi_entity_hdl_t ehdl, sdi_resource_hdl_t resource, const char *name)
 {
-    sdi_entity_resource_node_t *newnode = NULL;
+    sdi_entity_priv_hdl_t    entity_hdl = (sdi_entity_priv_hdl_t)ehdl;
+    sdi_entity_cold_t       *cold = entity_hdl->cold;
+    sdi_resource_priv_hdl_t  resource_hdl = (sdi_resource_priv_hdl_t)resource;
+    sdi_resource_priv_hdl_t *tail = NULL;
+    uint_t                   type = (uint_t)resource_hdl->type;
 
     STD_ASSERT(name != NULL);
+    STD_ASSERT(type < SDI_RESOURCE_TYPES);
+
+    resource_hdl->cold->alias = sdi_string_intern(name);
+
+    /*
+     * Resources are only added before the entity is published, so the arrays can
+     * be reallocated without the readers noticing.
+     */
+    if (entity_hdl->resource_total == cold->resource_size) {
+        cold->resource_size = (cold->resource_size == 0) ? 8 : (2 * cold->resource_size);
+        entity_hdl->resource_list = (sdi_resource_hdl_t*)realloc(entity_hdl->resource_list,
+                                        cold->resource_size * sizeof(sdi_resource_hdl_t));
+        STD_ASSERT(entity_hdl->resource_list != NULL);
+    }
 
-    newnode = (sdi_entity_resource_node_t*)calloc(1, sizeof(sdi_entity_resource_node_t));
-    STD_ASSERT(newnode != NULL);
+    if (entity_hdl->resource_count[type] == cold->resource_type_size[type]) {
+        cold->resource_type_size[type] = (cold->resource_type_size[type] == 0)
+                                         ? 4 : (2 * cold->resource_type_size[type]);
+        entity_hdl->resources[type] = (sdi_resource_hdl_t*)realloc(entity_hdl->resources[type],
+                                          cold->resource_type_size[type] * sizeof(sdi_resource_hdl_t));
+        STD_ASSERT(entity_hdl->resources[type] != NULL);
+    }
 
-    strncpy(((sdi_resource_priv_hdl_t)resource)->alias, name,
-            sizeof(((sdi_resource_priv_hdl_t)resource)->alias));
+    resource_hdl->entity = entity_hdl;
+    resource_hdl->seq = entity_hdl->resource_total;
+    resource_hdl->index = entity_hdl->resource_count[type];
+    entity_hdl->resource_list[entity_hdl->resource_total++] = resource;
+    entity_hdl->resources[type][entity_hdl->resource_count[type]++] = resource;
 
-    newnode->hdl = resource;
+    /* Appended to the bucket, so a duplicate alias resolves to the first one, as the list did */
+    tail = &cold->by_alias[sdi_entity_name_hash(name) & (SDI_RESOURCE_ALIAS_BUCKETS - 1)];
+    while (*tail != NULL) {
+        tail = &(*tail)->cold->alias_next;
+    }
+    *tail = resource_hdl;
+}
 
-    std_dll_insertatback(((sdi_entity_priv_hdl_t)ehdl)->resource_list, (std_dll*)newnode);
+/**
+ * Calculates the bucket of the settings node in the settings index.
+ *
+ * parent[in] - parent config node.
+ * name[in] - name of the node.
+ *
+ * return bucket of the node.
+ */
+static uint_t sdi_settings_bucket(std_config_node_t parent, const char *name)
+{
+    uint32_t hash = sdi_entity_name_hash(name) ^ (uint32_t)((uintptr_t)parent >> 4);
+
+    return (hash * 2654435761u) & (sdi_settings_index.size - 1);
+}
+
+/**
+ * Adds the named children of the config node to the settings index.
+ *
+ * A name repeated under the same parent is reported, the first node keeps it, as it
+ * did with the scan of the children.
+ *
+ * parent[in] - parent config node.
+ *
+ * return None.
+ */
+static void sdi_settings_index_add(std_config_node_t parent)
+{
+    std_config_node_t      child = NULL;
+    sdi_settings_entry_t  *entry = NULL;
+    sdi_settings_entry_t **tail = NULL;
+    const char            *name = NULL;
+
+    for (child = sdi_config_get_child(parent); (child != NULL); child = sdi_config_next_node(child)) {
+        if ((name = sdi_config_attr_get(child, "name")) == NULL) {
+            continue;
+        }
+
+        tail = &sdi_settings_index.buckets[sdi_settings_bucket(parent, name)];
+        while ((*tail != NULL) && (((*tail)->parent != parent) || (strcmp((*tail)->name, name) != 0))) {
+            tail = &(*tail)->next;
+        }
+
+        if (*tail != NULL) {
+            SDI_ERRMSG_LOG("%s: duplicate settings \"%s\" under \"%s\", the first one is used\n",
+                           SDI_DEVICE_CONFIG_FILE, name,
+                           (sdi_config_attr_get(parent, "name") != NULL)
+                           ? sdi_config_attr_get(parent, "name") : sdi_config_name_get(parent));
+            continue;
+        }
+
+        STD_ASSERT(sdi_settings_index.count < sdi_settings_index.capacity);
+
+        entry = &sdi_settings_index.entries[sdi_settings_index.count++];
+        entry->parent = parent;
+        entry->node = child;
+        entry->name = name;
+        *tail = entry;
+    }
+}
+
+/**
+ * Builds the settings index of device.xml in one pass.
+ *
+ * Indexes the entity settings under the root and the settings of the entities and
+ * their resources under each of them.
+ *
+ * root[in] - root config node of device.xml.
+ *
+ * return None.
+ */
+static void sdi_settings_index_build(std_config_node_t root)
+{
+    std_config_node_t entity = NULL;
+    std_config_node_t child = NULL;
+    uint_t            count = 0;
+    uint_t            size = SDI_SETTINGS_MIN_BUCKETS;
+
+    STD_ASSERT(root != NULL);
+
+    for (entity = sdi_config_get_child(root); (entity != NULL); entity = sdi_config_next_node(entity)) {
+        count++;
+        for (child = sdi_config_get_child(entity); (child != NULL); child = sdi_config_next_node(child)) {
+            count++;
+        }
+    }
+
+    while (size < 2 * count) {
+        size *= 2;
+    }
+
+    sdi_settings_index.size = size;
+    sdi_settings_index.capacity = (count > 0) ? count : 1;
+    sdi_settings_index.count = 0;
+    sdi_settings_index.buckets = (sdi_settings_entry_t**)calloc(size, sizeof(sdi_settings_entry_t*));
+    STD_ASSERT(sdi_settings_index.buckets != NULL);
+    sdi_settings_index.entries = (sdi_settings_entry_t*)calloc(sdi_settings_index.capacity,
+                                                               sizeof(sdi_settings_entry_t));
+    STD_ASSERT(sdi_settings_index.entries != NULL);
+
+    sdi_settings_index_add(root);
+    for (entity = sdi_config_get_child(root); (entity != NULL); entity = sdi_config_next_node(entity)) {
+        sdi_settings_index_add(entity);
+    }
+}
+
+/**
+ * Frees the settings index, the config nodes it refers to are about to be unloaded.
+ *
+ * return None.
+ */
+static void sdi_settings_index_free(void)
+{
+    free(sdi_settings_index.buckets);
+    free(sdi_settings_index.entries);
+    memset(&sdi_settings_index, 0, sizeof(sdi_settings_index));
+}
+
+/**
+ * Gets the child config node by the specified name.
+ *
+ * The name must match exactly. Looked up in the settings index, so the parent must
+ * be the root of device.xml or one of its children.
+ *
+ * node[in] - parent config node.
+ * name[in] - name of child config node.
+ *
+ * return child config node or NULL it doesn't exist.
+ */
+static std_config_node_t sdi_settings_get_child_by_name(std_config_node_t node, const char *name)
+{
+    sdi_settings_entry_t *entry = NULL;
+
+    STD_ASSERT(node != NULL);
+    STD_ASSERT(name != NULL);
+    STD_ASSERT(sdi_settings_index.buckets != NULL);
+
+    for (entry = sdi_settings_index.buckets[sdi_settings_bucket(node, name)]; entry != NULL; entry = entry->next) {
+        if ((entry->parent == node) && (strcmp(entry->name, name) == 0)) {
+            return entry->node;
+        }
+    }
+
+    return NULL;
 }
 
 /**
@@ -178,17 +565,10 @@ static void sdi_resource_register_settings(sdi_resource_priv_hdl_t hdl,
                                            std_config_node_t       st_node)
 {
     std_config_node_t node = NULL;
-    bool              settings_found = false;
 
     /* Find settings for the specified resource */
-    for (node = std_config_get_child(st_node); (node != NULL); node = std_config_next_node(node)) {
-        if (strncmp(hdl->reference, std_config_attr_get(node, "name"), sizeof(hdl->reference)) == 0) {
-            settings_found = true;
-            break;
-        }
-    }
-
-    STD_ASSERT(settings_found != false);
+    node = sdi_settings_get_child_by_name(st_node, hdl->cold->reference);
+    STD_ASSERT(node != NULL);
 
     /* Register settings for the specified resource */
     switch (hdl->type) {
@@ -218,6 +598,189 @@ static void sdi_resource_register_settings(sdi_resource_priv_hdl_t hdl,
     }
 }
 
+/**
+ * Calculates the digest of the resource config.
+ *
+ * node[in] - config node of the resource in entity.xml.
+ * settings_node[in] - settings of the resource in device.xml.
+ *
+ * return digest of the config.
+ */
+static uint32_t sdi_resource_digest(std_config_node_t node, std_config_node_t settings_node)
+{
+    return sdi_config_digest(sdi_config_digest(SDI_CONFIG_DIGEST_INIT, node, false), settings_node, true);
+}
+
+/**
+ * Calculates the digest of the entity config, without the settings of its resources.
+ *
+ * It covers what sdi_register_entity() reads for the entity itself: its attributes,
+ * the attributes of its settings node and the presence, fault, power control, power
+ * and rating settings.
+ *
+ * node[in] - config node of the entity in entity.xml.
+ * settings_node[in] - settings of the entity in device.xml.
+ *
+ * return digest of the config.
+ */
+static uint32_t sdi_entity_digest(std_config_node_t node, std_config_node_t settings_node)
+{
+    std_config_node_t child = NULL;
+    const char       *name = NULL;
+    uint32_t          hash = SDI_CONFIG_DIGEST_INIT;
+    uint_t            i = 0;
+
+    hash = sdi_config_digest(hash, node, false);
+    hash = sdi_config_digest(hash, settings_node, false);
+
+    for (i = 0; i < sizeof(sdi_entity_settings_refs) / sizeof(sdi_entity_settings_refs[0]); i++) {
+        if (((name = sdi_config_attr_get(node, sdi_entity_settings_refs[i])) != NULL) &&
+            ((child = sdi_settings_get_child_by_name(settings_node, name)) != NULL)) {
+            hash = sdi_config_digest(hash, child, true);
+        }
+    }
+
+    for (child = sdi_config_get_child(settings_node); child != NULL; child = sdi_config_next_node(child)) {
+        name = sdi_config_name_get(child);
+        if ((strcmp(name, "power") == 0) || (strcmp(name, "rating") == 0)) {
+            hash = sdi_config_digest(hash, child, true);
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * Checks that the settings node has the attributes the registration asserts on.
+ *
+ * node[in] - settings node, NULL if it is missing.
+ * kind[in] - entity attribute naming the settings or resource type.
+ * where[in] - alias of the entity, for the log.
+ *
+ * return true if the settings can be registered.
+ */
+static bool sdi_config_required_check(std_config_node_t node, const char *kind, const char *where)
+{
+    const sdi_config_required_t *required = NULL;
+    uint_t                       i = 0;
+
+    for (i = 0; i < sizeof(sdi_config_required) / sizeof(sdi_config_required[0]); i++) {
+        if (strcmp(sdi_config_required[i].kind, kind) == 0) {
+            required = &sdi_config_required[i];
+            break;
+        }
+    }
+
+    if (required == NULL) {
+        SDI_ERRMSG_LOG("%s: unsupported %s\n", where, kind);
+        return false;
+    }
+
+    if (node == NULL) {
+        SDI_ERRMSG_LOG("%s: no settings for %s\n", where, kind);
+        return false;
+    }
+
+    for (i = 0; (i < SDI_CONFIG_REQUIRED_MAX) && (required->attrs[i] != NULL); i++) {
+        if (sdi_config_attr_get(node, required->attrs[i]) == NULL) {
+            SDI_ERRMSG_LOG("%s: %s settings lack \"%s\"\n", where, kind, required->attrs[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Checks that the entity and its resources can be registered without asserting.
+ *
+ * Checker.check() of tools/sdi_snapshot_compile.py does the same, keep them in sync.
+ *
+ * node[in] - config node of the entity in entity.xml.
+ * settings_root[in] - root of device.xml.
+ *
+ * return true if the entity can be registered.
+ */
+static bool sdi_config_entity_check(std_config_node_t node, std_config_node_t settings_root)
+{
+    std_config_node_t settings_node = NULL;
+    std_config_node_t child = NULL;
+    std_config_node_t resource = NULL;
+    const char       *alias = sdi_config_attr_get(node, "alias");
+    const char       *type = sdi_config_attr_get(node, "type");
+    const char       *name = NULL;
+    const char       *res_type = NULL;
+    uint_t            i = 0;
+
+    if ((alias == NULL) || (type == NULL) || (sdi_config_attr_get(node, "instance") == NULL) ||
+        (sdi_config_attr_get(node, "presence") == NULL)) {
+        SDI_ERRMSG_LOG("%s: instance, type, presence and alias are required\n", sdi_config_name_get(node));
+        return false;
+    }
+
+    if (dn_std_string_to_enum(sdi_entity_names, SDI_ENTITY_TYPES, type) < 0) {
+        SDI_ERRMSG_LOG("%s: unknown type %s\n", alias, type);
+        return false;
+    }
+
+    if ((settings_node = sdi_settings_get_child_by_name(settings_root, alias)) == NULL) {
+        SDI_ERRMSG_LOG("%s: no settings in %s\n", alias, SDI_DEVICE_CONFIG_FILE);
+        return false;
+    }
+
+    for (i = 0; i < sizeof(sdi_entity_settings_refs) / sizeof(sdi_entity_settings_refs[0]); i++) {
+        name = sdi_config_attr_get(node, sdi_entity_settings_refs[i]);
+        if ((name == NULL) || ((i == 0) && (strcmp(name, "fixed") == 0))) {
+            continue;
+        }
+
+        if (!sdi_config_required_check(sdi_settings_get_child_by_name(settings_node, name),
+                                       sdi_entity_settings_refs[i], alias)) {
+            return false;
+        }
+    }
+
+    if (strcmp(type, "SDI_ENTITY_PSU_TRAY") == 0) {
+        name = sdi_config_attr_get(settings_node, "type");
+        if ((name == NULL) || ((strncmp(name, "AC", strlen("AC")) != 0) && (strncmp(name, "DC", strlen("DC")) != 0))) {
+            SDI_ERRMSG_LOG("%s: power type must be AC or DC\n", alias);
+            return false;
+        }
+
+        for (child = sdi_config_get_child(settings_node); child != NULL; child = sdi_config_next_node(child)) {
+            name = sdi_config_name_get(child);
+            if (((strcmp(name, "power") == 0) || (strcmp(name, "rating") == 0)) &&
+                !sdi_config_required_check(child, name, alias)) {
+                return false;
+            }
+        }
+    }
+
+    for (resource = sdi_config_get_child(node); resource != NULL; resource = sdi_config_next_node(resource)) {
+        name = sdi_config_attr_get(resource, "reference");
+        res_type = sdi_config_attr_get(resource, "type");
+        if ((name == NULL) || (res_type == NULL) || (sdi_config_attr_get(resource, "name") == NULL)) {
+            SDI_ERRMSG_LOG("%s: resources need reference, name and type\n", alias);
+            return false;
+        }
+
+        child = sdi_settings_get_child_by_name(settings_node, name);
+        if (!sdi_config_required_check(child, res_type, alias)) {
+            return false;
+        }
+
+        /* The LED states are in the first child */
+        if ((strcmp(res_type, "SDI_RESOURCE_LED") == 0) &&
+            (((child = sdi_config_get_child(child)) == NULL) || (sdi_config_attr_get(child, "on") == NULL) ||
+             (sdi_config_attr_get(child, "off") == NULL))) {
+            SDI_ERRMSG_LOG("%s: LED %s lacks the on and off states\n", alias, name);
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /**
  * Adds resources to the entity and registers them.
  *
@@ -231,26 +794,32 @@ static void sdi_entity_register_resources(std_config_node_t node,
                                           std_config_node_t st_node,
                                           sdi_entity_hdl_t  entity_hdl)
 {
-    std_config_node_t  resource = NULL;
-    sdi_resource_hdl_t res_hdl = NULL;
-    char              *resource_name = NULL;
-    char              *resource_reference = NULL;
-    char              *resource_type = NULL;
-
-    for ((resource = std_config_get_child(node));
+    std_config_node_t       resource = NULL;
+    sdi_resource_hdl_t      res_hdl = NULL;
+    sdi_resource_priv_hdl_t resource_hdl = NULL;
+    const char             *resource_name = NULL;
+    const char             *resource_reference = NULL;
+    const char             *resource_type = NULL;
+
+    for ((resource = sdi_config_get_child(node));
          (resource != NULL);
-         (resource = std_config_next_node(resource))) {
-        STD_ASSERT((resource_reference = std_config_attr_get(resource, "reference")) != NULL);
-        STD_ASSERT((resource_name = std_config_attr_get(resource, "name")) != NULL);
-        STD_ASSERT((resource_type = std_config_attr_get(resource, "type")) != NULL);
+         (resource = sdi_config_next_node(resource))) {
+        STD_ASSERT((resource_reference = sdi_config_attr_get(resource, "reference")) != NULL);
+        STD_ASSERT((resource_name = sdi_config_attr_get(resource, "name")) != NULL);
+        STD_ASSERT((resource_type = sdi_config_attr_get(resource, "type")) != NULL);
+
+        resource_hdl = (sdi_resource_priv_hdl_t)sdi_entity_arena_alloc(&sdi_resource_arena,
+                                                                       sizeof(struct sdi_resource), sizeof(void*));
 
-        sdi_resource_priv_hdl_t resource_hdl = (sdi_resource_priv_hdl_t)calloc(1, sizeof(struct sdi_resource));
-        STD_ASSERT(resource_hdl != NULL);
+        resource_hdl->cold = (sdi_resource_cold_t*)calloc(1, sizeof(sdi_resource_cold_t));
+        STD_ASSERT(resource_hdl->cold != NULL);
 
-        strncpy(resource_hdl->name, resource_name, sizeof(resource_hdl->name));
-        strncpy(resource_hdl->reference, resource_reference, sizeof(resource_hdl->reference));
+        resource_hdl->cold->name = sdi_string_intern(resource_name);
+        resource_hdl->cold->reference = sdi_string_intern(resource_reference);
         resource_hdl->type = sdi_resource_string_to_type(resource_type);
         sdi_resource_register_settings(resource_hdl, (sdi_entity_priv_hdl_t)entity_hdl, st_node);
+        resource_hdl->cold->digest = sdi_resource_digest(resource,
+                                                         sdi_settings_get_child_by_name(st_node, resource_reference));
 
         res_hdl = (sdi_resource_hdl_t)(resource_hdl);
 
@@ -264,49 +833,120 @@ static void sdi_entity_register_resources(std_config_node_t node,
 }
 
 /**
- * Adds entity handler to the entity list.
+ * Calculates the bucket of the entity name in the name index.
  *
- * hdl[in] - Handler of entity which needs to be added to entity list.
+ * name[in] - name of the entity.
  *
- * return None.
+ * return bucket of the name.
  */
-static void sdi_add_entity(sdi_entity_hdl_t entity_hdl)
+static uint_t sdi_entity_name_bucket(const char *name)
 {
-    sdi_entity_node_t *node = NULL;
-
-    node = (sdi_entity_node_t*)calloc(1, sizeof(sdi_entity_node_t));
-    STD_ASSERT(node != NULL);
+    return sdi_entity_name_hash(name) & (SDI_ENTITY_NAME_BUCKETS - 1);
+}
 
-    node->entity_hdl = entity_hdl;
-    std_dll_insertatfront(&entity_list, (std_dll*)node);
+/**
+ * Gets the current snapshot of the entities, to be called in a read-side section.
+ *
+ * return the snapshot, valid until the section is left.
+ */
+static inline sdi_entity_db_t * sdi_entity_db_get(void)
+{
+    return __atomic_load_n(&sdi_entity_index.db, __ATOMIC_ACQUIRE);
 }
 
 /**
- * Gets the child config node by the specified name.
+ * Adds the entity to the index.
  *
- * node[in] - parent config node.
- * name[in] - name of child config node.
+ * The snapshot is copied whole, registration adds few enough entities for that to
+ * cost less than a single SysFs access per entity.
  *
- * return child config node or NULL it doesn't exist.
+ * node[in] - node of the entity in the name index.
+ *
+ * return None.
  */
-static std_config_node_t sdi_settings_get_child_by_name(std_config_node_t node, const char *name)
+static void sdi_entity_index_add(sdi_entity_node_t *node)
 {
-    std_config_node_t child = NULL;
-    bool              found = false;
+    sdi_entity_priv_hdl_t hdl = (sdi_entity_priv_hdl_t)node->entity_hdl;
+    sdi_entity_db_t      *old = NULL;
+    sdi_entity_db_t      *db = NULL;
+    sdi_entity_hdl_t     *slots = NULL;
+    uint_t                size[SDI_ENTITY_TYPES];
+    uint_t                total = 0;
+    uint_t                type = 0;
+    uint_t                bucket = sdi_entity_name_bucket(hdl->cold->name);
 
-    STD_ASSERT(node != NULL);
-    STD_ASSERT(name != NULL);
+    STD_ASSERT((uint_t)hdl->type < SDI_ENTITY_TYPES);
 
-    for (child = std_config_get_child(node); (child != NULL); child = std_config_next_node(child)) {
-        if (strncmp(name, std_config_attr_get(child, "name"), strlen(name)) == 0) {
-            found = true;
-            break;
+    pthread_mutex_lock(&sdi_entity_index.lock);
+
+    old = sdi_entity_index.db;
+
+    memcpy(size, old->size, sizeof(size));
+    if (hdl->instance >= size[hdl->type]) {
+        size[hdl->type] = hdl->instance + 1;
+    }
+
+    total = old->all_count + 1;
+    for (type = 0; type < SDI_ENTITY_TYPES; type++) {
+        total += size[type];
+    }
+
+    db = (sdi_entity_db_t*)calloc(1, sizeof(*db) + total * sizeof(sdi_entity_hdl_t));
+    STD_ASSERT(db != NULL);
+
+    memcpy(db->count, old->count, sizeof(db->count));
+    memcpy(db->by_name, old->by_name, sizeof(db->by_name));
+    memcpy(db->all, old->all, old->all_count * sizeof(sdi_entity_hdl_t));
+    db->all[old->all_count] = node->entity_hdl;
+    db->all_count = old->all_count + 1;
+    db->count[hdl->type]++;
+
+    slots = &db->all[db->all_count];
+    for (type = 0; type < SDI_ENTITY_TYPES; type++) {
+        db->tables[type] = slots;
+        db->size[type] = size[type];
+        if (old->size[type] > 0) {
+            memcpy(slots, old->tables[type], old->size[type] * sizeof(sdi_entity_hdl_t));
         }
+        slots += size[type];
+    }
+    db->tables[hdl->type][hdl->instance] = node->entity_hdl;
+
+    /*
+     * Prepended, so a duplicate name resolves to the last entity. The rest of the
+     * chain is shared with the older snapshots, nodes are never modified once linked.
+     */
+    node->name_next = old->by_name[bucket];
+    db->by_name[bucket] = node;
+
+    __atomic_store_n(&sdi_entity_index.db, db, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&sdi_entity_index.lock);
+
+    if (old != &sdi_entity_db_empty) {
+        sdi_epoch_retire(old, free);
     }
+}
+
+/**
+ * Adds entity handler to the entity list.
+ *
+ * hdl[in] - Handler of entity which needs to be added to entity list.
+ *
+ * return None.
+ */
+static void sdi_add_entity(sdi_entity_hdl_t entity_hdl)
+{
+    sdi_entity_node_t *node = NULL;
+
+    node = (sdi_entity_node_t*)calloc(1, sizeof(sdi_entity_node_t));
+    STD_ASSERT(node != NULL);
 
-    return (found == true) ? child : NULL;
+    node->entity_hdl = entity_hdl;
+    sdi_entity_index_add(node);
 }
 
+
 /**
  * Registers "presence" settings for the swappable entity.
  *
@@ -321,10 +961,10 @@ static void sdi_entity_presence_register(sdi_entity_priv_hdl_t hdl,
                                          const char           *pres_name)
 {
     std_config_node_t node = NULL;
-    char             *name = NULL;
-    char             *path = NULL;
-    char             *stat_present = NULL;
-    char             *stat_not_present = NULL;
+    const char       *name = NULL;
+    const char       *path = NULL;
+    const char       *stat_present = NULL;
+    const char       *stat_not_present = NULL;
 
     STD_ASSERT(hdl != NULL);
     STD_ASSERT(hdl->presence.type != SDI_ENTITY_FIXED);
@@ -332,15 +972,15 @@ static void sdi_entity_presence_register(sdi_entity_priv_hdl_t hdl,
     node = sdi_settings_get_child_by_name(entity_node, pres_name);
     STD_ASSERT(node != NULL);
 
-    STD_ASSERT((name = std_config_attr_get(node, "name")) != NULL);
-    STD_ASSERT((path = std_config_attr_get(node, "path")) != NULL);
-    STD_ASSERT((stat_present = std_config_attr_get(node, "present")) != NULL);
-    STD_ASSERT((stat_not_present = std_config_attr_get(node, "not_present")) != NULL);
+    STD_ASSERT((name = sdi_config_attr_get(node, "name")) != NULL);
+    STD_ASSERT((path = sdi_config_attr_get(node, "path")) != NULL);
+    STD_ASSERT((stat_present = sdi_config_attr_get(node, "present")) != NULL);
+    STD_ASSERT((stat_not_present = sdi_config_attr_get(node, "not_present")) != NULL);
 
-    strncpy(hdl->presence.name, name, sizeof(hdl->presence.name));
-    strncpy(hdl->presence.path, path, sizeof(hdl->presence.path));
-    strncpy(hdl->presence.present, stat_present, sizeof(hdl->presence.present));
-    strncpy(hdl->presence.not_present, stat_not_present, sizeof(hdl->presence.not_present));
+    hdl->presence.attr = sdi_sysfs_hdl_create(path, name, SDI_SYSFS_ATTR_STR, SDI_SYSFS_HDL_F_PIN);
+    hdl->presence.watch = sdi_sysfs_watch_add(hdl->presence.attr, SDI_ENTITY_WATCH_POLL_MS);
+    hdl->presence.present = sdi_string_intern(stat_present);
+    hdl->presence.not_present = sdi_string_intern(stat_not_present);
 }
 
 /**
@@ -355,10 +995,10 @@ static void sdi_entity_presence_register(sdi_entity_priv_hdl_t hdl,
 static void sdi_entity_fault_register(sdi_entity_priv_hdl_t hdl, std_config_node_t entity_node, const char *fault_name)
 {
     std_config_node_t node = NULL;
-    char             *name = NULL;
-    char             *path = NULL;
-    char             *stat_ok = NULL;
-    char             *stat_fault = NULL;
+    const char       *name = NULL;
+    const char       *path = NULL;
+    const char       *stat_ok = NULL;
+    const char       *stat_fault = NULL;
 
     STD_ASSERT(hdl != NULL);
     STD_ASSERT(hdl->status.is_supported != false);
@@ -366,15 +1006,15 @@ static void sdi_entity_fault_register(sdi_entity_priv_hdl_t hdl, std_config_node
     node = sdi_settings_get_child_by_name(entity_node, fault_name);
     STD_ASSERT(node != NULL);
 
-    STD_ASSERT((name = std_config_attr_get(node, "name")) != NULL);
-    STD_ASSERT((path = std_config_attr_get(node, "path")) != NULL);
-    STD_ASSERT((stat_ok = std_config_attr_get(node, "ok")) != NULL);
-    STD_ASSERT((stat_fault = std_config_attr_get(node, "fault")) != NULL);
+    STD_ASSERT((name = sdi_config_attr_get(node, "name")) != NULL);
+    STD_ASSERT((path = sdi_config_attr_get(node, "path")) != NULL);
+    STD_ASSERT((stat_ok = sdi_config_attr_get(node, "ok")) != NULL);
+    STD_ASSERT((stat_fault = sdi_config_attr_get(node, "fault")) != NULL);
 
-    strncpy(hdl->status.name, name, sizeof(hdl->presence.name));
-    strncpy(hdl->status.path, path, sizeof(hdl->presence.path));
-    strncpy(hdl->status.ok, stat_ok, sizeof(hdl->status.ok));
-    strncpy(hdl->status.fault, stat_fault, sizeof(hdl->status.fault));
+    hdl->status.attr = sdi_sysfs_hdl_create(path, name, SDI_SYSFS_ATTR_STR, SDI_SYSFS_HDL_F_PIN);
+    hdl->status.watch = sdi_sysfs_watch_add(hdl->status.attr, SDI_ENTITY_WATCH_POLL_MS);
+    hdl->status.ok = sdi_string_intern(stat_ok);
+    hdl->status.fault = sdi_string_intern(stat_fault);
 }
 
 /**
@@ -388,17 +1028,17 @@ static void sdi_entity_fault_register(sdi_entity_priv_hdl_t hdl, std_config_node
 static void sdi_entity_power_register(sdi_entity_priv_hdl_t hdl, std_config_node_t entity_node)
 {
     std_config_node_t node = NULL;
-    char             *type = NULL;
-    char             *name = NULL;
-    char             *path = NULL;
-    char             *present = NULL;
-    char             *not_present = NULL;
+    const char       *type = NULL;
+    const char       *name = NULL;
+    const char       *path = NULL;
+    const char       *present = NULL;
+    const char       *not_present = NULL;
 
     STD_ASSERT(hdl != NULL);
     STD_ASSERT(hdl->power.is_supported != false);
 
     /* Get power type (AC/DC) */
-    STD_ASSERT((type = std_config_attr_get(entity_node, "type")) != NULL);
+    STD_ASSERT((type = sdi_config_attr_get(entity_node, "type")) != NULL);
     if (strncmp("AC", type, strlen("AC")) == 0) {
         hdl->power.type.ac_power = true;
     } else if (strncmp("DC", type, strlen("DC")) == 0) {
@@ -407,208 +1047,500 @@ static void sdi_entity_power_register(sdi_entity_priv_hdl_t hdl, std_config_node
         STD_ASSERT(false);
     }
 
-    for (node = std_config_get_child(entity_node); (node != NULL); node = std_config_next_node(node)) {
-        if (strcmp("power", std_config_name_get(node)) == 0) {
-            /* Get "power status" settings */
-            STD_ASSERT((name = std_config_attr_get(node, "name")) != NULL);
-            STD_ASSERT((path = std_config_attr_get(node, "path")) != NULL);
-            STD_ASSERT((present = std_config_attr_get(node, "present")) != NULL);
-            STD_ASSERT((not_present = std_config_attr_get(node, "not_present")) != NULL);
-
-            strncpy(hdl->power.status_name, name, sizeof(hdl->power.status_name));
-            strncpy(hdl->power.status_path, path, sizeof(hdl->power.status_path));
-            strncpy(hdl->power.status_present, present, sizeof(hdl->power.status_present));
-            strncpy(hdl->power.status_not_present, not_present, sizeof(hdl->power.status_not_present));
-        } else if (strcmp("rating", std_config_name_get(node))) {
-            /* Get "power rating" settings */
-            STD_ASSERT((name = std_config_attr_get(node, "name")) != NULL);
-            STD_ASSERT((path = std_config_attr_get(node, "path")) != NULL);
+    for (node = sdi_config_get_child(entity_node); (node != NULL); node = sdi_config_next_node(node)) {
+        if (strcmp("power", sdi_config_name_get(node)) == 0) {
+            /* Get "power status" settings */
+            STD_ASSERT((name = sdi_config_attr_get(node, "name")) != NULL);
+            STD_ASSERT((path = sdi_config_attr_get(node, "path")) != NULL);
+            STD_ASSERT((present = sdi_config_attr_get(node, "present")) != NULL);
+            STD_ASSERT((not_present = sdi_config_attr_get(node, "not_present")) != NULL);
+
+            hdl->power.status_attr = sdi_sysfs_hdl_create(path, name, SDI_SYSFS_ATTR_STR, SDI_SYSFS_HDL_F_PIN);
+            hdl->power.status_watch = sdi_sysfs_watch_add(hdl->power.status_attr, SDI_ENTITY_WATCH_POLL_MS);
+            hdl->power.status_present = sdi_string_intern(present);
+            hdl->power.status_not_present = sdi_string_intern(not_present);
+        } else if (strcmp("rating", sdi_config_name_get(node)) == 0) {
+            /* Get "power rating" settings */
+            STD_ASSERT((name = sdi_config_attr_get(node, "name")) != NULL);
+            STD_ASSERT((path = sdi_config_attr_get(node, "path")) != NULL);
+
+            hdl->power.rating_attr = sdi_sysfs_hdl_create(path, name, SDI_SYSFS_ATTR_UINT, 0);
+        }
+    }
+}
+
+/**
+ * Registers "power control" settings for the entity.
+ *
+ * hdl[in] - handler of the specified entity.
+ * entity_node[in] - config node for the entity settings.
+ * pwr_hdl_name[in] - the "power control" settings name.
+ *
+ * return None.
+ */
+static void sdi_entity_pwrctl_register(sdi_entity_priv_hdl_t hdl,
+                                       std_config_node_t     entity_node,
+                                       const char           *pwr_hdl_name)
+{
+    std_config_node_t node = NULL;
+    const char       *path = NULL;
+    const char       *reset_attr = NULL;
+    const char       *power_hdl_attr = NULL;
+
+    STD_ASSERT(hdl != NULL);
+
+    node = sdi_settings_get_child_by_name(entity_node, pwr_hdl_name);
+    STD_ASSERT(node != NULL);
+
+    STD_ASSERT((path = sdi_config_attr_get(node, "path")) != NULL);
+
+    /* Register reset related settings */
+    if ((reset_attr = sdi_config_attr_get(node, "reset")) != NULL) {
+        hdl->cold->power_ctl.reset = sdi_sysfs_hdl_create(path, reset_attr, SDI_SYSFS_ATTR_UINT, 0);
+    } else {
+        hdl->cold->power_ctl.reset = NULL;
+    }
+
+    /* Register power control related settings */
+    if ((power_hdl_attr = sdi_config_attr_get(node, "powerhdl")) != NULL) {
+        hdl->cold->power_ctl.powerhdl = sdi_sysfs_hdl_create(path, power_hdl_attr, SDI_SYSFS_ATTR_STR,
+                                                       SDI_SYSFS_HDL_F_SHADOW);
+    } else {
+        hdl->cold->power_ctl.powerhdl = NULL;
+    }
+
+    if ((power_hdl_attr = sdi_config_attr_get(node, "power_on")) != NULL) {
+        hdl->cold->power_ctl.power_on = sdi_string_intern(power_hdl_attr);
+    } else {
+        hdl->cold->power_ctl.power_on = sdi_string_intern("");
+    }
+
+    if ((power_hdl_attr = sdi_config_attr_get(node, "power_off")) != NULL) {
+        hdl->cold->power_ctl.power_off = sdi_string_intern(power_hdl_attr);
+    } else {
+        hdl->cold->power_ctl.power_off = sdi_string_intern("");
+    }
+}
+
+/**
+ * Allocates and Initializes the data structures for a given node and adds it to entity
+ * list.
+ *
+ * node[in] - Node whose attribute values needs to be determined.
+ * settings_root[in] - root of device.xml.
+ *
+ * return handle of the entity.
+ */
+static sdi_entity_hdl_t sdi_register_entity(std_config_node_t node, std_config_node_t settings_root)
+{
+    const char       *entity_name = sdi_config_name_get(node);
+    const char       *alias_name = NULL;
+    char              alias[SDI_MAX_NAME_LEN];
+    const char       *config_attr = NULL;
+    const char       *entity_presence = NULL;
+    const char       *entity_fault = NULL;
+    const char       *entity_power_ctl = NULL;
+    uint_t            instance = 0;
+    sdi_entity_type_t entity_type = 0;
+    sdi_entity_hdl_t  entity_hdl = NULL;
+    std_config_node_t settings_node = NULL;
+
+    memset(alias, '\0', sizeof(alias));
+
+    /* Get instance value */
+    STD_ASSERT((config_attr = sdi_config_attr_get(node, "instance")) != NULL);
+    instance = atoi(config_attr);
+
+    /* Get alias value */
+    alias_name = sdi_config_attr_get(node, "alias");
+    if (alias_name == NULL) {
+        snprintf(alias, SDI_MAX_NAME_LEN, "%s-%u", entity_name, instance);
+    } else {
+        strncpy(alias, alias_name, sizeof(alias));
+    }
+
+    /* Get type value */
+    STD_ASSERT((config_attr = sdi_config_attr_get(node, "type")) != NULL);
+    entity_type = sdi_entity_string_to_type(config_attr);
+
+    STD_ASSERT((entity_presence = sdi_config_attr_get(node, "presence")) != NULL);
+
+    SDI_TRACEMSG_LOG("\nRegistering entity: %s@%d\n", config_attr, instance);
+
+    entity_hdl = sdi_entity_create(entity_type, instance, alias);
+    STD_ASSERT(entity_hdl);
+
+    settings_node = sdi_settings_get_child_by_name(settings_root, alias_name);
+    STD_ASSERT(settings_node != NULL);
+
+    /* Register "presence" related settings */
+    if (strncmp(entity_presence, "fixed", sizeof(entity_presence)) == 0) {
+        ((sdi_entity_priv_hdl_t)entity_hdl)->presence.type = SDI_ENTITY_FIXED;
+    } else {
+        ((sdi_entity_priv_hdl_t)entity_hdl)->presence.type = SDI_ENTITY_SWAPPABLE;
+        sdi_entity_presence_register((sdi_entity_priv_hdl_t)entity_hdl, settings_node, entity_presence);
+    }
+
+    /* Register "fault status" related settings */
+    if ((entity_fault = sdi_config_attr_get(node, "fault")) != NULL) {
+        ((sdi_entity_priv_hdl_t)entity_hdl)->status.is_supported = true;
+        sdi_entity_fault_register((sdi_entity_priv_hdl_t)entity_hdl, settings_node, entity_fault);
+    } else {
+        ((sdi_entity_priv_hdl_t)entity_hdl)->status.is_supported = false;
+    }
+
+    /* Register power related settings for PSU */
+    if (((sdi_entity_priv_hdl_t)entity_hdl)->type == SDI_ENTITY_PSU_TRAY) {
+        ((sdi_entity_priv_hdl_t)entity_hdl)->power.is_supported = true;
+        sdi_entity_power_register((sdi_entity_priv_hdl_t)entity_hdl, settings_node);
+    } else {
+        ((sdi_entity_priv_hdl_t)entity_hdl)->power.is_supported = false;
+    }
+
+    /* Register "power control" related settings */
+    if ((entity_power_ctl = sdi_config_attr_get(node, "power_ctl")) != NULL) {
+        sdi_entity_pwrctl_register((sdi_entity_priv_hdl_t)entity_hdl, settings_node, entity_power_ctl);
+    } else {
+        ((sdi_entity_priv_hdl_t)entity_hdl)->cold->power_ctl.reset = NULL;
+        ((sdi_entity_priv_hdl_t)entity_hdl)->cold->power_ctl.powerhdl = NULL;
+        ((sdi_entity_priv_hdl_t)entity_hdl)->cold->power_ctl.power_on = sdi_string_intern("");
+        ((sdi_entity_priv_hdl_t)entity_hdl)->cold->power_ctl.power_off = sdi_string_intern("");
+    }
+
+    sdi_entity_register_resources(node, settings_node, entity_hdl);
+    ((sdi_entity_priv_hdl_t)entity_hdl)->cold->digest = sdi_entity_digest(node, settings_node);
+    sdi_add_entity(entity_hdl);
+
+    return entity_hdl;
+}
+
+/**
+ * Opens the config files the entities are registered from.
+ *
+ * The tables compiled into a platform's library come first, then the precompiled
+ * snapshot, unless the files were edited since. Either saves parsing both files.
+ *
+ * entity_cfg_file[in] - path to entity.xml.
+ * builtin[in] - whether the tables compiled into the library may be used.
+ * roots[out] - roots of the config files, NULL if a file can't be parsed.
+ *
+ * return None.
+ */
+static void sdi_config_roots_open(const char *entity_cfg_file, bool builtin, sdi_config_roots_t *roots)
+{
+    char settings_file[PATH_MAX] = {0};
+    char snapshot_file[PATH_MAX] = {0};
+
+    memset(roots, 0, sizeof(*roots));
+
+    sdi_config_file_get(SDI_DEVICE_CONFIG_FILE, settings_file, sizeof(settings_file));
+    sdi_config_file_get(SDI_CONFIG_SNAPSHOT_FILE, snapshot_file, sizeof(snapshot_file));
+
+    if ((builtin && (sdi_config_snapshot_builtin_open() == STD_ERR_OK)) ||
+        (sdi_config_snapshot_open(snapshot_file, entity_cfg_file, settings_file) == STD_ERR_OK)) {
+        roots->snapshot = true;
+        roots->entities = sdi_config_snapshot_root_get(SDI_CONFIG_SNAPSHOT_ENTITY);
+        roots->settings = sdi_config_snapshot_root_get(SDI_CONFIG_SNAPSHOT_DEVICE);
+        return;
+    }
+
+    if ((roots->entity_hdl = std_config_load(entity_cfg_file)) != NULL) {
+        roots->entities = std_config_get_root(roots->entity_hdl);
+    }
+
+    /* Load "settings" config file and find config node for the entity */
+    if ((roots->settings_hdl = std_config_load(settings_file)) != NULL) {
+        roots->settings = std_config_get_root(roots->settings_hdl);
+    }
+}
+
+/**
+ * Closes the config files, their nodes must not be used afterwards.
+ *
+ * roots[in] - roots of the config files.
+ *
+ * return None.
+ */
+static void sdi_config_roots_close(sdi_config_roots_t *roots)
+{
+    if (roots->snapshot) {
+        sdi_config_snapshot_close();
+        return;
+    }
+
+    if (roots->entity_hdl != NULL) {
+        std_config_unload(roots->entity_hdl);
+    }
+    if (roots->settings_hdl != NULL) {
+        std_config_unload(roots->settings_hdl);
+    }
+}
+
+/**
+ * Initializes internal data structures for the entity and creates entity-db.
+ *
+ * entity_cfg_file[in] - Entity config file which has information about the devices on
+ * each entity.
+ *
+ * return None.
+ */
+void sdi_register_entities(const char * entity_cfg_file)
+{
+    sdi_config_roots_t roots;
+    std_config_node_t  entity = NULL;
+
+    STD_ASSERT(entity_cfg_file != NULL);
+
+    pthread_mutex_lock(&sdi_config_reload_state.lock);
+
+    snprintf(sdi_config_reload_state.entity_file, sizeof(sdi_config_reload_state.entity_file), "%s",
+             entity_cfg_file);
+
+    sdi_config_roots_open(entity_cfg_file, true, &roots);
+
+    STD_ASSERT(roots.entities != NULL);
+    STD_ASSERT(roots.settings != NULL);
+
+    sdi_settings_index_build(roots.settings);
+
+    for (entity = sdi_config_get_child(roots.entities); (entity != NULL); entity = sdi_config_next_node(entity)) {
+        SDI_TRACEMSG_LOG("Found entity: %s\n", sdi_config_name_get(entity));
+
+        sdi_register_entity(entity, roots.settings);
+    }
+
+    sdi_settings_index_free();
+    sdi_config_roots_close(&roots);
+
+    pthread_mutex_unlock(&sdi_config_reload_state.lock);
+
+    /* Report attributes missing at startup, accesses to them fail fast afterwards */
+    sdi_sysfs_hdl_report_missing();
 
-            strncpy(hdl->power.rating_name, name, sizeof(hdl->power.rating_name));
-            strncpy(hdl->power.rating_path, path, sizeof(hdl->power.rating_path));
-        }
-    }
+    /* On failure the presence and status getters read the attributes directly */
+    sdi_sysfs_watch_start();
 }
 
 /**
- * Registers "power control" settings for the entity.
+ * Copies the settings of the resource.
  *
- * hdl[in] - handler of the specified entity.
- * entity_node[in] - config node for the entity settings.
- * pwr_hdl_name[in] - the "power control" settings name.
+ * The copy is taken inside an epoch section, so settings replaced by a reload meanwhile
+ * are released only after it. A resource of another type gets a zeroed copy.
+ *
+ * hdl[in] - handle of the resource.
+ * type[in] - type of the resource the settings are of.
+ * settings[out] - copy of the settings.
+ * size[in] - size of the settings.
  *
  * return None.
  */
-static void sdi_entity_pwrctl_register(sdi_entity_priv_hdl_t hdl,
-                                       std_config_node_t     entity_node,
-                                       const char           *pwr_hdl_name)
+void sdi_resource_settings_copy(sdi_resource_priv_hdl_t hdl, sdi_resource_type_t type, void *settings, size_t size)
 {
-    std_config_node_t node = NULL;
-    char             *path = NULL;
-    char             *reset_attr = NULL;
-    char             *power_hdl_attr = NULL;
-
     STD_ASSERT(hdl != NULL);
+    STD_ASSERT(settings != NULL);
 
-    node = sdi_settings_get_child_by_name(entity_node, pwr_hdl_name);
-    STD_ASSERT(node != NULL);
+    if (hdl->type != type) {
+        memset(settings, 0, size);
+        return;
+    }
 
-    STD_ASSERT((path = std_config_attr_get(node, "path")) != NULL);
-    strncpy(hdl->power_ctl.path, path, sizeof(hdl->power_ctl.path));
+    sdi_epoch_enter();
+    memcpy(settings, __atomic_load_n(&hdl->settings, __ATOMIC_ACQUIRE), size);
+    sdi_epoch_exit();
+}
 
-    /* Register reset related settings */
-    if ((reset_attr = std_config_attr_get(node, "reset")) != NULL) {
-        strncpy(hdl->power_ctl.reset, reset_attr, sizeof(hdl->power_ctl.reset));
-    } else {
-        *(hdl->power_ctl.reset) = "\0";
-    }
+/**
+ * Replaces the settings of the resource with ones registered from the new config.
+ *
+ * The resource is registered into a copy holding the current settings, so the
+ * registration may take state over from them, and the live one switches to the new
+ * settings with a single store. The old settings are released once the callers copying
+ * them are done. Their SysFs handles are kept, as the registry of the handles does.
+ *
+ * hdl[in] - handle of the resource.
+ * reference[in] - name of the resource settings in the new config.
+ * st_node[in] - settings of the entity in the new config.
+ *
+ * return None.
+ */
+static void sdi_resource_settings_replace(sdi_resource_priv_hdl_t hdl, const char *reference,
+                                          std_config_node_t st_node)
+{
+    struct sdi_resource scratch = *hdl;
+    void               *old = hdl->settings;
 
-    /* Register power control related settings */
-    if ((power_hdl_attr = std_config_attr_get(node, "powerhdl")) != NULL) {
-        strncpy(hdl->power_ctl.powerhdl, power_hdl_attr, sizeof(hdl->power_ctl.powerhdl));
-    } else {
-        *(hdl->power_ctl.powerhdl) = "\0";
-    }
+    /* Only the registration and the reloads, which are serialized, read the reference */
+    hdl->cold->reference = sdi_string_intern(reference);
 
-    if ((power_hdl_attr = std_config_attr_get(node, "power_on")) != NULL) {
-        strncpy(hdl->power_ctl.power_on, power_hdl_attr, sizeof(hdl->power_ctl.power_on));
-    } else {
-        *(hdl->power_ctl.power_on) = "\0";
-    }
+    sdi_resource_register_settings(&scratch, hdl->entity, st_node);
 
-    if ((power_hdl_attr = std_config_attr_get(node, "power_off")) != NULL) {
-        strncpy(hdl->power_ctl.power_off, power_hdl_attr, sizeof(hdl->power_ctl.power_off));
-    } else {
-        *(hdl->power_ctl.power_off) = "\0";
-    }
+    __atomic_store_n(&hdl->settings, scratch.settings, __ATOMIC_RELEASE);
+
+    sdi_epoch_retire(old, free);
 }
 
 /**
- * Allocates and Initializes the data structures for a given node and adds it to entity
- * list.
+ * Applies the new config of the entity.
  *
- * node[in] - Node whose attribute values needs to be determined.
+ * An entity not registered yet is registered and initialized, unless its type and
+ * instance are taken by another entity (a rename, or a swap of the slot), which is only
+ * reported. For a registered one, the resources whose config changed get new settings;
+ * changes which would drop handles or resize the resource lists are only reported.
  *
- * return None.
+ * node[in] - config node of the entity in the new entity.xml.
+ * settings_root[in] - root of the new device.xml.
+ * report[out] - changes, added to.
+ *
+ * return true if the entity was registered before.
  */
-static void sdi_register_entity(std_config_node_t node, std_config_node_t settings_root)
+static bool sdi_entity_reload(std_config_node_t node, std_config_node_t settings_root,
+                              sdi_config_reload_report_t *report)
 {
-    const char       *entity_name = std_config_name_get(node);
-    char             *alias_name = NULL;
-    char              alias[SDI_MAX_NAME_LEN];
-    char             *config_attr = NULL;
-    char             *entity_presence = NULL;
-    char             *entity_fault = NULL;
-    char             *entity_power_ctl = NULL;
-    uint_t            instance = 0;
-    sdi_entity_type_t entity_type = 0;
-    sdi_entity_hdl_t  entity_hdl = NULL;
-    std_config_node_t settings_node = NULL;
-
-    memset(alias, '\0', sizeof(alias));
+    sdi_entity_priv_hdl_t   hdl = NULL;
+    sdi_resource_priv_hdl_t res_hdl = NULL;
+    std_config_node_t       settings_node = NULL;
+    std_config_node_t       resource = NULL;
+    const char             *alias = sdi_config_attr_get(node, "alias");
+    const char             *name = NULL;
+    const char             *reference = NULL;
+    uint_t                  matched = 0;
+    uint32_t                digest = 0;
+    t_std_error             rc = STD_ERR_OK;
+
+    if ((hdl = (sdi_entity_priv_hdl_t)sdi_entity_lookup_by_name(alias)) == NULL) {
+        /* A renamed entity, or a new one in the slot of another, would be registered twice */
+        if (sdi_entity_lookup(sdi_entity_string_to_type(sdi_config_attr_get(node, "type")),
+                              atoi(sdi_config_attr_get(node, "instance"))) != NULL) {
+            SDI_ERRMSG_LOG("Reload: entity %s takes the slot of another entity, restart to apply\n", alias);
+            report->not_applied++;
+            return false;
+        }
 
-    /* Get instance value */
-    STD_ASSERT((config_attr = std_config_attr_get(node, "instance")) != NULL);
-    instance = atoi(config_attr);
+        hdl = (sdi_entity_priv_hdl_t)sdi_register_entity(node, settings_root);
+        if ((rc = sdi_entity_init((sdi_entity_hdl_t)hdl)) != STD_ERR_OK) {
+            SDI_ERRMSG_LOG("Reload: init of the added entity %s failed (rc=%d)\n", alias, rc);
+        }
+        sdi_entity_hotplug_track((sdi_entity_hdl_t)hdl);
 
-    /* Get alias value */
-    alias_name = std_config_attr_get(node, "alias");
-    if (alias_name == NULL) {
-        snprintf(alias, SDI_MAX_NAME_LEN, "%s-%u", entity_name, instance);
-    } else {
-        strncpy(alias, alias_name, sizeof(alias));
+        SDI_ERRMSG_LOG("Reload: entity %s added\n", alias);
+        report->entities_added++;
+        return false;
     }
 
-    /* Get type value */
-    STD_ASSERT((config_attr = std_config_attr_get(node, "type")) != NULL);
-    entity_type = sdi_entity_string_to_type(config_attr);
+    settings_node = sdi_settings_get_child_by_name(settings_root, alias);
 
-    STD_ASSERT((entity_presence = std_config_attr_get(node, "presence")) != NULL);
+    if (sdi_entity_digest(node, settings_node) != hdl->cold->digest) {
+        SDI_ERRMSG_LOG("Reload: settings of entity %s changed, restart to apply\n", alias);
+        report->not_applied++;
+    }
 
-    SDI_TRACEMSG_LOG("\nRegistering entity: %s@%d\n", config_attr, instance);
+    for (resource = sdi_config_get_child(node); resource != NULL; resource = sdi_config_next_node(resource)) {
+        name = sdi_config_attr_get(resource, "name");
+        reference = sdi_config_attr_get(resource, "reference");
 
-    entity_hdl = sdi_entity_create(entity_type, instance, alias);
-    STD_ASSERT(entity_hdl);
+        res_hdl = (sdi_resource_priv_hdl_t)sdi_entity_resource_lookup((sdi_entity_hdl_t)hdl,
+                      sdi_resource_string_to_type(sdi_config_attr_get(resource, "type")), name);
+        if (res_hdl == NULL) {
+            SDI_ERRMSG_LOG("Reload: resource %s added to entity %s, restart to apply\n", name, alias);
+            report->not_applied++;
+            continue;
+        }
 
-    settings_node = sdi_settings_get_child_by_name(settings_root, alias_name);
-    STD_ASSERT(settings_node != NULL);
+        matched++;
 
-    /* Register "presence" related settings */
-    if (strncmp(entity_presence, "fixed", sizeof(entity_presence)) == 0) {
-        ((sdi_entity_priv_hdl_t)entity_hdl)->presence.type = SDI_ENTITY_FIXED;
-    } else {
-        ((sdi_entity_priv_hdl_t)entity_hdl)->presence.type = SDI_ENTITY_SWAPPABLE;
-        sdi_entity_presence_register((sdi_entity_priv_hdl_t)entity_hdl, settings_node, entity_presence);
-    }
+        digest = sdi_resource_digest(resource, sdi_settings_get_child_by_name(settings_node, reference));
+        if (digest == res_hdl->cold->digest) {
+            report->resources_unchanged++;
+            continue;
+        }
 
-    /* Register "fault status" related settings */
-    if ((entity_fault = std_config_attr_get(node, "fault")) != NULL) {
-        ((sdi_entity_priv_hdl_t)entity_hdl)->status.is_supported = true;
-        sdi_entity_fault_register((sdi_entity_priv_hdl_t)entity_hdl, settings_node, entity_fault);
-    } else {
-        ((sdi_entity_priv_hdl_t)entity_hdl)->status.is_supported = false;
-    }
+        sdi_resource_settings_replace(res_hdl, reference, settings_node);
+        res_hdl->cold->digest = digest;
 
-    /* Register power related settings for PSU */
-    if (((sdi_entity_priv_hdl_t)entity_hdl)->type == SDI_ENTITY_PSU_TRAY) {
-        ((sdi_entity_priv_hdl_t)entity_hdl)->power.is_supported = true;
-        sdi_entity_power_register((sdi_entity_priv_hdl_t)entity_hdl, settings_node);
-    } else {
-        ((sdi_entity_priv_hdl_t)entity_hdl)->power.is_supported = false;
+        SDI_ERRMSG_LOG("Reload: settings of resource %s of entity %s replaced\n", name, alias);
+        report->resources_changed++;
     }
 
-    /* Register "power control" related settings */
-    if ((entity_power_ctl = std_config_attr_get(node, "power_ctl")) != NULL) {
-        sdi_entity_pwrctl_register((sdi_entity_priv_hdl_t)entity_hdl, settings_node, entity_power_ctl);
-    } else {
-        *(((sdi_entity_priv_hdl_t)entity_hdl)->power_ctl.reset) = "\0";
-        *(((sdi_entity_priv_hdl_t)entity_hdl)->power_ctl.powerhdl) = "\0";
-        *(((sdi_entity_priv_hdl_t)entity_hdl)->power_ctl.power_on) = "\0";
-        *(((sdi_entity_priv_hdl_t)entity_hdl)->power_ctl.power_off) = "\0";
+    if (matched < hdl->resource_total) {
+        SDI_ERRMSG_LOG("Reload: %u resources removed from entity %s, restart to apply\n",
+                       hdl->resource_total - matched, alias);
+        report->not_applied += hdl->resource_total - matched;
     }
 
-    sdi_entity_register_resources(node, settings_node, entity_hdl);
-    sdi_add_entity(entity_hdl);
+    return true;
 }
 
 /**
- * Initializes internal data structures for the entity and creates entity-db.
+ * Applies the edited entity.xml and device.xml to the registered entities.
  *
- * entity_cfg_file[in] - Entity config file which has information about the devices on
- * each entity.
+ * report[out] - changes found.
  *
- * return None.
+ * return STD_ERR_OK on success, standard error if the configs can't be parsed or
+ * registered, in which case nothing is applied.
  */
-void sdi_register_entities(const char * entity_cfg_file)
+t_std_error sdi_config_reload(sdi_config_reload_report_t *report)
 {
-    std_config_hdl_t  cfg_hdl = NULL;
-    std_config_node_t root = NULL;
-    std_config_node_t entity = NULL;
-    std_config_hdl_t  settings_hdl = NULL;
-    std_config_node_t settings_node = NULL;
+    sdi_config_roots_t roots;
+    std_config_node_t  entity = NULL;
+    uint_t             registered = 0;
+    uint_t             kept = 0;
+    uint_t             type = 0;
+    t_std_error        rc = STD_ERR_OK;
 
-    STD_ASSERT(entity_cfg_file != NULL);
+    STD_ASSERT(report != NULL);
 
-    cfg_hdl = std_config_load(entity_cfg_file);
-    root = std_config_get_root(cfg_hdl);
+    memset(report, 0, sizeof(*report));
 
-    STD_ASSERT(root != NULL);
+    pthread_mutex_lock(&sdi_config_reload_state.lock);
 
-    /* Load "settings" config file and find config node for the entity */
-    settings_hdl = std_config_load(SDI_DEVICE_CONFIG_FILE);
-    settings_node = std_config_get_root(settings_hdl);
-    STD_ASSERT(settings_node != NULL);
+    if (sdi_config_reload_state.entity_file[0] == '\0') {
+        pthread_mutex_unlock(&sdi_config_reload_state.lock);
+        return SDI_ERRCODE(EAGAIN); /* Resource temporarily unavailable */
+    }
+
+    /* The compiled-in tables never change, the files are what was edited */
+    sdi_config_roots_open(sdi_config_reload_state.entity_file, false, &roots);
 
-    std_dll_init(&entity_list);
+    if ((roots.entities == NULL) || (roots.settings == NULL)) {
+        SDI_ERRMSG_LOG("Reload: failed to parse %s or %s\n", sdi_config_reload_state.entity_file,
+                       SDI_DEVICE_CONFIG_FILE);
+        rc = SDI_ERRCODE(ENOENT);
+    } else {
+        sdi_settings_index_build(roots.settings);
+
+        /* All or nothing, a half applied config would be worse than the old one */
+        for (entity = sdi_config_get_child(roots.entities); entity != NULL; entity = sdi_config_next_node(entity)) {
+            if (!sdi_config_entity_check(entity, roots.settings)) {
+                rc = SDI_ERRCODE(EINVAL);
+                break;
+            }
+        }
 
-    for (entity = std_config_get_child(root); (entity != NULL); entity = std_config_next_node(entity)) {
-        SDI_TRACEMSG_LOG("Found entity: %s\n", std_config_name_get(entity));
+        if (rc == STD_ERR_OK) {
+            for (type = 0; type < SDI_ENTITY_TYPES; type++) {
+                registered += sdi_entity_count_get((sdi_entity_type_t)type);
+            }
+
+            for (entity = sdi_config_get_child(roots.entities); entity != NULL; entity = sdi_config_next_node(entity)) {
+                if (sdi_entity_reload(entity, roots.settings, report)) {
+                    kept++;
+                }
+            }
+
+            if (kept < registered) {
+                SDI_ERRMSG_LOG("Reload: %u entities removed, restart to apply\n", registered - kept);
+                report->not_applied += registered - kept;
+            }
+        }
 
-        sdi_register_entity(entity, settings_node);
+        sdi_settings_index_free();
     }
 
-    std_config_unload(cfg_hdl);
-    std_config_unload(settings_hdl);
+    sdi_config_roots_close(&roots);
+
+    pthread_mutex_unlock(&sdi_config_reload_state.lock);
+
+    return rc;
 }
 
 /**
@@ -622,12 +1554,72 @@ void sdi_register_entities(const char * entity_cfg_file)
  */
 void sdi_entity_for_each(void (*fn)(sdi_entity_hdl_t hdl, void *user_data), void *user_data)
 {
-    sdi_entity_node_t *hdl = NULL;
+    sdi_entity_db_t *db = NULL;
+    uint_t           count = 0;
+
+    sdi_epoch_enter();
+
+    db = sdi_entity_db_get();
+
+    /* The last added first, as the entity list was built by prepending */
+    for (count = db->all_count; count > 0; count--) {
+        (*fn)(db->all[count - 1], user_data);
+    }
+
+    sdi_epoch_exit();
+}
+
+/**
+ * Calls the function of the parallel iteration over entities for one of them.
+ *
+ * index[in] - position of the entity in the iteration order.
+ * data[in] - iteration.
+ *
+ * return result of the function.
+ */
+static t_std_error sdi_entity_parallel_call(uint_t index, void *data)
+{
+    sdi_entity_parallel_t *iter = (sdi_entity_parallel_t*)data;
+
+    /* Same order as sdi_entity_for_each(), the last added first */
+    return (*iter->fn)(iter->slots[iter->count - 1 - index], iter->user_data);
+}
+
+/**
+ * Runs the function on every entity, on up to concurrency threads at once.
+ *
+ * fn[in] - function that would be called for each entity.
+ * user_data[in] - user data that will be passed to the function.
+ * concurrency[in] - maximal number of concurrent calls, 0 for the default.
+ *
+ * return STD_ERR_OK if all the calls succeeded, otherwise the error of the first
+ * failed entity in the order of sdi_entity_for_each().
+ */
+t_std_error sdi_entity_for_each_parallel(sdi_entity_parallel_fn_t fn, void *user_data, uint_t concurrency)
+{
+    sdi_entity_db_t       *db = NULL;
+    sdi_entity_parallel_t  iter;
+    t_std_error            rc = STD_ERR_OK;
+
+    STD_ASSERT(fn != NULL);
+
+    /* The workers use the snapshot on behalf of the caller, which waits for them */
+    sdi_epoch_enter();
 
-    for (hdl = sdi_entity_find_first(); (hdl != NULL);
-         hdl = sdi_entity_find_next(hdl)) {
-        (*fn)(hdl->entity_hdl, user_data);
+    db = sdi_entity_db_get();
+
+    iter.slots = db->all;
+    iter.count = db->all_count;
+    iter.fn = fn;
+    iter.user_data = user_data;
+
+    if (iter.count > 0) {
+        rc = sdi_executor_run(iter.count, concurrency, sdi_entity_parallel_call, &iter);
     }
+
+    sdi_epoch_exit();
+
+    return rc;
 }
 
 /**
@@ -639,7 +1631,7 @@ void sdi_entity_for_each(void (*fn)(sdi_entity_hdl_t hdl, void *user_data), void
  */
 const char * sdi_entity_name_get(sdi_entity_hdl_t hdl)
 {
-    return ((sdi_entity_priv_hdl_t)hdl)->name;
+    return ((sdi_entity_priv_hdl_t)hdl)->cold->name;
 }
 
 /**
@@ -663,20 +1655,17 @@ sdi_entity_type_t sdi_entity_type_get(sdi_entity_hdl_t hdl)
  */
 uint_t sdi_entity_count_get(sdi_entity_type_t etype)
 {
-    uint_t                entity_count = 0;
-    sdi_entity_node_t    *node = NULL;
-    sdi_entity_priv_hdl_t entity_hdl = NULL;
+    uint_t count = 0;
 
-    for (node = sdi_entity_find_first(); (node != NULL);
-         node = sdi_entity_find_next(node)) {
-        entity_hdl = (sdi_entity_priv_hdl_t)node->entity_hdl;
-
-        if (entity_hdl->type == etype) {
-            entity_count++;
-        }
+    if ((uint_t)etype >= SDI_ENTITY_TYPES) {
+        return 0;
     }
 
-    return entity_count;
+    sdi_epoch_enter();
+    count = sdi_entity_db_get()->count[etype];
+    sdi_epoch_exit();
+
+    return count;
 }
 
 /**
@@ -689,19 +1678,48 @@ uint_t sdi_entity_count_get(sdi_entity_type_t etype)
  */
 sdi_entity_hdl_t sdi_entity_lookup(sdi_entity_type_t etype, uint_t instance)
 {
-    sdi_entity_node_t    *hdl = NULL;
-    sdi_entity_priv_hdl_t entity_hdl = NULL;
+    sdi_entity_db_t  *db = NULL;
+    sdi_entity_hdl_t  hdl = NULL;
 
-    for (hdl = sdi_entity_find_first(); (hdl != NULL);
-         hdl = sdi_entity_find_next(hdl)) {
-        entity_hdl = (sdi_entity_priv_hdl_t)hdl->entity_hdl;
+    if ((uint_t)etype >= SDI_ENTITY_TYPES) {
+        return NULL;
+    }
 
-        if ((entity_hdl->type == etype) && (entity_hdl->instance == instance)) {
-            return hdl->entity_hdl;
-        }
+    sdi_epoch_enter();
+
+    db = sdi_entity_db_get();
+    if (instance < db->size[etype]) {
+        hdl = db->tables[etype][instance];
     }
 
-    return NULL;
+    sdi_epoch_exit();
+
+    return hdl;
+}
+
+/**
+ * Retrieves the handle of the entity by its name (alias).
+ *
+ * name[in] - name of the entity, e.g. "PSU1".
+ *
+ * return the handle to the entity, NULL if entity is not found.
+ */
+sdi_entity_hdl_t sdi_entity_lookup_by_name(const char *name)
+{
+    sdi_entity_node_t *node = NULL;
+
+    STD_ASSERT(name != NULL);
+
+    sdi_epoch_enter();
+
+    node = sdi_entity_db_get()->by_name[sdi_entity_name_bucket(name)];
+    while ((node != NULL) && (strcmp(((sdi_entity_priv_hdl_t)node->entity_hdl)->cold->name, name) != 0)) {
+        node = node->name_next;
+    }
+
+    sdi_epoch_exit();
+
+    return (node != NULL) ? node->entity_hdl : NULL;
 }
 
 /**
@@ -714,34 +1732,23 @@ sdi_entity_hdl_t sdi_entity_lookup(sdi_entity_type_t etype, uint_t instance)
  */
 uint_t sdi_entity_resource_count_get(sdi_entity_hdl_t hdl, sdi_resource_type_t resource_type)
 {
-    uint_t                      resource_count = 0;
-    sdi_entity_resource_node_t *node = NULL;
-    sdi_entity_priv_hdl_t       entity_hdl = NULL;
-    sdi_resource_priv_hdl_t     resource_hdl = NULL;
-    std_dll_head               *resource_head = NULL;
+    sdi_entity_priv_hdl_t entity_hdl = (sdi_entity_priv_hdl_t)hdl;
 
     STD_ASSERT(hdl != NULL);
 
-    entity_hdl = (sdi_entity_priv_hdl_t)hdl;
-    resource_head = (std_dll_head*)entity_hdl->resource_list;
-    STD_ASSERT(resource_head != NULL);
-
-    for ((node = (sdi_entity_resource_node_t*)std_dll_getfirst(resource_head));
-         (node != NULL);
-         (node = (sdi_entity_resource_node_t*)std_dll_getnext(resource_head, (std_dll*)node))) {
-        resource_hdl = (sdi_resource_priv_hdl_t)node->hdl;
-
-        if (resource_hdl->type == resource_type) {
-            resource_count++;
-        }
+    if ((uint_t)resource_type >= SDI_RESOURCE_TYPES) {
+        return 0;
     }
 
-    return resource_count;
+    return entity_hdl->resource_count[resource_type];
 }
 
 /**
  * Retrieves the handle of the resource whose name is known.
  *
+ * The alias must match exactly. If several resources of the type share the alias,
+ * the first one added is returned.
+ *
  * hdl[in] - handle to the entity whose information has to be retrieved.
  * resource[in] - The type of resource that needs to be looked up.
  * alias[in] - the name of the alias. example, "BOOT_STATUS" led.
@@ -750,23 +1757,17 @@ uint_t sdi_entity_resource_count_get(sdi_entity_hdl_t hdl, sdi_resource_type_t r
  */
 sdi_resource_hdl_t sdi_entity_resource_lookup(sdi_entity_hdl_t hdl, sdi_resource_type_t resource, const char *alias)
 {
-    sdi_entity_resource_node_t *node = NULL;
-    sdi_entity_priv_hdl_t       entity_hdl = NULL;
-    sdi_resource_priv_hdl_t     resource_hdl = NULL;
-    std_dll_head               *resource_head = NULL;
+    sdi_entity_priv_hdl_t   entity_hdl = (sdi_entity_priv_hdl_t)hdl;
+    sdi_resource_priv_hdl_t resource_hdl = NULL;
 
     STD_ASSERT(hdl != NULL);
+    STD_ASSERT(alias != NULL);
 
-    entity_hdl = (sdi_entity_priv_hdl_t)hdl;
-    resource_head = (std_dll_head*)entity_hdl->resource_list;
-    STD_ASSERT(resource_head != NULL);
-
-    for ((node = (sdi_entity_resource_node_t*)std_dll_getfirst(resource_head));
-         (node != NULL);
-         (node = (sdi_entity_resource_node_t*)std_dll_getnext(resource_head, (std_dll*)node))) {
-        resource_hdl = (sdi_resource_priv_hdl_t)node->hdl;
-        if (strncmp(resource_hdl->alias, alias, strlen(alias)) == 0) {
-            return node->hdl;
+    for ((resource_hdl = entity_hdl->cold->by_alias[sdi_entity_name_hash(alias) & (SDI_RESOURCE_ALIAS_BUCKETS - 1)]);
+         (resource_hdl != NULL);
+         (resource_hdl = resource_hdl->cold->alias_next)) {
+        if ((resource_hdl->type == resource) && (strcmp(resource_hdl->cold->alias, alias) == 0)) {
+            return (sdi_resource_hdl_t)resource_hdl;
         }
     }
 
@@ -782,7 +1783,7 @@ sdi_resource_hdl_t sdi_entity_resource_lookup(sdi_entity_hdl_t hdl, sdi_resource
  */
 const char * sdi_resource_alias_get(sdi_resource_hdl_t resource_hdl)
 {
-    return ((sdi_resource_priv_hdl_t)resource_hdl)->alias;
+    return ((sdi_resource_priv_hdl_t)resource_hdl)->cold->alias;
 }
 
 /**
@@ -797,17 +1798,82 @@ const char * sdi_resource_alias_get(sdi_resource_hdl_t resource_hdl)
 void sdi_entity_for_each_resource(sdi_entity_hdl_t hdl, void (*fn)(sdi_resource_hdl_t hdl,
                                                                    void *user_data), void *user_data)
 {
-    sdi_entity_resource_node_t *node;
-    sdi_entity_priv_hdl_t       entity_hdl = (sdi_entity_priv_hdl_t)hdl;
-    std_dll_head               *resource_head = (std_dll_head*)entity_hdl->resource_list;
+    sdi_entity_priv_hdl_t entity_hdl = (sdi_entity_priv_hdl_t)hdl;
+    uint_t                i = 0;
+
+    STD_ASSERT(fn != NULL);
+
+    for (i = 0; i < entity_hdl->resource_total; i++) {
+        (*fn)(entity_hdl->resource_list[i], user_data);
+    }
+}
+
+/**
+ * Calls the function of the parallel iteration over resources for one of them.
+ *
+ * index[in] - index of the resource in the resource list of the entity.
+ * data[in] - iteration.
+ *
+ * return result of the function.
+ */
+static t_std_error sdi_entity_resource_parallel_call(uint_t index, void *data)
+{
+    sdi_resource_parallel_t *iter = (sdi_resource_parallel_t*)data;
+
+    return (*iter->fn)(iter->resources[index], iter->user_data);
+}
+
+/**
+ * Runs the function on each resource of the entity, on up to concurrency threads at once.
+ *
+ * hdl[in] - Entity handle.
+ * fn[in] - function that would be called for each resource.
+ * user_data[in] - user data that will be passed to the function.
+ * concurrency[in] - maximal number of concurrent calls, 0 for the default.
+ *
+ * return STD_ERR_OK if all the calls succeeded, otherwise the error of the first
+ * failed resource in the order of sdi_entity_for_each_resource().
+ */
+t_std_error sdi_entity_for_each_resource_parallel(sdi_entity_hdl_t hdl, sdi_resource_parallel_fn_t fn,
+                                                  void *user_data, uint_t concurrency)
+{
+    sdi_entity_priv_hdl_t   entity_hdl = (sdi_entity_priv_hdl_t)hdl;
+    sdi_resource_parallel_t iter;
 
+    STD_ASSERT(hdl != NULL);
     STD_ASSERT(fn != NULL);
 
-    for ((node = (sdi_entity_resource_node_t*)std_dll_getfirst(resource_head));
-         (node);
-         (node = (sdi_entity_resource_node_t*)std_dll_getnext(resource_head, (std_dll*)node))) {
-        (*fn)(node->hdl, user_data);
+    iter.resources = entity_hdl->resource_list;
+    iter.fn = fn;
+    iter.user_data = user_data;
+
+    return sdi_executor_run(entity_hdl->resource_total, concurrency, sdi_entity_resource_parallel_call, &iter);
+}
+
+/**
+ * Forgets the last values written to the entity and its resources.
+ *
+ * Called when the entity is re-inserted, since the new hardware doesn't have them.
+ *
+ * hdl[in] - handle of the entity.
+ *
+ * return None.
+ */
+void sdi_entity_shadow_invalidate(sdi_entity_priv_hdl_t hdl)
+{
+    uint_t i = 0;
+
+    STD_ASSERT(hdl != NULL);
+
+    for (i = 0; i < hdl->resource_count[SDI_RESOURCE_FAN]; i++) {
+        sdi_fan_shadow_invalidate((sdi_resource_priv_hdl_t)hdl->resources[SDI_RESOURCE_FAN][i]);
+    }
+
+    for (i = 0; i < hdl->resource_count[SDI_RESOURCE_LED]; i++) {
+        sdi_led_shadow_invalidate((sdi_resource_priv_hdl_t)hdl->resources[SDI_RESOURCE_LED][i]);
     }
+
+    sdi_sysfs_hdl_shadow_invalidate(hdl->cold->power_ctl.powerhdl);
 }
 
 /**
@@ -833,7 +1899,7 @@ t_std_error sdi_entity_init(sdi_entity_hdl_t hdl)
 
     if (rc != STD_ERR_OK) {
         SDI_ERRMSG_LOG("Entity (%s): Init failed (rc=%d).\n",
-                       ((sdi_entity_priv_hdl_t)hdl)->name, rc);
+                       ((sdi_entity_priv_hdl_t)hdl)->cold->name, rc);
     }
 
     return rc;
@@ -851,14 +1917,12 @@ sdi_resource_type_t sdi_resource_type_get(sdi_resource_hdl_t hdl)
     return ((sdi_resource_priv_hdl_t)hdl)->type;
 }
 
-/**
- * @TODO: Below two functions are added as a interim solution for PAS
- * compilation.These functions will be removed once the PAS team clean-up
- * their code.
- */
-
 /**
  * Retrieve the handle of first resource of the specified type within the entity.
+ *
+ * Resources of each type are kept in an array, so the iteration doesn't visit the
+ * resources of other types.
+ *
  * hdl[in] -  handle to the entity whose information has to be retrieved.
  * resource[in] - The type of resource that needs to be looked up.
  * return - if a resource maching the criteria is found, returns handle to it.
@@ -866,16 +1930,90 @@ sdi_resource_type_t sdi_resource_type_get(sdi_resource_hdl_t hdl)
  */
 sdi_resource_hdl_t sdi_entity_get_first_resource(sdi_entity_hdl_t hdl, sdi_resource_type_t resource)
 {
-    return NULL;
+    sdi_entity_priv_hdl_t entity_hdl = (sdi_entity_priv_hdl_t)hdl;
+
+    STD_ASSERT(hdl != NULL);
+
+    if (((uint_t)resource >= SDI_RESOURCE_TYPES) || (entity_hdl->resource_count[resource] == 0)) {
+        return NULL;
+    }
+
+    return entity_hdl->resources[resource][0];
 }
+
 /**
  * Retrieve the handle of next resource of the specified type within the entity.
- * hdl[in] - handle to the entity whose information has to be retrieved.
+ *
+ * The next resource follows hdl in the resource list of its entity. hdl may be of
+ * another type, then the resources of the specified type are searched for the first
+ * one added after it.
+ *
+ * hdl[in] - handle to the resource after which the next one is looked up.
  * resource[in] - The type of resource that needs to be looked up.
  * return - if a resource maching the criteria is found, returns handle to it.
  *          else returns NULL.
  */
 sdi_resource_hdl_t sdi_entity_get_next_resource(sdi_resource_hdl_t hdl, sdi_resource_type_t resource)
 {
-    return NULL;
+    sdi_resource_priv_hdl_t resource_hdl = (sdi_resource_priv_hdl_t)hdl;
+    sdi_entity_priv_hdl_t   entity_hdl = NULL;
+    sdi_resource_hdl_t     *resources = NULL;
+    uint_t                  low = 0;
+    uint_t                  high = 0;
+    uint_t                  mid = 0;
+
+    STD_ASSERT(hdl != NULL);
+
+    entity_hdl = resource_hdl->entity;
+    if ((entity_hdl == NULL) || ((uint_t)resource >= SDI_RESOURCE_TYPES)) {
+        return NULL;
+    }
+
+    resources = entity_hdl->resources[resource];
+    high = entity_hdl->resource_count[resource];
+
+    if (resource_hdl->type == resource) {
+        low = resource_hdl->index + 1;
+    } else {
+        /* Binary search for the first resource added after hdl */
+        while (low < high) {
+            mid = low + ((high - low) / 2);
+            if (((sdi_resource_priv_hdl_t)resources[mid])->seq < resource_hdl->seq) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        high = entity_hdl->resource_count[resource];
+    }
+
+    return (low < high) ? resources[low] : NULL;
+}
+
+/**
+ * Waits until the writes queued for the resource so far are completed.
+ *
+ * param[in] resource_hdl - resource handle.
+ *
+ * return result of the last write to the resource, STD_ERR_OK if it has no queued writes.
+ */
+t_std_error sdi_resource_write_flush(sdi_resource_hdl_t resource_hdl)
+{
+    sdi_resource_priv_hdl_t hdl = (sdi_resource_priv_hdl_t)resource_hdl;
+    t_std_error             rc = STD_ERR_OK;
+
+    STD_ASSERT(hdl != NULL);
+
+    switch (hdl->type) {
+    case SDI_RESOURCE_FAN:
+        rc = sdi_fan_write_flush(hdl);
+        break;
+    case SDI_RESOURCE_LED:
+        rc = sdi_led_write_flush(hdl);
+        break;
+    default:
+        break;
+    }
+
+    return rc;
 }
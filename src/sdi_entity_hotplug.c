@@ -0,0 +1,444 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/**************************************************************************************
+ * Entity hotplug detection based on kernel kobject uevents.
+ *
+ * Every watched attribute of the entity is mapped to the device it belongs to. A uevent
+ * for that device (or its parent or child) drops the cached attribute values, re-reads
+ * the presence and notifies the registered callbacks.
+ ***************************************************************************************/
+
+#include "sdi_entity.h"
+#include "sdi_common.h"
+#include "sdi_sys_ext.h"
+#include "sdi_sysfs_utils.h"
+#include "sdi_sysfs_watch.h"
+#include "sdi_uevent.h"
+#include <limits.h>
+#include <pthread.h>
+
+#define SDI_HOTPLUG_ATTRS_MAX 3      /**< presence, fault status and power status */
+#define SDI_HOTPLUG_SYSFS_ROOT "/sys" /**< uevent device paths are relative to it */
+
+/**
+ * @struct sdi_hotplug_attr_t
+ * Used to hold the watched attribute of the entity and its device.
+ */
+typedef struct sdi_hotplug_attr_s {
+    sdi_sysfs_watch_hdl_t watch;   /**< watched attribute */
+    char                 *devpath; /**< path of the attribute's device relative to /sys */
+} sdi_hotplug_attr_t;
+
+/**
+ * @struct sdi_hotplug_entity_t
+ * Used to hold the hotplug state of the entity.
+ */
+typedef struct sdi_hotplug_entity_s {
+    std_dll               node;    /**< node in the entity list, must be the first member */
+    sdi_entity_priv_hdl_t entity;  /**< handle of the entity */
+    bool                  present; /**< last known presence of the entity */
+    uint_t                count;   /**< number of watched attributes */
+    sdi_hotplug_attr_t    attrs[SDI_HOTPLUG_ATTRS_MAX]; /**< watched attributes */
+} sdi_hotplug_entity_t;
+
+/**
+ * @struct sdi_hotplug_cb_node_t
+ * Used to hold registered hotplug callback.
+ */
+typedef struct sdi_hotplug_cb_node_s {
+    std_dll                 node; /**< node in the callback list, must be the first member */
+    sdi_entity_hotplug_cb_t cb;   /**< callback */
+    void                   *data; /**< user data of the callback */
+} sdi_hotplug_cb_node_t;
+
+/**
+ * @struct sdi_hotplug_t
+ * Used to hold the hotplug state.
+ */
+typedef struct sdi_hotplug_s {
+    pthread_mutex_t lock;        /**< protects the lists */
+    bool            init_done;   /**< whether the lists were initialized */
+    bool            started;     /**< whether the entity list was built */
+    std_dll_head    entities;    /**< list of sdi_hotplug_entity_t */
+    std_dll_head    callbacks;   /**< list of sdi_hotplug_cb_node_t */
+} sdi_hotplug_t;
+
+static sdi_hotplug_t sdi_hotplug = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+/**
+ * Resolves the device path of SysFs attribute.
+ *
+ * Configured paths may go through symlinks, so they are resolved to /sys/devices.
+ * If the device is absent, its closest existing parent is used.
+ *
+ * path[in] - full path of SysFs attribute.
+ *
+ * return device path relative to /sys, NULL if it can't be resolved.
+ */
+static char * sdi_hotplug_devpath_get(const char *path)
+{
+    char   dir[PATH_MAX] = {0};
+    char   resolved[PATH_MAX] = {0};
+    char   sysfs[PATH_MAX] = {0};
+    char  *slash = NULL;
+    size_t len = 0;
+
+    /* SysFs itself may be relocated, e.g. to a simulated tree */
+    snprintf(dir, sizeof(dir), "%s" SDI_HOTPLUG_SYSFS_ROOT, sdi_sysfs_root_get());
+    if (realpath(dir, sysfs) == NULL) {
+        return NULL;
+    }
+    len = strlen(sysfs);
+
+    strncpy(dir, path, sizeof(dir) - 1);
+
+    while ((slash = strrchr(dir, '/')) != NULL) {
+        *slash = '\0';
+
+        if (realpath(dir, resolved) != NULL) {
+            if ((strncmp(resolved, sysfs, len) != 0) || (resolved[len] != '/')) {
+                return NULL;
+            }
+
+            return strdup(resolved + len);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Checks whether device path is equal to or is a parent of another one.
+ *
+ * parent[in] - possible parent device path.
+ * child[in] - possible child device path.
+ *
+ * return true if child is parent or is below it.
+ */
+static bool sdi_hotplug_devpath_contains(const char *parent, const char *child)
+{
+    size_t len = strlen(parent);
+
+    return (strncmp(parent, child, len) == 0) && ((child[len] == '\0') || (child[len] == '/'));
+}
+
+/**
+ * Adds the watched attribute to the hotplug entity.
+ *
+ * node[in] - hotplug entity.
+ * hdl[in] - handle of SysFs attribute.
+ * watch[in] - handle of the watched attribute.
+ *
+ * return None.
+ */
+static void sdi_hotplug_attr_add(sdi_hotplug_entity_t *node, sdi_sysfs_hdl_t hdl, sdi_sysfs_watch_hdl_t watch)
+{
+    char *devpath = NULL;
+
+    if ((hdl == NULL) || (watch == NULL)) {
+        return;
+    }
+
+    if ((devpath = sdi_hotplug_devpath_get(sdi_sysfs_hdl_path_get(hdl))) == NULL) {
+        SDI_ERRMSG_LOG("No device found for %s, hotplug is not detected\n", sdi_sysfs_hdl_path_get(hdl));
+        return;
+    }
+
+    STD_ASSERT(node->count < SDI_HOTPLUG_ATTRS_MAX);
+
+    node->attrs[node->count].watch = watch;
+    node->attrs[node->count].devpath = devpath;
+    node->count++;
+}
+
+/**
+ * Adds the entity to the hotplug entity list, unless it is already there.
+ *
+ * The presence is read before the lock is taken, so a wedged bus doesn't block the
+ * uevent handling and the other additions.
+ *
+ * entity_hdl[in] - handle of the entity.
+ * user_data[in] - unused.
+ *
+ * return None.
+ */
+static void sdi_hotplug_entity_add(sdi_entity_hdl_t entity_hdl, void *user_data)
+{
+    sdi_entity_priv_hdl_t entity = (sdi_entity_priv_hdl_t)entity_hdl;
+    sdi_hotplug_entity_t *node = NULL;
+    sdi_hotplug_entity_t *cur = NULL;
+    uint_t                i = 0;
+
+    node = (sdi_hotplug_entity_t*)calloc(1, sizeof(sdi_hotplug_entity_t));
+    STD_ASSERT(node != NULL);
+
+    node->entity = entity;
+
+    if (entity->presence.type != SDI_ENTITY_FIXED) {
+        sdi_hotplug_attr_add(node, entity->presence.attr, entity->presence.watch);
+    }
+    if (entity->status.is_supported == true) {
+        sdi_hotplug_attr_add(node, entity->status.attr, entity->status.watch);
+    }
+    if (entity->power.is_supported == true) {
+        sdi_hotplug_attr_add(node, entity->power.status_attr, entity->power.status_watch);
+    }
+
+    if (node->count == 0) {
+        free(node);
+        return;
+    }
+
+    sdi_entity_presence_get(entity_hdl, &node->present);
+
+    pthread_mutex_lock(&sdi_hotplug.lock);
+
+    /* The start may enumerate an entity, which is being tracked at the same time */
+    for (cur = (sdi_hotplug_entity_t*)std_dll_getfirst(&sdi_hotplug.entities); (cur != NULL);
+         cur = (sdi_hotplug_entity_t*)std_dll_getnext(&sdi_hotplug.entities, (std_dll*)cur)) {
+        if (cur->entity == entity) {
+            break;
+        }
+    }
+
+    if (cur == NULL) {
+        std_dll_insertatback(&sdi_hotplug.entities, (std_dll*)node);
+        node = NULL;
+    }
+
+    pthread_mutex_unlock(&sdi_hotplug.lock);
+
+    if (node != NULL) {
+        for (i = 0; i < node->count; i++) {
+            free(node->attrs[i].devpath);
+        }
+        free(node);
+    }
+}
+
+/**
+ * Checks whether uevent of the device affects the entity.
+ *
+ * node[in] - hotplug entity.
+ * devpath[in] - path of the device from the uevent.
+ *
+ * return true if the device is the device of any entity attribute, its parent or child.
+ */
+static bool sdi_hotplug_entity_match(const sdi_hotplug_entity_t *node, const char *devpath)
+{
+    uint_t i = 0;
+
+    for (i = 0; i < node->count; i++) {
+        if (sdi_hotplug_devpath_contains(devpath, node->attrs[i].devpath) ||
+            sdi_hotplug_devpath_contains(node->attrs[i].devpath, devpath)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Handles uevent received by the listener.
+ *
+ * Only the affected entities and the callbacks are collected under the lock. The
+ * presence is read and the callbacks are called without it, so a wedged bus or a slow
+ * callback doesn't block the tracking of new entities. The hotplug entities and the
+ * callbacks are never freed, so they stay valid without the lock.
+ *
+ * event[in] - parsed uevent.
+ * data[in] - unused.
+ *
+ * return None.
+ */
+static void sdi_hotplug_uevent_handle(const sdi_uevent_t *event, void *data)
+{
+    sdi_hotplug_entity_t   *node = NULL;
+    sdi_hotplug_entity_t  **nodes = NULL;
+    sdi_hotplug_cb_node_t  *cb_node = NULL;
+    sdi_hotplug_cb_node_t **cb_nodes = NULL;
+    sdi_hotplug_event_t     hp_event = SDI_HOTPLUG_CHANGED;
+    bool                    present = false;
+    bool                    changed = false;
+    uint_t                  count = 0;
+    uint_t                  cb_count = 0;
+    uint_t                  n = 0;
+    uint_t                  i = 0;
+
+    SDI_TRACEMSG_LOG("uevent %d for %s\n", event->action, event->devpath);
+
+    pthread_mutex_lock(&sdi_hotplug.lock);
+
+    for (node = (sdi_hotplug_entity_t*)std_dll_getfirst(&sdi_hotplug.entities); (node != NULL);
+         node = (sdi_hotplug_entity_t*)std_dll_getnext(&sdi_hotplug.entities, (std_dll*)node)) {
+        if (sdi_hotplug_entity_match(node, event->devpath) == true) {
+            nodes = (sdi_hotplug_entity_t**)realloc(nodes, (count + 1) * sizeof(*nodes));
+            STD_ASSERT(nodes != NULL);
+            nodes[count++] = node;
+        }
+    }
+
+    if (count > 0) {
+        for (cb_node = (sdi_hotplug_cb_node_t*)std_dll_getfirst(&sdi_hotplug.callbacks); (cb_node != NULL);
+             cb_node = (sdi_hotplug_cb_node_t*)std_dll_getnext(&sdi_hotplug.callbacks, (std_dll*)cb_node)) {
+            cb_nodes = (sdi_hotplug_cb_node_t**)realloc(cb_nodes, (cb_count + 1) * sizeof(*cb_nodes));
+            STD_ASSERT(cb_nodes != NULL);
+            cb_nodes[cb_count++] = cb_node;
+        }
+    }
+
+    pthread_mutex_unlock(&sdi_hotplug.lock);
+
+    for (n = 0; n < count; n++) {
+        node = nodes[n];
+
+        for (i = 0; i < node->count; i++) {
+            sdi_sysfs_watch_expire(node->attrs[i].watch);
+        }
+
+        /* Cached values are dropped, so this reads the presence attribute */
+        sdi_entity_presence_get((sdi_entity_hdl_t)node->entity, &present);
+
+        pthread_mutex_lock(&sdi_hotplug.lock);
+        if ((changed = (present != node->present)) == true) {
+            node->present = present;
+        }
+        pthread_mutex_unlock(&sdi_hotplug.lock);
+
+        if (changed == true) {
+            hp_event = present ? SDI_HOTPLUG_INSERTED : SDI_HOTPLUG_REMOVED;
+        } else if (event->action == SDI_UEVENT_CHANGE) {
+            hp_event = SDI_HOTPLUG_CHANGED;
+        } else {
+            /* Related device came or went, but the entity itself didn't */
+            continue;
+        }
+
+        for (i = 0; i < cb_count; i++) {
+            cb_nodes[i]->cb((sdi_entity_hdl_t)node->entity, hp_event, cb_nodes[i]->data);
+        }
+    }
+
+    free(cb_nodes);
+    free(nodes);
+}
+
+/**
+ * Initializes the hotplug lists.
+ *
+ * Must be called with the lock held.
+ *
+ * return None.
+ */
+static void sdi_hotplug_init(void)
+{
+    if (sdi_hotplug.init_done == false) {
+        std_dll_init(&sdi_hotplug.entities);
+        std_dll_init(&sdi_hotplug.callbacks);
+        sdi_hotplug.init_done = true;
+    }
+}
+
+/**
+ * Registers callback for the entity hotplug events.
+ *
+ * cb[in] - callback.
+ * data[in] - user data passed to the callback.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_entity_hotplug_cb_register(sdi_entity_hotplug_cb_t cb, void *data)
+{
+    sdi_hotplug_cb_node_t *cb_node = NULL;
+
+    if (cb == NULL) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    cb_node = (sdi_hotplug_cb_node_t*)calloc(1, sizeof(sdi_hotplug_cb_node_t));
+    STD_ASSERT(cb_node != NULL);
+
+    cb_node->cb = cb;
+    cb_node->data = data;
+
+    pthread_mutex_lock(&sdi_hotplug.lock);
+    sdi_hotplug_init();
+    std_dll_insertatback(&sdi_hotplug.callbacks, (std_dll*)cb_node);
+    pthread_mutex_unlock(&sdi_hotplug.lock);
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Starts listening to the kernel uevents for entity hotplug.
+ *
+ * fd[in] - descriptor delivering uevent messages, -1 to open the kernel uevent
+ *          netlink socket.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_entity_hotplug_start(int fd)
+{
+    t_std_error rc = STD_ERR_OK;
+    bool        first = false;
+
+    pthread_mutex_lock(&sdi_hotplug.lock);
+
+    sdi_hotplug_init();
+    first = (sdi_hotplug.started == false);
+    sdi_hotplug.started = true;
+
+    pthread_mutex_unlock(&sdi_hotplug.lock);
+
+    /* Entities registered meanwhile are tracked by sdi_entity_hotplug_track() */
+    if (first == true) {
+        sdi_entity_for_each(&sdi_hotplug_entity_add, NULL);
+    }
+
+    if ((fd < 0) && ((fd = sdi_uevent_socket_open()) == -1)) {
+        rc = SDI_ERRNO;
+        SDI_ERRMSG_LOG("Failed to open uevent socket (rc=%d)\n", rc);
+        return rc;
+    }
+
+    return sdi_uevent_listener_start(fd, &sdi_hotplug_uevent_handle, NULL);
+}
+
+/**
+ * Adds the entity registered at runtime to the hotplug entity list.
+ *
+ * entity_hdl[in] - handle of the entity.
+ *
+ * return None.
+ */
+void sdi_entity_hotplug_track(sdi_entity_hdl_t entity_hdl)
+{
+    bool started = false;
+
+    STD_ASSERT(entity_hdl != NULL);
+
+    pthread_mutex_lock(&sdi_hotplug.lock);
+    started = sdi_hotplug.started;
+    pthread_mutex_unlock(&sdi_hotplug.lock);
+
+    if (started == true) {
+        sdi_hotplug_entity_add(entity_hdl, NULL);
+    }
+}
+
+/**
+ * Stops listening to the kernel uevents.
+ *
+ * return None.
+ */
+void sdi_entity_hotplug_stop(void)
+{
+    sdi_uevent_listener_stop();
+}
@@ -11,18 +11,20 @@
  ***************************************************************************************/
 
 #include "sdi_common.h"
+#include "sdi_config_snapshot.h"
 #include "sdi_entity_info.h"
 #include "sdi_eeprom_utils.h"
+#include "sdi_sysfs_utils.h"
 #include <string.h>
 
+#define SDI_INFO_EEPROM_BUF_SIZE 2048 /**< on-stack buffer, which fits the EEPROMs of most entities */
 
 /**
  * @struct sdi_info_settings_t
  * Used to hold info resource related settings.
  */
 typedef struct sdi_info_settings_s {
-    char                  path[PATH_MAX]; /**< path to the EEPROM SysFs attribute */
-    char                  name[SDI_MAX_NAME_LEN]; /**< name of the EEPROM SysFs attribute */
+    sdi_sysfs_hdl_t       attr;       /**< EEPROM SysFs attribute */
     sdi_eeprom_type_t     type;       /**< type of the EEPROM raw data */
     sdi_entity_priv_hdl_t entity_hdl; /**< handle of the entity, to which this info resource belongs */
 } sdi_info_settings_t;
@@ -40,24 +42,23 @@ void sdi_info_register_settings(sdi_resource_priv_hdl_t hdl,
                                 sdi_entity_priv_hdl_t   entity_hdl,
                                 std_config_node_t       info_node)
 {
-    char                *name = NULL;
-    char                *path = NULL;
-    char                *type = NULL;
+    const char          *name = NULL;
+    const char          *path = NULL;
+    const char          *type = NULL;
     sdi_info_settings_t *settings = NULL;
 
     STD_ASSERT(hdl != NULL);
     STD_ASSERT(entity_hdl != NULL);
     STD_ASSERT(info_node != NULL);
 
-    STD_ASSERT((name = std_config_attr_get(info_node, "name")) != NULL);
-    STD_ASSERT((path = std_config_attr_get(info_node, "path")) != NULL);
-    STD_ASSERT((type = std_config_attr_get(info_node, "type")) != NULL);
+    STD_ASSERT((name = sdi_config_attr_get(info_node, "name")) != NULL);
+    STD_ASSERT((path = sdi_config_attr_get(info_node, "path")) != NULL);
+    STD_ASSERT((type = sdi_config_attr_get(info_node, "type")) != NULL);
 
     settings = (sdi_info_settings_t*)calloc(1, sizeof(sdi_info_settings_t));
     STD_ASSERT(settings != NULL);
 
-    strncpy(settings->name, name, sizeof(settings->name));
-    strncpy(settings->path, path, sizeof(settings->path));
+    settings->attr = sdi_sysfs_hdl_create(path, name, SDI_SYSFS_ATTR_DATA, 0);
     settings->type = sdi_eeprom_string_to_type(type);
     settings->entity_hdl = entity_hdl;
 
@@ -162,7 +163,7 @@ static t_std_error sdi_psu_info_fill(sdi_entity_priv_hdl_t hdl, sdi_entity_info_
     sdi_entity_for_each_resource((sdi_entity_hdl_t)hdl, sdi_fan_max_speed, &fan_max_speed);
     info->max_speed = fan_max_speed;
 
-    rc = sdi_sysfs_attr_uint_get(hdl->power.rating_path, hdl->power.rating_name, &power_rating);
+    rc = sdi_sysfs_hdl_uint_get(hdl->power.rating_attr, &power_rating);
     if (rc == STD_ERR_OK) {
         info->power_rating = power_rating / volt_divider;
     }
@@ -180,33 +181,20 @@ static t_std_error sdi_psu_info_fill(sdi_entity_priv_hdl_t hdl, sdi_entity_info_
  */
 static t_std_error sdi_entity_info_get(sdi_info_settings_t *settings, sdi_entity_info_t *info)
 {
-    char       *buf = NULL;
-    size_t      buf_size = 0;
-    t_std_error rc = STD_ERR_OK;
+    char            eeprom[SDI_INFO_EEPROM_BUF_SIZE];
+    sdi_sysfs_buf_t buf = {.data = eeprom, .size = sizeof(eeprom)};
+    t_std_error     rc = STD_ERR_OK;
 
     if ((settings == NULL) || (info == NULL)) {
         return SDI_ERRCODE(EINVAL);
     }
 
-    /* Get the size of the EEPROM raw data */
-    rc = sdi_sysfs_attr_data_size_get(settings->path, settings->name, &buf_size);
-    if ((rc != STD_ERR_OK) || (buf_size == 0)) {
-        SDI_ERRMSG_LOG("%s:%d Cannot get size of EEPROM raw data (error:%d).",
-                       __FUNCTION__, __LINE__, rc);
-        return SDI_ERRCODE(-1);
-    }
-
-    buf = (char*)calloc(buf_size, sizeof(*buf));
-    if (buf == NULL) {
-        return SDI_ERRCODE(ENOMEM);
-    }
-
-    /* Read raw data from the EEPROM */
-    rc = sdi_sysfs_attr_data_get(settings->path, settings->name, buf_size, buf);
-    if (rc != STD_ERR_OK) {
-        free(buf);
+    /* Read raw data from the EEPROM, the buffer is moved to the heap if the data doesn't fit */
+    rc = sdi_sysfs_hdl_data_read(settings->attr, &buf);
+    if ((rc != STD_ERR_OK) || (buf.len == 0)) {
+        sdi_sysfs_buf_release(&buf);
         SDI_ERRMSG_LOG("%s:%d Cannot read EEPROM raw data (error:%d).", __FUNCTION__, __LINE__, rc);
-        return SDI_ERRCODE(rc);
+        return SDI_ERRCODE(-1);
     }
 
     memset(info, 0, sizeof(*info));
@@ -214,22 +202,22 @@ static t_std_error sdi_entity_info_get(sdi_info_settings_t *settings, sdi_entity
     /* Parse EEPROM raw data and fill in the entity info structure */
     switch (settings->type) {
     case SDI_EEPROM_SYS_ONIE:
-        rc = sdi_eeprom_sys_onie_get(buf, buf_size, info);
+        rc = sdi_eeprom_sys_onie_get(buf.data, buf.len, info);
         break;
 
     case SDI_EEPROM_FAN_MLNX:
-        rc = sdi_eeprom_fan_mlnx_get(buf, buf_size, info);
+        rc = sdi_eeprom_fan_mlnx_get(buf.data, buf.len, info);
         break;
 
     case SDI_EEPROM_PSU_MLNX:
-        rc = sdi_eeprom_psu_mlnx_get(buf, buf_size, info);
+        rc = sdi_eeprom_psu_mlnx_get(buf.data, buf.len, info);
         break;
 
     default:
         rc = SDI_ERRCODE(EOPNOTSUPP);
     }
 
-    free(buf);
+    sdi_sysfs_buf_release(&buf);
     return rc;
 }
 
@@ -293,14 +281,14 @@ static t_std_error sdi_entity_info_fill(sdi_info_settings_t *settings, sdi_entit
 t_std_error sdi_entity_info_read(sdi_resource_hdl_t resource_hdl, sdi_entity_info_t *entity_info)
 {
     sdi_resource_priv_hdl_t hdl = NULL;
-    sdi_info_settings_t    *settings = NULL;
+    sdi_info_settings_t     settings;
 
     STD_ASSERT((hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_info_settings_t*)hdl->settings) != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_ENTITY_INFO, &settings, sizeof(settings));
 
     if (hdl->type != SDI_RESOURCE_ENTITY_INFO) {
         return SDI_ERRCODE(EPERM);
     }
 
-    return sdi_entity_info_fill(settings, entity_info);
+    return sdi_entity_info_fill(&settings, entity_info);
 }
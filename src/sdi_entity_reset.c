@@ -11,6 +11,7 @@
 
 #include "sdi_entity.h"
 #include "sdi_common.h"
+#include "sdi_sysfs_utils.h"
 #include "std_assert.h"
 
 /**
@@ -30,12 +31,12 @@ t_std_error sdi_entity_reset(sdi_entity_hdl_t hdl, sdi_reset_type_t type)
 
     /* Check this entity supports reset for this type */
     /* Mlnx switches support only cold reset type */
-    if ((type != COLD_RESET) || (strlen(entity_priv_hdl->power_ctl.reset) <= 0)) {
+    if ((type != COLD_RESET) || (entity_priv_hdl->cold->power_ctl.reset == NULL)) {
         return SDI_ERRCODE(EOPNOTSUPP);
     }
 
     /* Perform the entity reset */
-    rc = sdi_sysfs_attr_uint_set(entity_priv_hdl->power_ctl.path, entity_priv_hdl->power_ctl.reset, 1);
+    rc = sdi_sysfs_hdl_uint_set(entity_priv_hdl->cold->power_ctl.reset, 1);
 
     return rc;
 }
@@ -49,23 +50,23 @@ t_std_error sdi_entity_reset(sdi_entity_hdl_t hdl, sdi_reset_type_t type)
  */
 t_std_error sdi_entity_power_status_control(sdi_entity_hdl_t hdl, bool enable)
 {
-    char                 *val = NULL;
+    const char           *val = NULL;
     t_std_error           rc = STD_ERR_OK;
     sdi_entity_priv_hdl_t entity_priv_hdl = NULL;
 
     STD_ASSERT((entity_priv_hdl = (sdi_entity_priv_hdl_t)hdl) != NULL);
 
     /* Check this entity supports power on/off operations */
-    if (strlen(entity_priv_hdl->power_ctl.powerhdl) <= 0) {
+    if (entity_priv_hdl->cold->power_ctl.powerhdl == NULL) {
         return SDI_ERRCODE(EOPNOTSUPP);
     }
 
     /* Get the power state value for platform */
-    val = enable ? entity_priv_hdl->power_ctl.power_on : entity_priv_hdl->power_ctl.power_off;
+    val = enable ? entity_priv_hdl->cold->power_ctl.power_on : entity_priv_hdl->cold->power_ctl.power_off;
     STD_ASSERT(strlen(val) > 0);
 
     /* Set the power state */
-    rc = sdi_sysfs_attr_str_set(entity_priv_hdl->power_ctl.path, entity_priv_hdl->power_ctl.powerhdl, val);
+    rc = sdi_sysfs_hdl_str_set(entity_priv_hdl->cold->power_ctl.powerhdl, val);
 
     return rc;
 }
@@ -12,7 +12,9 @@
 
 #include "sdi_fan.h"
 #include "sdi_common.h"
+#include "sdi_config_snapshot.h"
 #include "sdi_sysfs_utils.h"
+#include "sdi_string_pool.h"
 
 
 /**
@@ -20,11 +22,11 @@
  * Used to hold settings for the "fan speed" SysFs attribute.
  */
 typedef struct sdi_fan_speed_s {
-    char   set[SDI_MAX_NAME_LEN];   /**< name of the fan "set speed" SysFs attribute */
-    char   get[SDI_MAX_NAME_LEN];   /**< name of the fan "get speed" SysFs attribute */
-    char   max_get[SDI_MAX_NAME_LEN]; /**< name of the fan "get max speed" SysFs attribute */
-    uint_t max_pwm;                 /**< maximum speed value in PWM format */
-    uint_t max_rpm;                 /**< maximum speed value in RPM format */
+    sdi_sysfs_hdl_t set;     /**< fan "set speed" SysFs attribute, NULL if not supported */
+    sdi_sysfs_hdl_t get;     /**< fan "get speed" SysFs attribute, NULL if not supported */
+    sdi_sysfs_hdl_t max_get; /**< fan "get max speed" SysFs attribute, NULL if not supported */
+    uint_t          max_pwm; /**< maximum speed value in PWM format */
+    uint_t          max_rpm; /**< maximum speed value in RPM format */
 } sdi_fan_speed_t;
 
 /**
@@ -32,8 +34,8 @@ typedef struct sdi_fan_speed_s {
  * Used to hold settings for the fan "fault status" SysFs attribute.
  */
 typedef struct sdi_fan_status_s {
-    char get[SDI_MAX_NAME_LEN];   /**< name of the fan "fault status" SysFs attribute */
-    char fault[SDI_MAX_NAME_LEN]; /**< value of the "Fault" status */
+    sdi_sysfs_hdl_t get;   /**< fan "fault status" SysFs attribute, NULL if not supported */
+    const char     *fault; /**< value of the "Fault" status */
 } sdi_fan_status_t;
 
 /**
@@ -41,8 +43,6 @@ typedef struct sdi_fan_status_s {
  * Used to hold FAN related settings.
  */
 typedef struct sdi_fan_settings_s {
-    char             name[SDI_MAX_NAME_LEN]; /**< name of the fan SysFs attribute */
-    char             path[PATH_MAX]; /**< path to the fan SysFs attributes */
     sdi_fan_speed_t  speed;      /**< settings for the fan speed SysFs attributes */
     sdi_fan_status_t status;     /**< settings for the fan fault status SysFs attribute */
 } sdi_fan_settings_t;
@@ -57,53 +57,52 @@ typedef struct sdi_fan_settings_s {
  */
 void sdi_fan_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t fan_node)
 {
-    char               *name = NULL;
-    char               *path = NULL;
-    char               *type = NULL;
-    char               *attr = NULL;
+    const char         *name = NULL;
+    const char         *path = NULL;
+    const char         *attr = NULL;
     std_config_node_t   node = NULL;
     sdi_fan_settings_t *settings = NULL;
 
     STD_ASSERT(hdl != NULL);
     STD_ASSERT(fan_node != NULL);
 
-    STD_ASSERT((name = std_config_attr_get(fan_node, "name")) != NULL);
-    STD_ASSERT((path = std_config_attr_get(fan_node, "path")) != NULL);
+    STD_ASSERT((name = sdi_config_attr_get(fan_node, "name")) != NULL);
+    STD_ASSERT((path = sdi_config_attr_get(fan_node, "path")) != NULL);
 
     settings = (sdi_fan_settings_t*)calloc(1, sizeof(sdi_fan_settings_t));
     STD_ASSERT(settings != NULL);
 
-    strncpy(settings->name, name, sizeof(settings->name));
-    strncpy(settings->path, path, sizeof(settings->path));
+    settings->status.fault = sdi_string_intern("");
 
-    for (node = std_config_get_child(fan_node); (node != NULL); node = std_config_next_node(node)) {
-        if (strncmp(std_config_name_get(node), "speed", sizeof("speed")) == 0) {
-            if ((attr = std_config_attr_get(node, "set")) != NULL) {
-                strncpy(settings->speed.set, attr, sizeof(settings->speed.set));
+    for (node = sdi_config_get_child(fan_node); (node != NULL); node = sdi_config_next_node(node)) {
+        if (strncmp(sdi_config_name_get(node), "speed", sizeof("speed")) == 0) {
+            if ((attr = sdi_config_attr_get(node, "set")) != NULL) {
+                settings->speed.set = sdi_sysfs_hdl_create(path, attr, SDI_SYSFS_ATTR_UINT,
+                                                           SDI_SYSFS_HDL_F_SHADOW | SDI_SYSFS_HDL_F_ASYNC);
             }
 
-            if ((attr = std_config_attr_get(node, "get")) != NULL) {
-                strncpy(settings->speed.get, attr, sizeof(settings->speed.get));
+            if ((attr = sdi_config_attr_get(node, "get")) != NULL) {
+                settings->speed.get = sdi_sysfs_hdl_create(path, attr, SDI_SYSFS_ATTR_UINT, 0);
             }
 
-            if ((attr = std_config_attr_get(node, "max_get")) != NULL) {
-                strncpy(settings->speed.max_get, attr, sizeof(settings->speed.max_get));
+            if ((attr = sdi_config_attr_get(node, "max_get")) != NULL) {
+                settings->speed.max_get = sdi_sysfs_hdl_create(path, attr, SDI_SYSFS_ATTR_UINT, 0);
             }
 
-            if ((attr = std_config_attr_get(node, "max_pwm")) != NULL) {
+            if ((attr = sdi_config_attr_get(node, "max_pwm")) != NULL) {
                 settings->speed.max_pwm = atoi(attr);
             }
 
-            if ((attr = std_config_attr_get(node, "max_rpm")) != NULL) {
+            if ((attr = sdi_config_attr_get(node, "max_rpm")) != NULL) {
                 settings->speed.max_rpm = atoi(attr);
             }
-        } else if (strncmp(std_config_name_get(node), "status", sizeof("status")) == 0) {
-            if ((attr = std_config_attr_get(node, "get")) != NULL) {
-                strncpy(settings->status.get, attr, sizeof(settings->status.get));
+        } else if (strncmp(sdi_config_name_get(node), "status", sizeof("status")) == 0) {
+            if ((attr = sdi_config_attr_get(node, "get")) != NULL) {
+                settings->status.get = sdi_sysfs_hdl_create(path, attr, SDI_SYSFS_ATTR_STR, 0);
             }
 
-            if ((attr = std_config_attr_get(node, "fault")) != NULL) {
-                strncpy(settings->status.fault, attr, sizeof(settings->status.fault));
+            if ((attr = sdi_config_attr_get(node, "fault")) != NULL) {
+                settings->status.fault = sdi_string_intern(attr);
             }
         }
     }
@@ -111,6 +110,44 @@ void sdi_fan_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t fa
     hdl->settings = (void*)settings;
 }
 
+/**
+ * Waits until the speeds queued for the fan are written.
+ *
+ * hdl[in] - handle of the resource.
+ *
+ * return result of the last write.
+ */
+t_std_error sdi_fan_write_flush(sdi_resource_priv_hdl_t hdl)
+{
+    sdi_fan_settings_t settings;
+
+    STD_ASSERT(hdl != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_FAN, &settings, sizeof(settings));
+
+    if (settings.speed.set == NULL) {
+        return STD_ERR_OK;
+    }
+
+    return sdi_sysfs_hdl_flush(settings.speed.set);
+}
+
+/**
+ * Forgets the last speed written to the fan, so the next speed set reaches the hardware.
+ *
+ * hdl[in] - handle of the resource.
+ *
+ * return None.
+ */
+void sdi_fan_shadow_invalidate(sdi_resource_priv_hdl_t hdl)
+{
+    sdi_fan_settings_t settings;
+
+    STD_ASSERT(hdl != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_FAN, &settings, sizeof(settings));
+
+    sdi_sysfs_hdl_shadow_invalidate(settings.speed.set);
+}
+
 /*
  * Gets the maximum speed of the fan referred by resource.
  *
@@ -122,24 +159,25 @@ void sdi_fan_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t fa
 t_std_error sdi_fan_max_speed_get(sdi_resource_hdl_t hdl, uint_t *max_speed)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_fan_settings_t     *settings = NULL;
+    sdi_fan_settings_t      settings;
 
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)hdl) != NULL);
-    STD_ASSERT((settings = (sdi_fan_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_FAN, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_FAN) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if (strlen(settings->speed.max_get) == 0) {
-        if (settings->speed.max_rpm > 0) {
-            *max_speed = settings->speed.max_rpm;
-        } else {
-            return SDI_ERRCODE(EPERM);
+    if (settings.speed.max_get == NULL) {
+        if (settings.speed.max_rpm > 0) {
+            *max_speed = settings.speed.max_rpm;
+            return STD_ERR_OK;
         }
+
+        return SDI_ERRCODE(EPERM);
     }
 
-    return sdi_sysfs_attr_uint_get(settings->path, settings->speed.max_get, max_speed);
+    return sdi_sysfs_hdl_uint_get(settings.speed.max_get, max_speed);
 }
 
 /*
@@ -153,16 +191,41 @@ t_std_error sdi_fan_max_speed_get(sdi_resource_hdl_t hdl, uint_t *max_speed)
 t_std_error sdi_fan_speed_get(sdi_resource_hdl_t hdl, uint_t *speed)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_fan_settings_t     *settings = NULL;
+    sdi_fan_settings_t      settings;
+
+    STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)hdl) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_FAN, &settings, sizeof(settings));
+
+    if ((priv_hdl->type != SDI_RESOURCE_FAN) || (settings.speed.get == NULL)) {
+        return SDI_ERRCODE(EPERM);
+    }
+
+    return sdi_sysfs_hdl_uint_get(settings.speed.get, speed);
+}
+
+/*
+ * API implementation to retrieve the speed of the fan referred by resource within
+ * a deadline.
+ *
+ * [in] hdl - resource handle of the fan
+ * [in] timeout_ms - time to wait for the fan
+ * [out] speed - speed(in RPM) is returned in this, the last known one on timeout
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT on timeout and standard error on failure.
+ */
+t_std_error sdi_fan_speed_get_timed(sdi_resource_hdl_t hdl, uint_t timeout_ms, uint_t *speed)
+{
+    sdi_resource_priv_hdl_t priv_hdl = NULL;
+    sdi_fan_settings_t      settings;
 
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)hdl) != NULL);
-    STD_ASSERT((settings = (sdi_fan_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_FAN, &settings, sizeof(settings));
 
-    if ((priv_hdl->type != SDI_RESOURCE_FAN) || (strlen(settings->speed.get) == 0)) {
+    if ((priv_hdl->type != SDI_RESOURCE_FAN) || (settings.speed.get == NULL)) {
         return SDI_ERRCODE(EPERM);
     }
 
-    return sdi_sysfs_attr_uint_get(settings->path, settings->speed.get, speed);
+    return sdi_sysfs_hdl_uint_get_timed(settings.speed.get, timeout_ms, speed);
 }
 
 /*
@@ -176,29 +239,29 @@ t_std_error sdi_fan_speed_get(sdi_resource_hdl_t hdl, uint_t *speed)
 t_std_error sdi_fan_speed_set(sdi_resource_hdl_t hdl, uint_t speed)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_fan_settings_t     *settings = NULL;
+    sdi_fan_settings_t      settings;
     const uint_t            percent = 100;
     uint_t                  pwm_speed = 0;
     uint_t                  max_speed = 0;
 
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)hdl) != NULL);
-    STD_ASSERT((settings = (sdi_fan_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_FAN, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_FAN) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((strlen(settings->speed.max_get) == 0) || (strlen(settings->speed.set) == 0)) {
+    if ((settings.speed.max_get == NULL) || (settings.speed.set == NULL)) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if (sdi_sysfs_attr_uint_get(settings->path, settings->speed.max_get, &max_speed) != STD_ERR_OK) {
+    if (sdi_sysfs_hdl_uint_get(settings.speed.max_get, &max_speed) != STD_ERR_OK) {
         return SDI_ERRCODE(EPERM);
     }
 
-    pwm_speed = settings->speed.max_pwm * (speed * percent / max_speed) / percent;
+    pwm_speed = settings.speed.max_pwm * (speed * percent / max_speed) / percent;
 
-    return sdi_sysfs_attr_uint_set(settings->path, settings->speed.set, pwm_speed);
+    return sdi_sysfs_hdl_uint_set(settings.speed.set, pwm_speed);
 }
 
 /*
@@ -212,22 +275,58 @@ t_std_error sdi_fan_speed_set(sdi_resource_hdl_t hdl, uint_t speed)
 t_std_error sdi_fan_status_get(sdi_resource_hdl_t hdl, bool *status)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_fan_settings_t     *settings = NULL;
+    sdi_fan_settings_t      settings;
     t_std_error             rc = STD_ERR_OK;
     char                    tmp_status[SDI_MAX_NAME_LEN] = {0};
 
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)hdl) != NULL);
-    STD_ASSERT((settings = (sdi_fan_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_FAN, &settings, sizeof(settings));
 
-    if ((priv_hdl->type != SDI_RESOURCE_FAN) || (strlen(settings->status.get) == 0)) {
+    if ((priv_hdl->type != SDI_RESOURCE_FAN) || (settings.status.get == NULL)) {
         return SDI_ERRCODE(EPERM);
     }
 
     *status = true;
 
-    rc = sdi_sysfs_attr_str_get(settings->path, settings->status.get, tmp_status);
+    rc = sdi_sysfs_hdl_str_get(settings.status.get, tmp_status);
     if (rc == STD_ERR_OK) {
-        if (strncmp(settings->status.fault, tmp_status, sizeof(settings->status.fault)) != 0) {
+        if (strncmp(settings.status.fault, tmp_status, SDI_MAX_NAME_LEN) != 0) {
+            *status = false;
+        }
+    }
+
+    return rc;
+}
+
+/*
+ * API implementation to retrieve the fault status of the fan refered by resource
+ * within a deadline.
+ *
+ * [in] hdl - resource handle of the fan
+ * [in] timeout_ms - time to wait for the fan
+ * [out] status - fan's fault status is returned in this, the last known one on timeout
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT on timeout and standard error on failure.
+ */
+t_std_error sdi_fan_status_get_timed(sdi_resource_hdl_t hdl, uint_t timeout_ms, bool *status)
+{
+    sdi_resource_priv_hdl_t priv_hdl = NULL;
+    sdi_fan_settings_t      settings;
+    t_std_error             rc = STD_ERR_OK;
+    char                    tmp_status[SDI_MAX_NAME_LEN] = {0};
+
+    STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)hdl) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_FAN, &settings, sizeof(settings));
+
+    if ((priv_hdl->type != SDI_RESOURCE_FAN) || (settings.status.get == NULL)) {
+        return SDI_ERRCODE(EPERM);
+    }
+
+    *status = true;
+
+    rc = sdi_sysfs_hdl_str_get_timed(settings.status.get, timeout_ms, tmp_status);
+    if ((rc == STD_ERR_OK) || (tmp_status[0] != '\0')) {
+        if (strncmp(settings.status.fault, tmp_status, SDI_MAX_NAME_LEN) != 0) {
             *status = false;
         }
     }
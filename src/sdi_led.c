@@ -11,7 +11,9 @@
 
 #include "sdi_led.h"
 #include "sdi_common.h"
+#include "sdi_config_snapshot.h"
 #include "sdi_sysfs_utils.h"
+#include "sdi_string_pool.h"
 
 
 /**
@@ -19,10 +21,9 @@
  * Used to hold LED related settings.
  */
 typedef struct sdi_led_settings_s {
-    char sysfs_name[SDI_MAX_NAME_LEN]; /**< SysFs name of the LED */
-    char sysfs_path[PATH_MAX];         /**< SysFs path of the LED */
-    char state_off[SDI_MAX_NAME_LEN];  /**< SysFs value for the LED's "off" state */
-    char state_on[SDI_MAX_NAME_LEN];   /**< SysFs value for the LED's "on" state */
+    sdi_sysfs_hdl_t attr;      /**< SysFs attribute of the LED */
+    const char     *state_off; /**< SysFs value for the LED's "off" state */
+    const char     *state_on;  /**< SysFs value for the LED's "on" state */
 } sdi_led_settings_t;
 
 /**
@@ -35,30 +36,30 @@ typedef struct sdi_led_settings_s {
  */
 void sdi_led_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t led_node)
 {
-    char               *name = NULL;
-    char               *path = NULL;
-    char               *state_off = NULL;
-    char               *state_on = NULL;
+    const char         *name = NULL;
+    const char         *path = NULL;
+    const char         *state_off = NULL;
+    const char         *state_on = NULL;
     std_config_node_t   state_node = NULL;
     sdi_led_settings_t *settings = NULL;
 
     memset(&settings, 0, sizeof(settings));
 
-    STD_ASSERT((name = std_config_attr_get(led_node, "name")) != NULL);
-    STD_ASSERT((path = std_config_attr_get(led_node, "path")) != NULL);
+    STD_ASSERT((name = sdi_config_attr_get(led_node, "name")) != NULL);
+    STD_ASSERT((path = sdi_config_attr_get(led_node, "path")) != NULL);
 
-    state_node = std_config_get_child(led_node);
+    state_node = sdi_config_get_child(led_node);
 
-    STD_ASSERT((state_off = std_config_attr_get(state_node, "off")) != NULL);
-    STD_ASSERT((state_on = std_config_attr_get(state_node, "on")) != NULL);
+    STD_ASSERT((state_off = sdi_config_attr_get(state_node, "off")) != NULL);
+    STD_ASSERT((state_on = sdi_config_attr_get(state_node, "on")) != NULL);
 
     settings = (sdi_led_settings_t*)calloc(1, sizeof(sdi_led_settings_t));
     STD_ASSERT(settings != NULL);
 
-    strncpy(settings->sysfs_name, name, sizeof(settings->sysfs_name));
-    strncpy(settings->sysfs_path, path, sizeof(settings->sysfs_path));
-    strncpy(settings->state_off, state_off, sizeof(settings->state_off));
-    strncpy(settings->state_on, state_on, sizeof(settings->state_on));
+    settings->attr = sdi_sysfs_hdl_create(path, name, SDI_SYSFS_ATTR_STR,
+                                          SDI_SYSFS_HDL_F_SHADOW | SDI_SYSFS_HDL_F_ASYNC);
+    settings->state_off = sdi_string_intern(state_off);
+    settings->state_on = sdi_string_intern(state_on);
 
     hdl->settings = (void*)settings;
 }
@@ -73,16 +74,16 @@ void sdi_led_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t le
 t_std_error sdi_led_on(sdi_resource_hdl_t resource_hdl)
 {
     sdi_resource_priv_hdl_t hdl = NULL;
-    sdi_led_settings_t     *settings = NULL;
+    sdi_led_settings_t      settings;
 
     STD_ASSERT((hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_led_settings_t*)hdl->settings) != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_LED, &settings, sizeof(settings));
 
     if (hdl->type != SDI_RESOURCE_LED) {
         return SDI_ERRCODE(EPERM);
     }
 
-    return sdi_sysfs_attr_str_set(settings->sysfs_path, settings->sysfs_name, settings->state_on);
+    return sdi_sysfs_hdl_str_set(settings.attr, settings.state_on);
 }
 
 /**
@@ -95,16 +96,50 @@ t_std_error sdi_led_on(sdi_resource_hdl_t resource_hdl)
 t_std_error sdi_led_off(sdi_resource_hdl_t resource_hdl)
 {
     sdi_resource_priv_hdl_t hdl = NULL;
-    sdi_led_settings_t     *settings = NULL;
+    sdi_led_settings_t      settings;
 
     STD_ASSERT((hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_led_settings_t*)hdl->settings) != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_LED, &settings, sizeof(settings));
 
     if (hdl->type != SDI_RESOURCE_LED) {
         return SDI_ERRCODE(EPERM);
     }
 
-    return sdi_sysfs_attr_str_set(settings->sysfs_path, settings->sysfs_name, settings->state_off);
+    return sdi_sysfs_hdl_str_set(settings.attr, settings.state_off);
+}
+
+/**
+ * Waits until the states queued for the LED are written.
+ *
+ * hdl[in] - handle of the resource.
+ *
+ * return result of the last write.
+ */
+t_std_error sdi_led_write_flush(sdi_resource_priv_hdl_t hdl)
+{
+    sdi_led_settings_t settings;
+
+    STD_ASSERT(hdl != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_LED, &settings, sizeof(settings));
+
+    return sdi_sysfs_hdl_flush(settings.attr);
+}
+
+/**
+ * Forgets the last state written to the LED, so the next on/off reaches the hardware.
+ *
+ * hdl[in] - handle of the resource.
+ *
+ * return None.
+ */
+void sdi_led_shadow_invalidate(sdi_resource_priv_hdl_t hdl)
+{
+    sdi_led_settings_t settings;
+
+    STD_ASSERT(hdl != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_LED, &settings, sizeof(settings));
+
+    sdi_sysfs_hdl_shadow_invalidate(settings.attr);
 }
 
 /**
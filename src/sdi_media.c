@@ -11,9 +11,11 @@
 
 #include "sdi_media.h"
 #include "sdi_common.h"
+#include "sdi_config_snapshot.h"
 #include "sdi_media_utils.h"
-#include <sx/sxd/sxd_dpt.h>
-#include <sx/sxd/sxd_access_register.h>
+#include "sdi_sysfs_utils.h"
+#include "sdi_string_pool.h"
+#include <pthread.h>
 
 
 /**
@@ -21,13 +23,47 @@
  * Used to hold settings for the media resource.
  */
 typedef struct sdi_media_settings_s {
-    char    name[SDI_MAX_NAME_LEN];     /**< name of the media SysFs attribute */
-    char    path[PATH_MAX];             /**< path to the media SysFs attribute */
-    char    status[SDI_MAX_NAME_LEN];   /**< name of the media "present status" SysFs attribute */
-    char    not_present[SDI_MAX_NAME_LEN]; /**< value of the "Not present" status */
-    uint8_t module;                     /**< media module ID */
+    sdi_sysfs_hdl_t status;      /**< media "present status" SysFs attribute */
+    const char     *not_present; /**< value of the "Not present" status */
+    uint8_t         module;      /**< media module ID */
 } sdi_media_settings_t;
 
+/* Serialize the read-modify-write of the control bytes, one lock per media module */
+static pthread_mutex_t sdi_media_control_lock[UINT8_MAX + 1] = {
+    [0 ... UINT8_MAX] = PTHREAD_MUTEX_INITIALIZER
+};
+
+/**
+ * Updates the bits of a control byte of the media module.
+ *
+ * The byte is read, modified and written under the lock of the module, so concurrent
+ * updates of the other bits of the same byte are not lost.
+ *
+ * module[in] - media module ID.
+ * page[in] - page of the control byte.
+ * addr[in] - address of the control byte.
+ * clear[in] - bits to clear.
+ * set[in] - bits to set.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_media_control_update(uint8_t module, uint8_t page, uint16_t addr, uint8_t clear, uint8_t set)
+{
+    t_std_error rc = STD_ERR_OK;
+    uint8_t     buf = 0;
+
+    pthread_mutex_lock(&sdi_media_control_lock[module]);
+
+    if ((rc = sdi_media_info_get(module, page, addr, sizeof(buf), &buf)) == STD_ERR_OK) {
+        buf = (buf & ~clear) | set;
+        rc = sdi_media_info_set(module, page, addr, sizeof(buf), &buf);
+    }
+
+    pthread_mutex_unlock(&sdi_media_control_lock[module]);
+
+    return rc;
+}
+
 /**
  * Registers settings for the specified media resource.
  *
@@ -38,11 +74,11 @@ typedef struct sdi_media_settings_s {
  */
 void sdi_media_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t media_node)
 {
-    char                 *name = NULL;
-    char                 *path = NULL;
-    char                 *status = NULL;
-    char                 *not_present = NULL;
-    char                 *module = NULL;
+    const char           *name = NULL;
+    const char           *path = NULL;
+    const char           *status = NULL;
+    const char           *not_present = NULL;
+    const char           *module = NULL;
     sdi_media_settings_t *settings = NULL;
 
     memset(&settings, 0, sizeof(settings));
@@ -50,26 +86,20 @@ void sdi_media_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t
     STD_ASSERT(hdl != NULL);
     STD_ASSERT(media_node != NULL);
 
-    STD_ASSERT((name = std_config_attr_get(media_node, "name")) != NULL);
-    STD_ASSERT((path = std_config_attr_get(media_node, "path")) != NULL);
-    STD_ASSERT((status = std_config_attr_get(media_node, "status")) != NULL);
-    STD_ASSERT((not_present = std_config_attr_get(media_node, "not_present")) != NULL);
-    STD_ASSERT((module = std_config_attr_get(media_node, "module")) != NULL);
+    STD_ASSERT((name = sdi_config_attr_get(media_node, "name")) != NULL);
+    STD_ASSERT((path = sdi_config_attr_get(media_node, "path")) != NULL);
+    STD_ASSERT((status = sdi_config_attr_get(media_node, "status")) != NULL);
+    STD_ASSERT((not_present = sdi_config_attr_get(media_node, "not_present")) != NULL);
+    STD_ASSERT((module = sdi_config_attr_get(media_node, "module")) != NULL);
 
     settings = (sdi_media_settings_t*)calloc(1, sizeof(sdi_media_settings_t));
     STD_ASSERT(settings != NULL);
 
-    strncpy(settings->name, name, sizeof(settings->name));
-    strncpy(settings->path, path, sizeof(settings->path));
-    strncpy(settings->status, status, sizeof(settings->status));
-    strncpy(settings->not_present, not_present, sizeof(settings->not_present));
+    settings->status = sdi_sysfs_hdl_create(path, status, SDI_SYSFS_ATTR_STR, 0);
+    settings->not_present = sdi_string_intern(not_present);
     settings->module = atoi(module);
 
     hdl->settings = (void*)settings;
-
-    if (sxd_access_reg_init(0, NULL, SX_VERBOSITY_LEVEL_INFO) != SXD_STATUS_SUCCESS) {
-        STD_ASSERT(false);
-    }
 }
 
 /**
@@ -83,13 +113,13 @@ void sdi_media_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t
 t_std_error sdi_media_presence_get(sdi_resource_hdl_t resource_hdl, bool *pres)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     char                    status[SDI_MAX_NAME_LEN] = {0};
 
     STD_ASSERT(pres != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
@@ -97,9 +127,9 @@ t_std_error sdi_media_presence_get(sdi_resource_hdl_t resource_hdl, bool *pres)
 
     *pres = false;
 
-    rc = sdi_sysfs_attr_str_get(settings->path, settings->status, status);
+    rc = sdi_sysfs_hdl_str_get(settings.status, status);
     if (rc == STD_ERR_OK) {
-        if (strncmp(settings->not_present, status, sizeof(settings->not_present)) != 0) {
+        if (strncmp(settings.not_present, status, SDI_MAX_NAME_LEN) != 0) {
             *pres = true;
         }
     }
@@ -119,20 +149,20 @@ t_std_error sdi_media_presence_get(sdi_resource_hdl_t resource_hdl, bool *pres)
 t_std_error sdi_media_module_monitor_status_get(sdi_resource_hdl_t resource_hdl, uint_t flags, uint_t *status)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf = 0;
 
     STD_ASSERT(status != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -141,7 +171,7 @@ t_std_error sdi_media_module_monitor_status_get(sdi_resource_hdl_t resource_hdl,
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
         /* Get temperature alarm and warning status */
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_TEMP_INTERRUPT_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_TEMP_INTERRUPT_ADDR, sizeof(buf), &buf);
         if (rc == STD_ERR_OK) {
             if ((flags & SDI_MEDIA_STATUS_TEMP_HIGH_ALARM) && (buf & QSFP_TEMP_HIGH_ALARM_BIT)) {
                 *status |= SDI_MEDIA_STATUS_TEMP_HIGH_ALARM;
@@ -159,7 +189,7 @@ t_std_error sdi_media_module_monitor_status_get(sdi_resource_hdl_t resource_hdl,
             return rc;
         }
         /* Get voltage alarm and warning status */
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_VOLT_INTERRUPT_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_VOLT_INTERRUPT_ADDR, sizeof(buf), &buf);
         if (rc == STD_ERR_OK) {
             if ((flags & SDI_MEDIA_STATUS_VOLT_HIGH_ALARM) && (buf & QSFP_VOLT_HIGH_ALARM_BIT)) {
                 *status |= SDI_MEDIA_STATUS_VOLT_HIGH_ALARM;
@@ -180,7 +210,7 @@ t_std_error sdi_media_module_monitor_status_get(sdi_resource_hdl_t resource_hdl,
 
     case SDI_MEDIA_ID_TYPE_SFP:
         /* Get temperature and voltage alarm status */
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_ALARM_STATUS_1_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, SFP_ALARM_STATUS_1_ADDR, sizeof(buf), &buf);
         if (rc == STD_ERR_OK) {
             if ((flags & SDI_MEDIA_STATUS_TEMP_HIGH_ALARM) && (buf & SFP_TEMP_HIGH_ALARM_BIT)) {
                 *status |= SDI_MEDIA_STATUS_TEMP_HIGH_ALARM;
@@ -198,7 +228,7 @@ t_std_error sdi_media_module_monitor_status_get(sdi_resource_hdl_t resource_hdl,
             return rc;
         }
         /* Get temperature and voltage warning status */
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_WARNING_STATUS_1_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, SFP_WARNING_STATUS_1_ADDR, sizeof(buf), &buf);
         if (rc == STD_ERR_OK) {
             if ((flags & SDI_MEDIA_STATUS_TEMP_HIGH_WARNING) && (buf & SFP_TEMP_HIGH_WARNING_BIT)) {
                 *status |= SDI_MEDIA_STATUS_TEMP_HIGH_WARNING;
@@ -218,7 +248,7 @@ t_std_error sdi_media_module_monitor_status_get(sdi_resource_hdl_t resource_hdl,
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -242,7 +272,7 @@ t_std_error sdi_media_channel_monitor_status_get(sdi_resource_hdl_t resource_hdl
                                                  uint_t            *status)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf;
@@ -250,13 +280,13 @@ t_std_error sdi_media_channel_monitor_status_get(sdi_resource_hdl_t resource_hdl
 
     STD_ASSERT(status != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -270,7 +300,7 @@ t_std_error sdi_media_channel_monitor_status_get(sdi_resource_hdl_t resource_hdl
         } else if ((channel == SDI_QSFP_CHANNEL3) || (channel == SDI_QSFP_CHANNEL4)) {
             addr = QSFP_RX34_POWER_INTERRUPT_ADDR;
         }
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, addr, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, addr, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -310,7 +340,7 @@ t_std_error sdi_media_channel_monitor_status_get(sdi_resource_hdl_t resource_hdl
         } else if ((channel == SDI_QSFP_CHANNEL3) || (channel == SDI_QSFP_CHANNEL4)) {
             addr = QSFP_TX34_BIAS_INTERRUPT_ADDR;
         }
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, addr, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, addr, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -347,7 +377,7 @@ t_std_error sdi_media_channel_monitor_status_get(sdi_resource_hdl_t resource_hdl
 
     case SDI_MEDIA_ID_TYPE_SFP:
         /* Get TX bias and TX power alarm  status */
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_ALARM_STATUS_1_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, SFP_ALARM_STATUS_1_ADDR, sizeof(buf), &buf);
         if (rc == STD_ERR_OK) {
             if ((flags & SDI_MEDIA_TX_BIAS_HIGH_ALARM) && (buf & SFP_TX_BIAS_HIGH_ALARM_BIT)) {
                 *status |= SDI_MEDIA_TX_BIAS_HIGH_ALARM;
@@ -366,7 +396,7 @@ t_std_error sdi_media_channel_monitor_status_get(sdi_resource_hdl_t resource_hdl
         }
 
         /* Get RX power alarm status */
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_ALARM_STATUS_2_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, SFP_ALARM_STATUS_2_ADDR, sizeof(buf), &buf);
         if (rc == STD_ERR_OK) {
             if ((flags & SDI_MEDIA_RX_PWR_HIGH_ALARM) && (buf & SFP_RX_PWR_HIGH_ALARM_BIT)) {
                 *status |= SDI_MEDIA_RX_PWR_HIGH_ALARM;
@@ -379,7 +409,7 @@ t_std_error sdi_media_channel_monitor_status_get(sdi_resource_hdl_t resource_hdl
         }
 
         /* Get TX bias and TX power warning status */
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_WARNING_STATUS_1_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, SFP_WARNING_STATUS_1_ADDR, sizeof(buf), &buf);
         if (rc == STD_ERR_OK) {
             if ((flags & SDI_MEDIA_TX_BIAS_HIGH_WARNING) && (buf & SFP_TX_BIAS_HIGH_WARNING_BIT)) {
                 *status |= SDI_MEDIA_TX_BIAS_HIGH_WARNING;
@@ -398,7 +428,7 @@ t_std_error sdi_media_channel_monitor_status_get(sdi_resource_hdl_t resource_hdl
         }
 
         /* Get RX power warning status */
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_WARNING_STATUS_2_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, SFP_WARNING_STATUS_2_ADDR, sizeof(buf), &buf);
         if (rc == STD_ERR_OK) {
             if ((flags & SDI_MEDIA_RX_PWR_HIGH_WARNING) && (buf & SFP_RX_PWR_HIGH_WARNING_BIT)) {
                 *status |= SDI_MEDIA_RX_PWR_HIGH_WARNING;
@@ -412,7 +442,7 @@ t_std_error sdi_media_channel_monitor_status_get(sdi_resource_hdl_t resource_hdl
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -433,20 +463,20 @@ t_std_error sdi_media_channel_monitor_status_get(sdi_resource_hdl_t resource_hdl
 t_std_error sdi_media_channel_status_get(sdi_resource_hdl_t resource_hdl, uint_t channel, uint_t flags, uint_t *status)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf = 0;
 
     STD_ASSERT(status != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -455,7 +485,7 @@ t_std_error sdi_media_channel_status_get(sdi_resource_hdl_t resource_hdl, uint_t
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
         /* Get TX disable status */
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_TX_CONTROL_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_TX_CONTROL_ADDR, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -468,7 +498,7 @@ t_std_error sdi_media_channel_status_get(sdi_resource_hdl_t resource_hdl, uint_t
         }
 
         /* Get TX fault status */
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_CHANNEL_TXFAULT_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_CHANNEL_TXFAULT_ADDR, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -481,7 +511,7 @@ t_std_error sdi_media_channel_status_get(sdi_resource_hdl_t resource_hdl, uint_t
         }
 
         /* Get TXLOSS and RXLOSS status */
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_CHANNEL_LOS_INDICATOR_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_CHANNEL_LOS_INDICATOR_ADDR, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -502,7 +532,7 @@ t_std_error sdi_media_channel_status_get(sdi_resource_hdl_t resource_hdl, uint_t
         break;
 
     case SDI_MEDIA_ID_TYPE_SFP:
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_OPTIONAL_STATUS_CONTROL_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, SFP_OPTIONAL_STATUS_CONTROL_ADDR, sizeof(buf), &buf);
         if (rc == STD_ERR_OK) {
             if ((flags & SDI_MEDIA_STATUS_TXDISABLE) && (buf & SFP_TX_DISABLE_STATE_BIT)) {
                 *status |= SDI_MEDIA_STATUS_TXDISABLE;
@@ -519,7 +549,7 @@ t_std_error sdi_media_channel_status_get(sdi_resource_hdl_t resource_hdl, uint_t
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -539,19 +569,19 @@ t_std_error sdi_media_channel_status_get(sdi_resource_hdl_t resource_hdl, uint_t
 t_std_error sdi_media_tx_control(sdi_resource_hdl_t resource_hdl, uint_t channel, bool enable)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf = 0;
 
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -559,43 +589,19 @@ t_std_error sdi_media_tx_control(sdi_resource_hdl_t resource_hdl, uint_t channel
     case SDI_MEDIA_ID_TYPE_QSFP:
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_TX_CONTROL_ADDR, sizeof(buf), &buf);
-        if (rc != STD_ERR_OK) {
-            return rc;
-        }
-
-        if (enable == true) {
-            buf &= ~(1 << channel);
-        } else {
-            buf |= (1 << channel);
-        }
-
-        rc = sdi_media_info_set(settings->module, SDI_QSFP_PAGE_0, QSFP_TX_CONTROL_ADDR, sizeof(buf), &buf);
-        if (rc != STD_ERR_OK) {
-            return rc;
-        }
+        buf = (1 << channel);
+        rc = sdi_media_control_update(settings.module, SDI_QSFP_PAGE_0, QSFP_TX_CONTROL_ADDR,
+                                      (enable == true) ? buf : 0, (enable == true) ? 0 : buf);
         break;
 
     case SDI_MEDIA_ID_TYPE_SFP:
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_OPTIONAL_STATUS_CONTROL_ADDR, sizeof(buf), &buf);
-        if (rc != STD_ERR_OK) {
-            return rc;
-        }
-
-        if (enable) {
-            buf &= ~SFP_SOFT_TX_DISABLE_STATE_BIT;
-        } else {
-            buf |= SFP_SOFT_TX_DISABLE_STATE_BIT;
-        }
-
-        rc = sdi_media_info_set(settings->module, SDI_SFP_PAGE_2, SFP_OPTIONAL_STATUS_CONTROL_ADDR, sizeof(buf), &buf);
-        if (rc != STD_ERR_OK) {
-            return rc;
-        }
+        buf = SFP_SOFT_TX_DISABLE_STATE_BIT;
+        rc = sdi_media_control_update(settings.module, SDI_SFP_PAGE_2, SFP_OPTIONAL_STATUS_CONTROL_ADDR,
+                                      (enable == true) ? buf : 0, (enable == true) ? 0 : buf);
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -614,20 +620,20 @@ t_std_error sdi_media_tx_control(sdi_resource_hdl_t resource_hdl, uint_t channel
 t_std_error sdi_media_tx_control_status_get(sdi_resource_hdl_t resource_hdl, uint_t channel, bool *status)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf = 0;
 
     STD_ASSERT(status != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -635,7 +641,7 @@ t_std_error sdi_media_tx_control_status_get(sdi_resource_hdl_t resource_hdl, uin
     case SDI_MEDIA_ID_TYPE_QSFP:
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_TX_CONTROL_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_TX_CONTROL_ADDR, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -651,7 +657,7 @@ t_std_error sdi_media_tx_control_status_get(sdi_resource_hdl_t resource_hdl, uin
         break;
 
     case SDI_MEDIA_ID_TYPE_SFP:
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_OPTIONAL_STATUS_CONTROL_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, SFP_OPTIONAL_STATUS_CONTROL_ADDR, sizeof(buf), &buf);
         if (rc == STD_ERR_OK) {
             if (buf & SFP_TX_DISABLE_STATE_BIT) {
                 *status = false;
@@ -664,7 +670,7 @@ t_std_error sdi_media_tx_control_status_get(sdi_resource_hdl_t resource_hdl, uin
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
         break;
     }
@@ -685,19 +691,19 @@ t_std_error sdi_media_tx_control_status_get(sdi_resource_hdl_t resource_hdl, uin
 t_std_error sdi_media_cdr_status_set(sdi_resource_hdl_t resource_hdl, uint_t channel, bool enable)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf = 0;
 
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -705,30 +711,16 @@ t_std_error sdi_media_cdr_status_set(sdi_resource_hdl_t resource_hdl, uint_t cha
     case SDI_MEDIA_ID_TYPE_QSFP:
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_CDR_CONTROL_ADDR, sizeof(buf), &buf);
-        if (rc != STD_ERR_OK) {
-            return rc;
-        }
-
-        if (enable == true) {
-            buf |= (0x1 << channel);
-            buf |= (0x10 << channel);
-        } else {
-            buf &= ~(0x1 << channel);
-            buf &= ~(0x10 << channel);
-        }
-
-        rc = sdi_media_info_set(settings->module, SDI_QSFP_PAGE_0, QSFP_CDR_CONTROL_ADDR, sizeof(buf), &buf);
-        if (rc != STD_ERR_OK) {
-            return rc;
-        }
+        buf = (0x1 << channel) | (0x10 << channel);
+        rc = sdi_media_control_update(settings.module, SDI_QSFP_PAGE_0, QSFP_CDR_CONTROL_ADDR,
+                                      (enable == true) ? 0 : buf, (enable == true) ? buf : 0);
         break;
 
     case SDI_MEDIA_ID_TYPE_SFP:
         return SDI_ERRCODE(EOPNOTSUPP);     /* Unsupported on SFP */
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -747,20 +739,20 @@ t_std_error sdi_media_cdr_status_set(sdi_resource_hdl_t resource_hdl, uint_t cha
 t_std_error sdi_media_cdr_status_get(sdi_resource_hdl_t resource_hdl, uint_t channel, bool *status)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf = 0;
 
     STD_ASSERT(status != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -768,7 +760,7 @@ t_std_error sdi_media_cdr_status_get(sdi_resource_hdl_t resource_hdl, uint_t cha
     case SDI_MEDIA_ID_TYPE_QSFP:
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_CDR_CONTROL_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_CDR_CONTROL_ADDR, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -784,7 +776,7 @@ t_std_error sdi_media_cdr_status_get(sdi_resource_hdl_t resource_hdl, uint_t cha
         return SDI_ERRCODE(EOPNOTSUPP);     /* Unsupported on SFP */
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -802,19 +794,19 @@ t_std_error sdi_media_cdr_status_get(sdi_resource_hdl_t resource_hdl, uint_t cha
 t_std_error sdi_media_speed_get(sdi_resource_hdl_t resource_hdl, sdi_media_speed_t *speed)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
 
     STD_ASSERT(speed != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -833,7 +825,7 @@ t_std_error sdi_media_speed_get(sdi_resource_hdl_t resource_hdl, sdi_media_speed
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -868,20 +860,20 @@ t_std_error sdi_media_is_dell_qualified(sdi_resource_hdl_t resource_hdl, bool *s
 t_std_error sdi_media_parameter_get(sdi_resource_hdl_t resource_hdl, sdi_media_param_type_t param, uint_t *value)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint32_t                buf = 0;
 
     STD_ASSERT(value != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -889,7 +881,7 @@ t_std_error sdi_media_parameter_get(sdi_resource_hdl_t resource_hdl, sdi_media_p
     case SDI_MEDIA_ID_TYPE_QSFP:
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, sdi_qsfp_info[param].addr,
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, sdi_qsfp_info[param].addr,
                                 sdi_qsfp_info[param].size, (uint8_t*)&buf);
         if (rc == STD_ERR_OK) {
             *value = (uint_t)buf;
@@ -897,7 +889,7 @@ t_std_error sdi_media_parameter_get(sdi_resource_hdl_t resource_hdl, sdi_media_p
         break;
 
     case SDI_MEDIA_ID_TYPE_SFP:
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_0, sdi_sfp_info[param].addr,
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_0, sdi_sfp_info[param].addr,
                                 sdi_sfp_info[param].size, (uint8_t*)&buf);
         if (rc == STD_ERR_OK) {
             *value = (uint_t)buf;
@@ -905,7 +897,7 @@ t_std_error sdi_media_parameter_get(sdi_resource_hdl_t resource_hdl, sdi_media_p
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -928,14 +920,14 @@ t_std_error sdi_media_vendor_info_get(sdi_resource_hdl_t           resource_hdl,
                                       size_t                       buf_size)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     size_t                  size = 0;
 
     STD_ASSERT(vendor_info != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     memset(vendor_info, 0, buf_size);
 
@@ -943,7 +935,7 @@ t_std_error sdi_media_vendor_info_get(sdi_resource_hdl_t           resource_hdl,
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -954,7 +946,7 @@ t_std_error sdi_media_vendor_info_get(sdi_resource_hdl_t           resource_hdl,
         size =
             (sdi_qsfp_vendor_info[vendor_info_type].size <
              buf_size) ? sdi_qsfp_vendor_info[vendor_info_type].size : buf_size;
-        rc = sdi_media_info_get(settings->module,
+        rc = sdi_media_info_get(settings.module,
                                 SDI_QSFP_PAGE_0,
                                 sdi_qsfp_vendor_info[vendor_info_type].addr,
                                 size,
@@ -965,7 +957,7 @@ t_std_error sdi_media_vendor_info_get(sdi_resource_hdl_t           resource_hdl,
         size =
             (sdi_sfp_vendor_info[vendor_info_type].size <
              buf_size) ? sdi_sfp_vendor_info[vendor_info_type].size : buf_size;
-        rc = sdi_media_info_get(settings->module,
+        rc = sdi_media_info_get(settings.module,
                                 SDI_SFP_PAGE_0,
                                 sdi_sfp_vendor_info[vendor_info_type].addr,
                                 size,
@@ -973,7 +965,7 @@ t_std_error sdi_media_vendor_info_get(sdi_resource_hdl_t           resource_hdl,
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -992,14 +984,14 @@ t_std_error sdi_media_transceiver_code_get(sdi_resource_hdl_t             resour
                                            sdi_media_transceiver_descr_t *transceiver_info)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf[SDI_MEDIA_BUF_SIZE_8] = {0};
 
     STD_ASSERT(transceiver_info != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     memset(transceiver_info, 0, sizeof(*transceiver_info));
 
@@ -1007,7 +999,7 @@ t_std_error sdi_media_transceiver_code_get(sdi_resource_hdl_t             resour
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -1016,7 +1008,7 @@ t_std_error sdi_media_transceiver_code_get(sdi_resource_hdl_t             resour
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
         rc =
-            sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_COMPLIANCE_CODE_ADDR, SDI_MEDIA_BUF_SIZE_8,
+            sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_COMPLIANCE_CODE_ADDR, SDI_MEDIA_BUF_SIZE_8,
                                buf);
         if (rc == STD_ERR_OK) {
             memcpy(transceiver_info, buf, sizeof(*transceiver_info));
@@ -1024,14 +1016,14 @@ t_std_error sdi_media_transceiver_code_get(sdi_resource_hdl_t             resour
         break;
 
     case SDI_MEDIA_ID_TYPE_SFP:
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_0, SFP_COMPLIANCE_CODE_ADDR, SDI_MEDIA_BUF_SIZE_8, buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_0, SFP_COMPLIANCE_CODE_ADDR, SDI_MEDIA_BUF_SIZE_8, buf);
         if (rc == STD_ERR_OK) {
             memcpy(transceiver_info, buf, sizeof(*transceiver_info));
         }
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -1065,7 +1057,7 @@ t_std_error sdi_media_threshold_get(sdi_resource_hdl_t         resource_hdl,
                                     float                     *value)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf[SDI_MEDIA_BUF_SIZE_2];
@@ -1074,13 +1066,13 @@ t_std_error sdi_media_threshold_get(sdi_resource_hdl_t         resource_hdl,
 
     STD_ASSERT(value != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -1088,7 +1080,7 @@ t_std_error sdi_media_threshold_get(sdi_resource_hdl_t         resource_hdl,
     case SDI_MEDIA_ID_TYPE_QSFP:
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_3, sdi_qsfp_thresholds[threshold_type].addr,
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_3, sdi_qsfp_thresholds[threshold_type].addr,
                                 sdi_qsfp_thresholds[threshold_type].size, buf);
         if (rc == STD_ERR_OK) {
             *value = *((float*)buf);
@@ -1096,7 +1088,7 @@ t_std_error sdi_media_threshold_get(sdi_resource_hdl_t         resource_hdl,
         break;
 
     case SDI_MEDIA_ID_TYPE_SFP:
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, sdi_sfp_thresholds[threshold_type].addr,
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, sdi_sfp_thresholds[threshold_type].addr,
                                 sdi_sfp_thresholds[threshold_type].size, buf);
         if (rc == STD_ERR_OK) {
             *value = *((float*)buf);
@@ -1104,7 +1096,7 @@ t_std_error sdi_media_threshold_get(sdi_resource_hdl_t         resource_hdl,
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -1262,7 +1254,7 @@ t_std_error sdi_media_module_monitor_get(sdi_resource_hdl_t         resource_hdl
                                          float                     *value)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf[SDI_MEDIA_BUF_SIZE_2];
@@ -1271,13 +1263,13 @@ t_std_error sdi_media_module_monitor_get(sdi_resource_hdl_t         resource_hdl
 
     STD_ASSERT(value != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -1286,12 +1278,12 @@ t_std_error sdi_media_module_monitor_get(sdi_resource_hdl_t         resource_hdl
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
         if (monitor == SDI_MEDIA_TEMP) {
-            rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_TEMPERATURE_ADDR, sizeof(buf), buf);
+            rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_TEMPERATURE_ADDR, sizeof(buf), buf);
             if (rc == STD_ERR_OK) {
                 *value = *((float*)buf);
             }
         } else if (monitor == SDI_MEDIA_VOLT) {
-            rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_VOLTAGE_ADDR, sizeof(buf), buf);
+            rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_VOLTAGE_ADDR, sizeof(buf), buf);
             if (rc == STD_ERR_OK) {
                 *value = *((float*)buf);
             }
@@ -1302,12 +1294,12 @@ t_std_error sdi_media_module_monitor_get(sdi_resource_hdl_t         resource_hdl
 
     case SDI_MEDIA_ID_TYPE_SFP:
         if (monitor == SDI_MEDIA_TEMP) {
-            rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_TEMPERATURE_ADDR, sizeof(buf), buf);
+            rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, SFP_TEMPERATURE_ADDR, sizeof(buf), buf);
             if (rc == STD_ERR_OK) {
                 *value = *((float*)buf);
             }
         } else if (monitor == SDI_MEDIA_VOLT) {
-            rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_2, SFP_VOLTAGE_ADDR, sizeof(buf), buf);
+            rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_2, SFP_VOLTAGE_ADDR, sizeof(buf), buf);
             if (rc == STD_ERR_OK) {
                 *value = *((float*)buf);
             }
@@ -1317,7 +1309,7 @@ t_std_error sdi_media_module_monitor_get(sdi_resource_hdl_t         resource_hdl
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -1341,7 +1333,7 @@ t_std_error sdi_media_channel_monitor_get(sdi_resource_hdl_t          resource_h
                                           float                      *value)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint16_t                addr = 0;
@@ -1351,13 +1343,13 @@ t_std_error sdi_media_channel_monitor_get(sdi_resource_hdl_t          resource_h
 
     STD_ASSERT(value != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -1377,7 +1369,7 @@ t_std_error sdi_media_channel_monitor_get(sdi_resource_hdl_t          resource_h
             } else {
                 return SDI_ERRCODE(EINVAL);
             }
-            rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, addr, sizeof(buf), buf);
+            rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, addr, sizeof(buf), buf);
             if (rc == STD_ERR_OK) {
                 *value = *((float*)buf);
             }
@@ -1393,7 +1385,7 @@ t_std_error sdi_media_channel_monitor_get(sdi_resource_hdl_t          resource_h
             } else {
                 return SDI_ERRCODE(EINVAL);
             }
-            rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, addr, sizeof(buf), buf);
+            rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, addr, sizeof(buf), buf);
             if (rc == STD_ERR_OK) {
                 *value = *((float*)buf);
             }
@@ -1406,17 +1398,17 @@ t_std_error sdi_media_channel_monitor_get(sdi_resource_hdl_t          resource_h
 
     case SDI_MEDIA_ID_TYPE_SFP:
         if (monitor == SDI_MEDIA_INTERNAL_RX_POWER_MONITOR) {
-            rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_0, SFP_RX_INPUT_POWER_ADDR, sizeof(buf), buf);
+            rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_0, SFP_RX_INPUT_POWER_ADDR, sizeof(buf), buf);
             if (rc == STD_ERR_OK) {
                 *value = *((float*)buf);
             }
         } else if (monitor == SDI_MEDIA_INTERNAL_TX_BIAS_CURRENT) {
-            rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_0, SFP_TX_BIAS_CURRENT_ADDR, sizeof(buf), buf);
+            rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_0, SFP_TX_BIAS_CURRENT_ADDR, sizeof(buf), buf);
             if (rc == STD_ERR_OK) {
                 *value = *((float*)buf);
             }
         } else if (SDI_MEDIA_INTERNAL_TX_OUTPUT_POWER) {
-            rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_0, SFP_TX_OUTPUT_POWER_ADDR, sizeof(buf), buf);
+            rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_0, SFP_TX_OUTPUT_POWER_ADDR, sizeof(buf), buf);
             if (rc == STD_ERR_OK) {
                 *value = *((float*)buf);
             }
@@ -1426,7 +1418,7 @@ t_std_error sdi_media_channel_monitor_get(sdi_resource_hdl_t          resource_h
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
@@ -1476,7 +1468,7 @@ t_std_error sdi_media_feature_support_status_get(sdi_resource_hdl_t
                                                  sdi_media_supported_feature_t *feature_support)
 {
     sdi_resource_priv_hdl_t priv_hdl = NULL;
-    sdi_media_settings_t   *settings = NULL;
+    sdi_media_settings_t    settings;
     t_std_error             rc = STD_ERR_OK;
     uint32_t                identifier_type = 0;
     uint8_t                 buf = 0;
@@ -1485,13 +1477,13 @@ t_std_error sdi_media_feature_support_status_get(sdi_resource_hdl_t
 
     STD_ASSERT(feature_support != NULL);
     STD_ASSERT((priv_hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_media_settings_t*)priv_hdl->settings) != NULL);
+    sdi_resource_settings_copy(priv_hdl, SDI_RESOURCE_MEDIA, &settings, sizeof(settings));
 
     if (priv_hdl->type != SDI_RESOURCE_MEDIA) {
         return SDI_ERRCODE(EPERM);
     }
 
-    if ((rc = sdi_media_identifier_get(settings->module, &identifier_type)) != STD_ERR_OK) {
+    if ((rc = sdi_media_identifier_get(settings.module, &identifier_type)) != STD_ERR_OK) {
         return rc;
     }
 
@@ -1499,7 +1491,7 @@ t_std_error sdi_media_feature_support_status_get(sdi_resource_hdl_t
     case SDI_MEDIA_ID_TYPE_QSFP:
     case SDI_MEDIA_ID_TYPE_QSFP_PLUS:
     case SDI_MEDIA_ID_TYPE_QSFP_28:
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_STATUS_INDICATOR_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_STATUS_INDICATOR_ADDR, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -1508,7 +1500,7 @@ t_std_error sdi_media_feature_support_status_get(sdi_resource_hdl_t
             feature_support->qsfp_features.paging_support_status = true;
         }
 
-        rc = sdi_media_info_get(settings->module, SDI_QSFP_PAGE_0, QSFP_OPTIONS4_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_QSFP_PAGE_0, QSFP_OPTIONS4_ADDR, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -1522,7 +1514,7 @@ t_std_error sdi_media_feature_support_status_get(sdi_resource_hdl_t
         break;
 
     case SDI_MEDIA_ID_TYPE_SFP:
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_0, SFP_ENHANCED_OPTIONS_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_0, SFP_ENHANCED_OPTIONS_ADDR, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -1534,7 +1526,7 @@ t_std_error sdi_media_feature_support_status_get(sdi_resource_hdl_t
             feature_support->sfp_features.rate_select_status = true;
         }
 
-        rc = sdi_media_info_get(settings->module, SDI_SFP_PAGE_0, SFP_DIAG_MON_TYPE_ADDR, sizeof(buf), &buf);
+        rc = sdi_media_info_get(settings.module, SDI_SFP_PAGE_0, SFP_DIAG_MON_TYPE_ADDR, sizeof(buf), &buf);
         if (rc != STD_ERR_OK) {
             return rc;
         }
@@ -1545,7 +1537,7 @@ t_std_error sdi_media_feature_support_status_get(sdi_resource_hdl_t
         break;
 
     default:
-        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings->module);
+        SDI_ERRMSG_LOG("Invalid identifier type %x of media module %u.", identifier_type, settings.module);
         return SDI_ERRCODE(-1);
     }
 
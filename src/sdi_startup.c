@@ -10,24 +10,87 @@
  ***************************************************************************************/
 
 #include "sdi_common.h"
+#include "sdi_sysfs_utils.h"
+#include "sdi_media_session.h"
+#include "sdi_sysfs_stats.h"
+#include "sdi_sysfs_trace.h"
+#include "sdi_string_pool.h"
+#include "sdi_sys_ext.h"
+#include <inttypes.h>
 
 /**
  * @def Attirbute used to get entity config file path.
  */
-#define SDI_ENTITY_CONFIG_FILE "/etc/opx/sdi/entity.xml"
+#define SDI_ENTITY_CONFIG_FILE "entity.xml"
 
+/**
+ * @def Default directory of the config files and the variable overriding it.
+ */
+#define SDI_CONFIG_DIR     "/etc/opx/sdi"
+#define SDI_CONFIG_DIR_ENV "SDI_CONFIG_DIR"
+
+/**
+ * @def Variables starting the recording or the replay of the hardware accesses.
+ */
+#define SDI_TRACE_RECORD_ENV "SDI_TRACE_RECORD"
+#define SDI_TRACE_REPLAY_ENV "SDI_TRACE_REPLAY"
+#define SDI_TRACE_TIMED_ENV  "SDI_TRACE_TIMED"
+
+
+/**
+ * Builds the full path of SDI config file.
+ *
+ * file[in] - name of the config file.
+ * buf[out] - buffer for the path.
+ * size[in] - size of the buffer.
+ *
+ * return None.
+ */
+void sdi_config_file_get(const char *file, char *buf, size_t size)
+{
+    const char *dir = getenv(SDI_CONFIG_DIR_ENV);
+
+    STD_ASSERT(file != NULL);
+    STD_ASSERT(buf != NULL);
+
+    if ((dir == NULL) || (*dir == '\0')) {
+        dir = SDI_CONFIG_DIR;
+    }
+
+    snprintf(buf, size, "%s/%s", dir, file);
+}
+
+/**
+ * Starts the recording or the replay requested by the environment.
+ *
+ * SDI_TRACE_REPLAY takes precedence over SDI_TRACE_RECORD, SDI_TRACE_TIMED=1 makes
+ * the replay reproduce the recorded latencies.
+ *
+ * return None.
+ */
+static void sdi_sys_trace_env_start(void)
+{
+    const char *file = NULL;
+    const char *timed = getenv(SDI_TRACE_TIMED_ENV);
+
+    if (((file = getenv(SDI_TRACE_REPLAY_ENV)) != NULL) && (*file != '\0')) {
+        sdi_sysfs_trace_replay_start(file, (timed != NULL) && (strcmp(timed, "1") == 0));
+    } else if (((file = getenv(SDI_TRACE_RECORD_ENV)) != NULL) && (*file != '\0')) {
+        sdi_sysfs_trace_record_start(file);
+    }
+}
 
 /**
  * Initializes the specified entity.
  *
  * param[in] hdl - handle to the entity whose information has to be initialised.
- * param[out] init_status - entity initialization status.
+ * param[in] user_data - unused.
  *
- * return None
+ * return entity initialization status.
  */
-static void sdi_sys_entity_init(sdi_entity_hdl_t hdl, void *init_status)
+static t_std_error sdi_sys_entity_init(sdi_entity_hdl_t hdl, void *user_data)
 {
-    *((t_std_error*)init_status) = sdi_entity_init(hdl);
+    return sdi_entity_init(hdl);
 }
 
 /**
@@ -38,14 +101,139 @@ static void sdi_sys_entity_init(sdi_entity_hdl_t hdl, void *init_status)
 t_std_error sdi_sys_init(void)
 {
     t_std_error rc = STD_ERR_OK;
+    char        entity_file[PATH_MAX] = {0};
+
+    sdi_sys_trace_env_start();
 
-    sdi_register_entities(SDI_ENTITY_CONFIG_FILE);
+    sdi_config_file_get(SDI_ENTITY_CONFIG_FILE, entity_file, sizeof(entity_file));
+    sdi_register_entities(entity_file);
 
-    /* Initialise each entity */
-    sdi_entity_for_each(&sdi_sys_entity_init, &rc);
+    /* Initialise each entity, the entities are independent, so their probes overlap */
+    rc = sdi_entity_for_each_parallel(&sdi_sys_entity_init, NULL, 0);
     if (rc != STD_ERR_OK) {
         SDI_ERRMSG_LOG("At least one Entity failed in the init (rc=%d)\n", rc);
     }
 
     return rc;
 }
+
+/**
+ * Retrieves counters of the LED, fan speed and power control writes.
+ *
+ * written[out] - number of writes that reached the hardware.
+ * suppressed[out] - number of writes suppressed as unchanged.
+ *
+ * return None.
+ */
+void sdi_sys_shadow_stats_get(uint64_t *written, uint64_t *suppressed)
+{
+    sdi_sysfs_shadow_stats_get(written, suppressed);
+}
+
+/**
+ * Retrieves the state of the SXD session shared by all media accesses.
+ *
+ * info[out] - state and counters of the session.
+ *
+ * return None.
+ */
+void sdi_sys_sxd_session_get(sdi_sxd_session_info_t *info)
+{
+    sdi_media_sxd_session_get(info);
+}
+
+/**
+ * Switches LED and fan speed writes to the asynchronous mode.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sys_async_write_start(void)
+{
+    return sdi_sysfs_async_start();
+}
+
+/**
+ * Completes the queued writes and switches back to the synchronous writes.
+ *
+ * return None.
+ */
+void sdi_sys_async_write_stop(void)
+{
+    sdi_sysfs_async_stop();
+}
+
+/**
+ * Waits until all the writes queued so far are completed.
+ *
+ * return None.
+ */
+void sdi_sys_write_flush(void)
+{
+    sdi_sysfs_async_flush();
+}
+
+/**
+ * Enables or disables collection of the SysFs access statistics.
+ *
+ * enable[in] - true to enable collection.
+ *
+ * return None.
+ */
+void sdi_sys_stats_enable(bool enable)
+{
+    sdi_sysfs_stats_enable(enable);
+}
+
+/**
+ * Writes the SysFs access statistics as text, one attribute per line, followed by
+ * the memory used by the string pool.
+ *
+ * fd[in] - descriptor to write to.
+ *
+ * return None.
+ */
+void sdi_sys_stats_dump(int fd)
+{
+    sdi_string_pool_usage_t usage;
+
+    sdi_sysfs_stats_dump(fd);
+
+    sdi_string_pool_usage_get(&usage);
+    dprintf(fd, "string_pool strings=%u requests=%" PRIu64 " bytes=%zu saved=%zu allocated=%zu\n",
+            usage.strings, usage.requests, usage.bytes, usage.saved, usage.allocated);
+}
+
+/**
+ * Starts recording all the hardware accesses to the trace file.
+ *
+ * file[in] - path to the trace file, truncated if exists.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sys_trace_record_start(const char *file)
+{
+    return sdi_sysfs_trace_record_start(file);
+}
+
+/**
+ * Starts serving all the hardware accesses from the trace file.
+ *
+ * file[in] - path to the trace file.
+ * timed[in] - true to delay each access by its recorded latency.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sys_trace_replay_start(const char *file, bool timed)
+{
+    return sdi_sysfs_trace_replay_start(file, timed);
+}
+
+/**
+ * Stops the recording or the replay of the hardware accesses.
+ *
+ * return None.
+ */
+void sdi_sys_trace_stop(void)
+{
+    sdi_sysfs_trace_stop();
+}
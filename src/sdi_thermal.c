@@ -12,24 +12,39 @@
 
 #include "sdi_thermal.h"
 #include "sdi_common.h"
+#include "sdi_config_snapshot.h"
+#include "sdi_sysfs_utils.h"
+#include <pthread.h>
 
 #define TEMP_THRESH_UNSUP INT_MIN /**< value, which specifies that threshold is unsupported */
-#define DEGREE_DIVIDER    1000 /* divider to convert millidegrees to degrees (Celsius) */
+
+/**
+ * @struct sdi_temp_thresh_t
+ * Used to hold the thresholds of the thermal sensor resource.
+ */
+typedef struct sdi_temp_thresh_s {
+    pthread_mutex_t lock;     /**< protects the thresholds, which are set at runtime */
+    int             low;      /**< low threshold for the thermal sensor */
+    int             high;     /**< high threshold for the thermal sensor */
+    bool            low_set;  /**< whether the low threshold was set at runtime */
+    bool            high_set; /**< whether the high threshold was set at runtime */
+} sdi_temp_thresh_t;
 
 /**
  * @struct sdi_temp_settings_t
  * Used to hold settings for the thermal sensor resource.
  */
 typedef struct sdi_temp_settings_s {
-    char name[SDI_MAX_NAME_LEN]; /**< name of the temperature SysFs attribute */
-    char path[PATH_MAX];         /**< path to the temperature SysFs attribute */
-    int  low_thresh;             /**< low threshold for the thermal sensor */
-    int  high_thresh;            /**< high threshold for the thermal sensor */
+    sdi_sysfs_hdl_t    attr;   /**< temperature SysFs attribute */
+    sdi_temp_thresh_t *thresh; /**< thresholds, shared by the settings replacing these */
 } sdi_temp_settings_t;
 
 /**
  * Registers settings for the specified thermal sensor resource.
  *
+ * On a reload the settings replaced are passed in the resource. Their thresholds are
+ * taken over, so the ones set at runtime are kept, and the rest get the new config.
+ *
  * hdl[in] - handle of the resource.
  * temp_node[in] - config node for the resource settings.
  *
@@ -37,37 +52,45 @@ typedef struct sdi_temp_settings_s {
  */
 void sdi_temp_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t temp_node)
 {
-    char                *name = NULL;
-    char                *path = NULL;
-    char                *attr = NULL;
+    const char          *name = NULL;
+    const char          *path = NULL;
+    const char          *attr = NULL;
     std_config_node_t    thresholds_node = NULL;
     sdi_temp_settings_t *settings = NULL;
+    int                  low = TEMP_THRESH_UNSUP;
+    int                  high = TEMP_THRESH_UNSUP;
 
-    memset(&settings, 0, sizeof(settings));
-
-    STD_ASSERT((name = std_config_attr_get(temp_node, "name")) != NULL);
-    STD_ASSERT((path = std_config_attr_get(temp_node, "path")) != NULL);
+    STD_ASSERT((name = sdi_config_attr_get(temp_node, "name")) != NULL);
+    STD_ASSERT((path = sdi_config_attr_get(temp_node, "path")) != NULL);
 
-    thresholds_node = std_config_get_child(temp_node);
+    thresholds_node = sdi_config_get_child(temp_node);
 
     settings = (sdi_temp_settings_t*)calloc(1, sizeof(sdi_temp_settings_t));
     STD_ASSERT(settings != NULL);
 
-    strncpy(settings->name, name, sizeof(settings->name));
-    strncpy(settings->path, path, sizeof(settings->path));
+    settings->attr = sdi_sysfs_hdl_create(path, name, SDI_SYSFS_ATTR_INT, 0);
 
     if (thresholds_node != NULL) {
-        if ((attr = std_config_attr_get(thresholds_node, "low")) != NULL) {
-            settings->low_thresh = atoi(attr);
-        }
+        low = ((attr = sdi_config_attr_get(thresholds_node, "low")) != NULL) ? atoi(attr) : 0;
+        high = ((attr = sdi_config_attr_get(thresholds_node, "high")) != NULL) ? atoi(attr) : 0;
+    }
 
-        if ((attr = std_config_attr_get(thresholds_node, "high")) != NULL) {
-            settings->high_thresh = atoi(attr);
-        }
+    if (hdl->settings != NULL) {
+        settings->thresh = ((sdi_temp_settings_t*)hdl->settings)->thresh;
     } else {
-        settings->low_thresh = TEMP_THRESH_UNSUP;
-        settings->high_thresh = TEMP_THRESH_UNSUP;
+        settings->thresh = (sdi_temp_thresh_t*)calloc(1, sizeof(sdi_temp_thresh_t));
+        STD_ASSERT(settings->thresh != NULL);
+        pthread_mutex_init(&settings->thresh->lock, NULL);
+    }
+
+    pthread_mutex_lock(&settings->thresh->lock);
+    if (!settings->thresh->low_set) {
+        settings->thresh->low = low;
     }
+    if (!settings->thresh->high_set) {
+        settings->thresh->high = high;
+    }
+    pthread_mutex_unlock(&settings->thresh->lock);
 
     hdl->settings = (void*)settings;
 }
@@ -82,24 +105,44 @@ void sdi_temp_register_settings(sdi_resource_priv_hdl_t hdl, std_config_node_t t
  */
 t_std_error sdi_temperature_get(sdi_resource_hdl_t resource_hdl, int *temp)
 {
-    t_std_error             rc = STD_ERR_OK;
     sdi_resource_priv_hdl_t hdl = NULL;
-    sdi_temp_settings_t    *settings = NULL;
+    sdi_temp_settings_t     settings;
 
     STD_ASSERT((hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_temp_settings_t*)hdl->settings) != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_TEMPERATURE, &settings, sizeof(settings));
     STD_ASSERT(temp != NULL);
 
     if (hdl->type != SDI_RESOURCE_TEMPERATURE) {
         return SDI_ERRCODE(EPERM);
     }
 
+    return sdi_sysfs_hdl_mdeg_get(settings.attr, temp);
+}
 
-    if ((rc = sdi_sysfs_attr_int_get(settings->path, settings->name, temp)) == STD_ERR_OK) {
-        *temp /= DEGREE_DIVIDER;
+/*
+ * API implementation to retrieve the temperature of the chip refered by resource
+ * within a deadline.
+ *
+ * resource_hdl[in] - resource handle of the chip
+ * timeout_ms[in] - time to wait for the chip
+ * temp[out] - temperature value is returned in this, the last known one on timeout
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT on timeout and standard error on failure.
+ */
+t_std_error sdi_temperature_get_timed(sdi_resource_hdl_t resource_hdl, uint_t timeout_ms, int *temp)
+{
+    sdi_resource_priv_hdl_t hdl = NULL;
+    sdi_temp_settings_t     settings;
+
+    STD_ASSERT((hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_TEMPERATURE, &settings, sizeof(settings));
+    STD_ASSERT(temp != NULL);
+
+    if (hdl->type != SDI_RESOURCE_TEMPERATURE) {
+        return SDI_ERRCODE(EPERM);
     }
 
-    return rc;
+    return sdi_sysfs_hdl_mdeg_get_timed(settings.attr, timeout_ms, temp);
 }
 
 /*
@@ -114,36 +157,44 @@ t_std_error sdi_temperature_get(sdi_resource_hdl_t resource_hdl, int *temp)
 t_std_error sdi_temperature_threshold_get(sdi_resource_hdl_t resource_hdl, sdi_threshold_t threshold_type,  int *val)
 {
     sdi_resource_priv_hdl_t hdl = NULL;
-    sdi_temp_settings_t    *settings = NULL;
+    sdi_temp_settings_t     settings;
+    t_std_error             rc = STD_ERR_OK;
 
     STD_ASSERT((hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_temp_settings_t*)hdl->settings) != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_TEMPERATURE, &settings, sizeof(settings));
     STD_ASSERT(val != NULL);
 
     if (hdl->type != SDI_RESOURCE_TEMPERATURE) {
         return SDI_ERRCODE(EPERM);
     }
 
+    pthread_mutex_lock(&settings.thresh->lock);
+
     switch (threshold_type) {
     case SDI_LOW_THRESHOLD:
-        if (settings->low_thresh == TEMP_THRESH_UNSUP) {
-            return SDI_ERRCODE(EOPNOTSUPP);
+        if (settings.thresh->low == TEMP_THRESH_UNSUP) {
+            rc = SDI_ERRCODE(EOPNOTSUPP);
+            break;
         }
-        *val = settings->low_thresh;
+        *val = settings.thresh->low;
         break;
 
     case SDI_HIGH_THRESHOLD:
-        if (settings->low_thresh == TEMP_THRESH_UNSUP) {
-            return SDI_ERRCODE(EOPNOTSUPP);
+        if (settings.thresh->low == TEMP_THRESH_UNSUP) {
+            rc = SDI_ERRCODE(EOPNOTSUPP);
+            break;
         }
-        *val = settings->high_thresh;
+        *val = settings.thresh->high;
         break;
 
     default:
-        return SDI_ERRCODE(EPERM);
+        rc = SDI_ERRCODE(EPERM);
+        break;
     }
 
-    return STD_ERR_OK;
+    pthread_mutex_unlock(&settings.thresh->lock);
+
+    return rc;
 }
 
 /*
@@ -158,35 +209,45 @@ t_std_error sdi_temperature_threshold_get(sdi_resource_hdl_t resource_hdl, sdi_t
 t_std_error sdi_temperature_threshold_set(sdi_resource_hdl_t resource_hdl, sdi_threshold_t threshold_type, int val)
 {
     sdi_resource_priv_hdl_t hdl = NULL;
-    sdi_temp_settings_t    *settings = NULL;
+    sdi_temp_settings_t     settings;
+    t_std_error             rc = STD_ERR_OK;
 
     STD_ASSERT((hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_temp_settings_t*)hdl->settings) != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_TEMPERATURE, &settings, sizeof(settings));
 
     if (hdl->type != SDI_RESOURCE_TEMPERATURE) {
         return SDI_ERRCODE(EPERM);
     }
 
+    pthread_mutex_lock(&settings.thresh->lock);
+
     switch (threshold_type) {
     case SDI_LOW_THRESHOLD:
-        if (settings->low_thresh == TEMP_THRESH_UNSUP) {
-            return SDI_ERRCODE(EOPNOTSUPP);
+        if (settings.thresh->low == TEMP_THRESH_UNSUP) {
+            rc = SDI_ERRCODE(EOPNOTSUPP);
+            break;
         }
-        settings->low_thresh = val;
+        settings.thresh->low = val;
+        settings.thresh->low_set = true;
         break;
 
     case SDI_HIGH_THRESHOLD:
-        if (settings->low_thresh == TEMP_THRESH_UNSUP) {
-            return SDI_ERRCODE(EOPNOTSUPP);
+        if (settings.thresh->low == TEMP_THRESH_UNSUP) {
+            rc = SDI_ERRCODE(EOPNOTSUPP);
+            break;
         }
-        settings->high_thresh = val;
+        settings.thresh->high = val;
+        settings.thresh->high_set = true;
         break;
 
     default:
-        return SDI_ERRCODE(EPERM);
+        rc = SDI_ERRCODE(EPERM);
+        break;
     }
 
-    return STD_ERR_OK;
+    pthread_mutex_unlock(&settings.thresh->lock);
+
+    return rc;
 }
 
 /*
@@ -200,12 +261,12 @@ t_std_error sdi_temperature_threshold_set(sdi_resource_hdl_t resource_hdl, sdi_t
 t_std_error sdi_temperature_status_get(sdi_resource_hdl_t resource_hdl, bool *alert_on)
 {
     sdi_resource_priv_hdl_t hdl = NULL;
-    sdi_temp_settings_t    *settings = NULL;
+    sdi_temp_settings_t     settings;
     t_std_error             rc = STD_ERR_OK;
     int                     temp = 0;
 
     STD_ASSERT((hdl = (sdi_resource_priv_hdl_t)resource_hdl) != NULL);
-    STD_ASSERT((settings = (sdi_temp_settings_t*)hdl->settings) != NULL);
+    sdi_resource_settings_copy(hdl, SDI_RESOURCE_TEMPERATURE, &settings, sizeof(settings));
     STD_ASSERT(alert_on != NULL);
 
     if (hdl->type != SDI_RESOURCE_TEMPERATURE) {
@@ -214,11 +275,14 @@ t_std_error sdi_temperature_status_get(sdi_resource_hdl_t resource_hdl, bool *al
 
     *alert_on = false;
 
-    if ((rc = sdi_sysfs_attr_int_get(settings->path, settings->name, &temp)) == STD_ERR_OK) {
-        if (((settings->low_thresh != TEMP_THRESH_UNSUP) && (temp < settings->low_thresh)) ||
-            ((settings->high_thresh != TEMP_THRESH_UNSUP) && (temp < settings->high_thresh))) {
+    if ((rc = sdi_sysfs_hdl_int_get(settings.attr, &temp)) == STD_ERR_OK) {
+        /* Both thresholds of the same update, the lock isn't held across the read */
+        pthread_mutex_lock(&settings.thresh->lock);
+        if (((settings.thresh->low != TEMP_THRESH_UNSUP) && (temp < settings.thresh->low)) ||
+            ((settings.thresh->high != TEMP_THRESH_UNSUP) && (temp < settings.thresh->high))) {
             *alert_on = true;
         }
+        pthread_mutex_unlock(&settings.thresh->lock);
     }
 
     return rc;
@@ -0,0 +1,504 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/**************************************************************************************
+ * Precompiled binary snapshot of entity.xml and device.xml.
+ *
+ * tools/sdi_snapshot_compile.py validates both config files and writes their elements
+ * and attributes as flat tables (see sdi_config_snapshot.h). The snapshot is mapped
+ * read-only and its nodes are served through the same accessors as the parsed XML,
+ * so the registration code doesn't care where the config came from. A library built
+ * for one platform may have the same tables compiled in (SDI_CONFIG_BUILTIN).
+ ***************************************************************************************/
+
+#include "sdi_common.h"
+#include "sdi_config_snapshot.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @struct sdi_config_snapshot_t
+ * Used to hold the mapped snapshot.
+ */
+typedef struct sdi_config_snapshot_s {
+    const uint8_t                *data;   /**< mapped file, NULL for the compiled-in tables */
+    size_t                        size;   /**< size of the mapping */
+    sdi_config_snapshot_tables_t  tables; /**< tables in use, no nodes if closed */
+} sdi_config_snapshot_t;
+
+static sdi_config_snapshot_t sdi_config_snapshot;
+
+/* Attributes read by the registration code, sorted; the digest covers only these */
+static const char * const sdi_config_digest_attrs[] = {
+    "alias", "fault", "get", "high", "instance", "low", "max_get", "max_pwm", "max_rpm",
+    "module", "name", "not_present", "off", "ok", "on", "path", "power_ctl", "power_off",
+    "power_on", "powerhdl", "presence", "present", "reference", "reset", "set", "status",
+    "type"
+};
+
+#define SDI_CONFIG_DIGEST_ATTRS (sizeof(sdi_config_digest_attrs) / sizeof(sdi_config_digest_attrs[0]))
+
+#ifdef SDI_CONFIG_BUILTIN
+/* Generated by tools/sdi_snapshot_compile.py --c-source */
+extern const sdi_config_snapshot_tables_t sdi_config_builtin;
+#endif
+
+/**
+ * Calculates CRC-32 of the buffer, same as zlib's crc32().
+ *
+ * Eight bytes are folded per step (slicing-by-8), the snapshot is checked on every
+ * startup and a byte at a time would take as long as the rest of the registration.
+ *
+ * buf[in] - buffer.
+ * len[in] - length of the buffer.
+ *
+ * return CRC-32 of the buffer.
+ */
+static uint32_t sdi_config_snapshot_crc(const uint8_t *buf, size_t len)
+{
+    static uint32_t table[8][256];
+    uint32_t        crc = 0;
+    uint32_t        lo = 0;
+    uint32_t        hi = 0;
+    uint32_t        i = 0;
+    uint32_t        bit = 0;
+
+    if (table[0][1] == 0) {
+        for (i = 0; i < 256; i++) {
+            crc = i;
+            for (bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? ((crc >> 1) ^ 0xedb88320u) : (crc >> 1);
+            }
+            table[0][i] = crc;
+        }
+        for (i = 0; i < 256; i++) {
+            for (bit = 1; bit < 8; bit++) {
+                table[bit][i] = (table[bit - 1][i] >> 8) ^ table[0][table[bit - 1][i] & 0xff];
+            }
+        }
+    }
+
+    crc = 0xffffffffu;
+
+    while (len >= 8) {
+        memcpy(&lo, buf, sizeof(lo));
+        memcpy(&hi, buf + 4, sizeof(hi));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        lo = __builtin_bswap32(lo);
+        hi = __builtin_bswap32(hi);
+#endif
+        lo ^= crc;
+        crc = table[7][lo & 0xff] ^ table[6][(lo >> 8) & 0xff] ^ table[5][(lo >> 16) & 0xff] ^
+              table[4][lo >> 24] ^ table[3][hi & 0xff] ^ table[2][(hi >> 8) & 0xff] ^
+              table[1][(hi >> 16) & 0xff] ^ table[0][hi >> 24];
+        buf += 8;
+        len -= 8;
+    }
+
+    while (len-- > 0) {
+        crc = table[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xffffffffu;
+}
+
+/**
+ * Checks whether the config file was modified after the snapshot.
+ *
+ * snapshot[in] - status of the snapshot.
+ * file[in] - path to the config file.
+ *
+ * return true if the config file exists and is newer than the snapshot.
+ */
+static bool sdi_config_snapshot_stale(const struct stat *snapshot, const char *file)
+{
+    struct stat st;
+
+    if ((file == NULL) || (stat(file, &st) != 0)) {
+        return false;
+    }
+
+    return ((st.st_mtim.tv_sec > snapshot->st_mtim.tv_sec) ||
+            ((st.st_mtim.tv_sec == snapshot->st_mtim.tv_sec) &&
+             (st.st_mtim.tv_nsec > snapshot->st_mtim.tv_nsec)));
+}
+
+/**
+ * Validates the mapped snapshot and sets up its tables.
+ *
+ * Every index must point forward (children and siblings follow their node, as the
+ * compiler writes the nodes in document order), so no walk can loop, and every string
+ * offset must be inside the string table, which ends with a terminator.
+ *
+ * tables[out] - tables of the snapshot, set even if they are invalid.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_config_snapshot_validate(sdi_config_snapshot_tables_t *tables)
+{
+    const sdi_config_snapshot_hdr_t  *hdr = (const sdi_config_snapshot_hdr_t*)sdi_config_snapshot.data;
+    const sdi_config_snapshot_node_t *node = NULL;
+    const sdi_config_snapshot_attr_t *attr = NULL;
+    uint64_t                          size = sizeof(*hdr);
+    uint32_t                          i = 0;
+
+    if ((sdi_config_snapshot.size < sizeof(*hdr)) ||
+        (memcmp(hdr->magic, SDI_CONFIG_SNAPSHOT_MAGIC, sizeof(hdr->magic)) != 0) ||
+        (hdr->version != SDI_CONFIG_SNAPSHOT_VERSION) || (hdr->size != sdi_config_snapshot.size)) {
+        return SDI_ERRCODE(EINVAL);
+    }
+
+    size += (uint64_t)hdr->node_count * sizeof(*node) + (uint64_t)hdr->attr_count * sizeof(*attr) +
+            hdr->strings_size;
+    if ((size != hdr->size) || (hdr->strings_size == 0) ||
+        (hdr->roots[SDI_CONFIG_SNAPSHOT_ENTITY] >= hdr->node_count) ||
+        (hdr->roots[SDI_CONFIG_SNAPSHOT_DEVICE] >= hdr->node_count)) {
+        return SDI_ERRCODE(EINVAL);
+    }
+
+    if (sdi_config_snapshot_crc(sdi_config_snapshot.data + sizeof(*hdr), hdr->size - sizeof(*hdr)) != hdr->crc) {
+        return SDI_ERRCODE(EBADMSG); /* Bad message */
+    }
+
+    tables->nodes = (const sdi_config_snapshot_node_t*)(hdr + 1);
+    tables->attrs = (const sdi_config_snapshot_attr_t*)(tables->nodes + hdr->node_count);
+    tables->strings = (const char*)(tables->attrs + hdr->attr_count);
+    tables->node_count = hdr->node_count;
+    memcpy(tables->roots, hdr->roots, sizeof(tables->roots));
+
+    if (tables->strings[hdr->strings_size - 1] != '\0') {
+        return SDI_ERRCODE(EINVAL);
+    }
+
+    for (i = 0; i < hdr->node_count; i++) {
+        node = &tables->nodes[i];
+        if ((node->tag >= hdr->strings_size) || (node->attr > hdr->attr_count) ||
+            (node->attr_count > hdr->attr_count - node->attr) ||
+            ((node->child != SDI_CONFIG_SNAPSHOT_NONE) && ((node->child <= i) || (node->child >= hdr->node_count))) ||
+            ((node->next != SDI_CONFIG_SNAPSHOT_NONE) && ((node->next <= i) || (node->next >= hdr->node_count)))) {
+            return SDI_ERRCODE(EINVAL);
+        }
+    }
+
+    for (i = 0; i < hdr->attr_count; i++) {
+        attr = &tables->attrs[i];
+        if ((attr->name >= hdr->strings_size) || (attr->value >= hdr->strings_size)) {
+            return SDI_ERRCODE(EINVAL);
+        }
+    }
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Maps the snapshot read-only.
+ *
+ * file[in] - path to the snapshot.
+ * entity_file[in] - path to entity.xml.
+ * device_file[in] - path to device.xml.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_config_snapshot_open(const char *file, const char *entity_file, const char *device_file)
+{
+    struct stat st;
+    void       *data = MAP_FAILED;
+    int         fd = -1;
+    t_std_error rc = STD_ERR_OK;
+
+    sdi_config_snapshot_tables_t tables;
+
+    STD_ASSERT(file != NULL);
+    STD_ASSERT(sdi_config_snapshot.tables.nodes == NULL);
+
+    if ((fd = open(file, O_RDONLY | O_CLOEXEC)) < 0) {
+        return SDI_ERRNO;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        rc = SDI_ERRNO;
+    } else if (sdi_config_snapshot_stale(&st, entity_file) || sdi_config_snapshot_stale(&st, device_file)) {
+        SDI_ERRMSG_LOG("%s is older than the config files, parsing them\n", file);
+        rc = SDI_ERRCODE(ESTALE); /* Stale file handle */
+    } else if ((st.st_size <= 0) ||
+               ((data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)) {
+        rc = (st.st_size <= 0) ? SDI_ERRCODE(EINVAL) : SDI_ERRNO;
+    } else {
+        sdi_config_snapshot.data = (const uint8_t*)data;
+        sdi_config_snapshot.size = st.st_size;
+
+        if ((rc = sdi_config_snapshot_validate(&tables)) == STD_ERR_OK) {
+            sdi_config_snapshot.tables = tables;
+        } else {
+            SDI_ERRMSG_LOG("%s is invalid (rc=%d), parsing the config files\n", file, rc);
+            sdi_config_snapshot_close();
+        }
+    }
+
+    close(fd);
+
+    return rc;
+}
+
+/**
+ * Uses the tables compiled into the library.
+ *
+ * return STD_ERR_OK on success, error if the library was built without them.
+ */
+t_std_error sdi_config_snapshot_builtin_open(void)
+{
+    STD_ASSERT(sdi_config_snapshot.tables.nodes == NULL);
+
+#ifdef SDI_CONFIG_BUILTIN
+    /* Generated from the validated configs, so trusted as is */
+    sdi_config_snapshot.tables = sdi_config_builtin;
+
+    return STD_ERR_OK;
+#else
+    return SDI_ERRCODE(ENOENT);
+#endif
+}
+
+/**
+ * Gets the root node of the config file held by the open snapshot.
+ *
+ * root[in] - config file.
+ *
+ * return root node.
+ */
+std_config_node_t sdi_config_snapshot_root_get(sdi_config_snapshot_root_t root)
+{
+    STD_ASSERT(sdi_config_snapshot.tables.nodes != NULL);
+    STD_ASSERT(root < SDI_CONFIG_SNAPSHOT_ROOTS);
+
+    return (std_config_node_t)&sdi_config_snapshot.tables.nodes[sdi_config_snapshot.tables.roots[root]];
+}
+
+/**
+ * Unmaps the snapshot.
+ *
+ * return None.
+ */
+void sdi_config_snapshot_close(void)
+{
+    if (sdi_config_snapshot.data != NULL) {
+        munmap((void*)sdi_config_snapshot.data, sdi_config_snapshot.size);
+    }
+
+    memset(&sdi_config_snapshot, 0, sizeof(sdi_config_snapshot));
+}
+
+/**
+ * Gets the snapshot node behind the config node.
+ *
+ * node[in] - config node.
+ *
+ * return snapshot node or NULL if the node is parsed XML.
+ */
+static inline const sdi_config_snapshot_node_t * sdi_config_snapshot_node(std_config_node_t node)
+{
+    uintptr_t offset = (uintptr_t)node - (uintptr_t)sdi_config_snapshot.tables.nodes;
+
+    if ((sdi_config_snapshot.tables.nodes == NULL) ||
+        (offset >= (uintptr_t)sdi_config_snapshot.tables.node_count * sizeof(sdi_config_snapshot_node_t))) {
+        return NULL;
+    }
+
+    return (const sdi_config_snapshot_node_t*)node;
+}
+
+/**
+ * Converts the node index to the config node.
+ *
+ * index[in] - index of the snapshot node.
+ *
+ * return config node or NULL for SDI_CONFIG_SNAPSHOT_NONE.
+ */
+static inline std_config_node_t sdi_config_snapshot_node_get(uint32_t index)
+{
+    if (index == SDI_CONFIG_SNAPSHOT_NONE) {
+        return NULL;
+    }
+
+    return (std_config_node_t)&sdi_config_snapshot.tables.nodes[index];
+}
+
+/**
+ * Gets the first child of the config node.
+ *
+ * node[in] - config node.
+ *
+ * return first child or NULL if none.
+ */
+std_config_node_t sdi_config_get_child(std_config_node_t node)
+{
+    const sdi_config_snapshot_node_t *snode = sdi_config_snapshot_node(node);
+
+    return (snode != NULL) ? sdi_config_snapshot_node_get(snode->child) : std_config_get_child(node);
+}
+
+/**
+ * Gets the next sibling of the config node.
+ *
+ * node[in] - config node.
+ *
+ * return next sibling or NULL if none.
+ */
+std_config_node_t sdi_config_next_node(std_config_node_t node)
+{
+    const sdi_config_snapshot_node_t *snode = sdi_config_snapshot_node(node);
+
+    return (snode != NULL) ? sdi_config_snapshot_node_get(snode->next) : std_config_next_node(node);
+}
+
+/**
+ * Gets the value of the attribute of the config node.
+ *
+ * node[in] - config node.
+ * attr[in] - name of the attribute.
+ *
+ * return value of the attribute or NULL if it is missing.
+ */
+const char * sdi_config_attr_get(std_config_node_t node, const char *attr)
+{
+    const sdi_config_snapshot_node_t *snode = sdi_config_snapshot_node(node);
+    const sdi_config_snapshot_attr_t *sattr = NULL;
+    uint32_t                          i = 0;
+
+    STD_ASSERT(attr != NULL);
+
+    if (snode == NULL) {
+        return std_config_attr_get(node, attr);
+    }
+
+    for (i = 0; i < snode->attr_count; i++) {
+        sattr = &sdi_config_snapshot.tables.attrs[snode->attr + i];
+        if (strcmp(sdi_config_snapshot.tables.strings + sattr->name, attr) == 0) {
+            return sdi_config_snapshot.tables.strings + sattr->value;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Gets the element name of the config node.
+ *
+ * node[in] - config node.
+ *
+ * return element name.
+ */
+const char * sdi_config_name_get(std_config_node_t node)
+{
+    const sdi_config_snapshot_node_t *snode = sdi_config_snapshot_node(node);
+
+    return (snode != NULL) ? (sdi_config_snapshot.tables.strings + snode->tag) : std_config_name_get(node);
+}
+
+/**
+ * Folds the string into the digest.
+ *
+ * hash[in] - digest so far.
+ * str[in] - string, NULL for a missing value.
+ *
+ * return updated digest.
+ */
+static uint32_t sdi_config_digest_str(uint32_t hash, const char *str)
+{
+    /* FNV-1a, the terminator included, so "ab" + "c" differs from "a" + "bc" */
+    if (str == NULL) {
+        return (hash ^ 0xffu) * 16777619u;
+    }
+
+    do {
+        hash = (hash ^ (uint8_t)*str) * 16777619u;
+    } while (*str++ != '\0');
+
+    return hash;
+}
+
+/**
+ * Finds the attribute among the ones covered by the digest.
+ *
+ * name[in] - name of the attribute.
+ *
+ * return position of the attribute, -1 if it isn't covered.
+ */
+static int sdi_config_digest_attr_find(const char *name)
+{
+    int lo = 0;
+    int hi = (int)SDI_CONFIG_DIGEST_ATTRS - 1;
+    int mid = 0;
+    int cmp = 0;
+
+    while (lo <= hi) {
+        mid = (lo + hi) / 2;
+        if ((cmp = strcmp(name, sdi_config_digest_attrs[mid])) == 0) {
+            return mid;
+        }
+
+        if (cmp < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Folds the config node into the digest.
+ *
+ * hash[in] - digest so far.
+ * node[in] - config node.
+ * subtree[in] - whether the children are folded too.
+ *
+ * return updated digest.
+ */
+uint32_t sdi_config_digest(uint32_t hash, std_config_node_t node, bool subtree)
+{
+    const sdi_config_snapshot_node_t *snode = sdi_config_snapshot_node(node);
+    const sdi_config_snapshot_attr_t *sattr = NULL;
+    const char                       *values[SDI_CONFIG_DIGEST_ATTRS];
+    std_config_node_t                 child = NULL;
+    uint32_t                          i = 0;
+    int                               pos = 0;
+
+    STD_ASSERT(node != NULL);
+
+    if (snode != NULL) {
+        /* One pass over the attributes of the node instead of a lookup per name */
+        memset(values, 0, sizeof(values));
+        for (i = 0; i < snode->attr_count; i++) {
+            sattr = &sdi_config_snapshot.tables.attrs[snode->attr + i];
+            if ((pos = sdi_config_digest_attr_find(sdi_config_snapshot.tables.strings + sattr->name)) >= 0) {
+                values[pos] = sdi_config_snapshot.tables.strings + sattr->value;
+            }
+        }
+    } else {
+        for (i = 0; i < SDI_CONFIG_DIGEST_ATTRS; i++) {
+            values[i] = std_config_attr_get(node, sdi_config_digest_attrs[i]);
+        }
+    }
+
+    hash = sdi_config_digest_str(hash, sdi_config_name_get(node));
+    for (i = 0; i < SDI_CONFIG_DIGEST_ATTRS; i++) {
+        hash = sdi_config_digest_str(hash, values[i]);
+    }
+
+    if (subtree) {
+        for (child = sdi_config_get_child(node); child != NULL; child = sdi_config_next_node(child)) {
+            hash = sdi_config_digest(hash, child, true);
+        }
+    }
+
+    /* Closes the node, so a child and a sibling don't fold the same */
+    return sdi_config_digest_str(hash, NULL);
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/**************************************************************************************
+ * Epoch-based reclamation of data read without locks.
+ *
+ * Every thread announces the global epoch it entered its outermost read-side section
+ * in, in a record of its own. Retiring data tags it with the current epoch and
+ * advances the epoch; the data is released once every announced epoch is newer than
+ * its tag, i.e. every reader which could have loaded it has left its section. Readers
+ * only write their own record, writers serialize on a lock.
+ ***************************************************************************************/
+
+#include "sdi_common.h"
+#include "sdi_epoch.h"
+#include <pthread.h>
+
+#define SDI_EPOCH_CACHE_LINE 64 /**< alignment of the reader records */
+
+/**
+ * @struct sdi_epoch_reader_t
+ * Read-side state of one thread.
+ *
+ * Records are cache line aligned, so a reader entering a section doesn't invalidate
+ * the record of another one.
+ */
+typedef struct sdi_epoch_reader_s {
+    struct sdi_epoch_reader_s *next;    /**< next record */
+    bool                       in_use;  /**< whether a running thread owns the record, under the lock */
+    uint_t                     nesting; /**< depth of the sections entered, owner only */
+    uint64_t                   active;  /**< epoch of the outermost section, 0 outside of sections */
+} __attribute__((aligned(SDI_EPOCH_CACHE_LINE))) sdi_epoch_reader_t;
+
+/**
+ * @struct sdi_epoch_retired_t
+ * Data waiting for the readers to leave.
+ */
+typedef struct sdi_epoch_retired_s {
+    struct sdi_epoch_retired_s *next;    /**< next retired data */
+    void                       *ptr;     /**< the data */
+    sdi_epoch_release_fn_t      release; /**< function releasing the data */
+    uint64_t                    epoch;   /**< epoch the data was retired in */
+} sdi_epoch_retired_t;
+
+/**
+ * @struct sdi_epoch_state_t
+ * Used to hold the records of all the threads and the retired data.
+ */
+typedef struct sdi_epoch_state_s {
+    pthread_mutex_t      lock;    /**< protects the lists and the ownership of the records */
+    pthread_once_t       once;    /**< creates the thread key */
+    pthread_key_t        key;     /**< releases the record when its thread exits */
+    uint64_t             epoch;   /**< current epoch, advanced by every retire */
+    sdi_epoch_reader_t  *readers; /**< records of all the threads */
+    sdi_epoch_retired_t *retired; /**< data not released yet */
+} sdi_epoch_state_t;
+
+static sdi_epoch_state_t sdi_epoch = {
+    .lock  = PTHREAD_MUTEX_INITIALIZER,
+    .once  = PTHREAD_ONCE_INIT,
+    .epoch = 1
+};
+
+static __thread sdi_epoch_reader_t *sdi_epoch_reader;
+
+/**
+ * Hands the record of the exiting thread over to the next new thread.
+ *
+ * arg[in] - record of the exiting thread.
+ *
+ * return None.
+ */
+static void sdi_epoch_reader_release(void *arg)
+{
+    sdi_epoch_reader_t *reader = (sdi_epoch_reader_t*)arg;
+
+    pthread_mutex_lock(&sdi_epoch.lock);
+    reader->nesting = 0;
+    __atomic_store_n(&reader->active, 0, __ATOMIC_RELEASE);
+    reader->in_use = false;
+    pthread_mutex_unlock(&sdi_epoch.lock);
+}
+
+/**
+ * Creates the key, which releases the records of the exiting threads.
+ *
+ * return None.
+ */
+static void sdi_epoch_key_create(void)
+{
+    int err = pthread_key_create(&sdi_epoch.key, sdi_epoch_reader_release);
+
+    STD_ASSERT(err == 0);
+}
+
+/**
+ * Assigns a record to the calling thread, the one released by an exited thread if any.
+ *
+ * return record of the calling thread.
+ */
+static sdi_epoch_reader_t * sdi_epoch_reader_get(void)
+{
+    sdi_epoch_reader_t *reader = NULL;
+    void               *mem = NULL;
+    int                 err = 0;
+
+    pthread_once(&sdi_epoch.once, sdi_epoch_key_create);
+
+    pthread_mutex_lock(&sdi_epoch.lock);
+
+    for (reader = sdi_epoch.readers; (reader != NULL) && reader->in_use; reader = reader->next) {
+    }
+
+    if (reader == NULL) {
+        err = posix_memalign(&mem, SDI_EPOCH_CACHE_LINE, sizeof(*reader));
+        STD_ASSERT(err == 0);
+        reader = (sdi_epoch_reader_t*)mem;
+        memset(reader, 0, sizeof(*reader));
+
+        reader->next = sdi_epoch.readers;
+        sdi_epoch.readers = reader;
+    }
+    reader->in_use = true;
+
+    pthread_mutex_unlock(&sdi_epoch.lock);
+
+    pthread_setspecific(sdi_epoch.key, reader);
+
+    return reader;
+}
+
+/**
+ * Enters a read-side section.
+ *
+ * return None.
+ */
+void sdi_epoch_enter(void)
+{
+    sdi_epoch_reader_t *reader = sdi_epoch_reader;
+
+    if (reader == NULL) {
+        reader = sdi_epoch_reader = sdi_epoch_reader_get();
+    }
+
+    if (reader->nesting++ == 0) {
+        /*
+         * Acquire, so a reader announcing an epoch already advanced by a retire also
+         * loads the pointer published before it. The fence orders the announcement
+         * before the loads of the section: either the retiring writer sees it, or
+         * the reader sees what the writer published.
+         */
+        __atomic_store_n(&reader->active, __atomic_load_n(&sdi_epoch.epoch, __ATOMIC_ACQUIRE),
+                         __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * Leaves the read-side section entered last by the calling thread.
+ *
+ * return None.
+ */
+void sdi_epoch_exit(void)
+{
+    sdi_epoch_reader_t *reader = sdi_epoch_reader;
+
+    STD_ASSERT((reader != NULL) && (reader->nesting > 0));
+
+    if (--reader->nesting == 0) {
+        __atomic_store_n(&reader->active, 0, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * Releases the data once no reader may still hold it.
+ *
+ * ptr[in] - data to release.
+ * release[in] - function releasing the data.
+ *
+ * return None.
+ */
+void sdi_epoch_retire(void *ptr, sdi_epoch_release_fn_t release)
+{
+    sdi_epoch_retired_t  *entry = NULL;
+    sdi_epoch_retired_t  *ready = NULL;
+    sdi_epoch_retired_t **prev = NULL;
+    sdi_epoch_reader_t   *reader = NULL;
+    uint64_t              oldest = 0;
+    uint64_t              active = 0;
+
+    STD_ASSERT(release != NULL);
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    entry = (sdi_epoch_retired_t*)calloc(1, sizeof(*entry));
+    STD_ASSERT(entry != NULL);
+
+    entry->ptr = ptr;
+    entry->release = release;
+
+    pthread_mutex_lock(&sdi_epoch.lock);
+
+    entry->epoch = __atomic_fetch_add(&sdi_epoch.epoch, 1, __ATOMIC_ACQ_REL);
+    entry->next = sdi_epoch.retired;
+    sdi_epoch.retired = entry;
+
+    /* Pairs with the fence of sdi_epoch_enter() */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    oldest = entry->epoch + 1;
+    for (reader = sdi_epoch.readers; reader != NULL; reader = reader->next) {
+        active = __atomic_load_n(&reader->active, __ATOMIC_ACQUIRE);
+        if ((active != 0) && (active < oldest)) {
+            oldest = active;
+        }
+    }
+
+    /* Data retired before the oldest section was entered can't be held by anyone */
+    prev = &sdi_epoch.retired;
+    while (*prev != NULL) {
+        if ((*prev)->epoch < oldest) {
+            entry = *prev;
+            *prev = entry->next;
+            entry->next = ready;
+            ready = entry;
+        } else {
+            prev = &(*prev)->next;
+        }
+    }
+
+    pthread_mutex_unlock(&sdi_epoch.lock);
+
+    while (ready != NULL) {
+        entry = ready;
+        ready = entry->next;
+        (*entry->release)(entry->ptr);
+        free(entry);
+    }
+}
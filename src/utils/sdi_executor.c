@@ -0,0 +1,288 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/**************************************************************************************
+ * Work-stealing executor of independent hardware operations.
+ *
+ * A pool of SDI_EXECUTOR_WORKERS threads, started on the first use, joins the jobs
+ * queued by sdi_executor_run(). Each participant of a job owns a range of its items
+ * and takes them from the front; once its range is empty, it moves the back half of
+ * another participant's range to itself. The caller is the first participant of its
+ * job and waits for the others to leave before returning.
+ ***************************************************************************************/
+
+#include "sdi_common.h"
+#include "sdi_executor.h"
+#include <pthread.h>
+
+/**
+ * @struct sdi_executor_range_t
+ * Items owned by one participant of a job.
+ */
+typedef struct sdi_executor_range_s {
+    pthread_mutex_t lock; /**< protects the range */
+    uint_t          head; /**< next item taken by the owner */
+    uint_t          tail; /**< end of the range, moved down by the thieves */
+} sdi_executor_range_t;
+
+/**
+ * @struct sdi_executor_job_t
+ * Items of one sdi_executor_run() call.
+ */
+typedef struct sdi_executor_job_s {
+    struct sdi_executor_job_s *next;      /**< next job queued in the pool */
+    sdi_executor_fn_t          fn;        /**< operation executed for each item */
+    void                      *data;      /**< user data of the operation */
+    uint_t                     slots;     /**< maximal number of participants */
+    uint_t                     joined;    /**< number of participants so far, under the pool lock */
+    uint_t                     left;      /**< number of participants done, under the pool lock */
+    uint_t                     err_index; /**< lowest index of a failed item, under the pool lock */
+    t_std_error                rc;        /**< error of that item */
+    sdi_executor_range_t       ranges[];  /**< items of each participant */
+} sdi_executor_job_t;
+
+/**
+ * @struct sdi_executor_pool_t
+ * Worker threads and the jobs they may join.
+ */
+typedef struct sdi_executor_pool_s {
+    pthread_once_t      once; /**< starts the workers */
+    pthread_mutex_t     lock; /**< protects the queue and the participant counts of the jobs */
+    pthread_cond_t      work; /**< signaled when a job is queued */
+    pthread_cond_t      done; /**< signaled when a participant leaves a job */
+    sdi_executor_job_t *head; /**< queued jobs which may still be joined */
+} sdi_executor_pool_t;
+
+static sdi_executor_pool_t sdi_executor_pool = {
+    .once = PTHREAD_ONCE_INIT,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER
+};
+
+/**
+ * Takes the next item of the participant, stealing from the others when it has none.
+ *
+ * job[in] - job.
+ * slot[in] - slot of the participant.
+ * index[out] - index of the item.
+ *
+ * return true if an item was taken, false if no participant has any left.
+ */
+static bool sdi_executor_take(sdi_executor_job_t *job, uint_t slot, uint_t *index)
+{
+    sdi_executor_range_t *own = &job->ranges[slot];
+    sdi_executor_range_t *victim = NULL;
+    uint_t                head = 0;
+    uint_t                tail = 0;
+    uint_t                i = 0;
+
+    pthread_mutex_lock(&own->lock);
+    if (own->head < own->tail) {
+        *index = own->head++;
+        pthread_mutex_unlock(&own->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    for (i = 1; i < job->slots; i++) {
+        victim = &job->ranges[(slot + i) % job->slots];
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->head < victim->tail) {
+            /* The back half, a single remaining item is taken as well */
+            head = victim->head + (victim->tail - victim->head) / 2;
+            tail = victim->tail;
+            victim->tail = head;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (head < tail) {
+            pthread_mutex_lock(&own->lock);
+            own->head = head + 1;
+            own->tail = tail;
+            pthread_mutex_unlock(&own->lock);
+
+            *index = head;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Executes the items of the job until none is left.
+ *
+ * job[in] - job.
+ * slot[in] - slot of the participant.
+ *
+ * return None.
+ */
+static void sdi_executor_participate(sdi_executor_job_t *job, uint_t slot)
+{
+    uint_t      index = 0;
+    t_std_error rc = STD_ERR_OK;
+
+    while (sdi_executor_take(job, slot, &index)) {
+        if ((rc = (*job->fn)(index, job->data)) != STD_ERR_OK) {
+            pthread_mutex_lock(&sdi_executor_pool.lock);
+            if (index < job->err_index) {
+                job->err_index = index;
+                job->rc = rc;
+            }
+            pthread_mutex_unlock(&sdi_executor_pool.lock);
+        }
+    }
+}
+
+/**
+ * Worker thread, which joins the queued jobs.
+ *
+ * arg[in] - unused.
+ *
+ * return NULL.
+ */
+static void * sdi_executor_thread(void *arg)
+{
+    sdi_executor_job_t *job = NULL;
+    uint_t              slot = 0;
+
+    pthread_mutex_lock(&sdi_executor_pool.lock);
+
+    for (;;) {
+        for (job = sdi_executor_pool.head; (job != NULL) && (job->joined >= job->slots); job = job->next) {
+        }
+
+        if (job == NULL) {
+            pthread_cond_wait(&sdi_executor_pool.work, &sdi_executor_pool.lock);
+            continue;
+        }
+
+        slot = job->joined++;
+
+        pthread_mutex_unlock(&sdi_executor_pool.lock);
+
+        sdi_executor_participate(job, slot);
+
+        pthread_mutex_lock(&sdi_executor_pool.lock);
+
+        job->left++;
+        pthread_cond_broadcast(&sdi_executor_pool.done);
+    }
+
+    return NULL;
+}
+
+/**
+ * Starts the worker threads.
+ *
+ * return None.
+ */
+static void sdi_executor_init(void)
+{
+    pthread_attr_t attr;
+    pthread_t      thread;
+    uint_t         i = 0;
+    int            err = 0;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    for (i = 0; i < SDI_EXECUTOR_WORKERS; i++) {
+        if ((err = pthread_create(&thread, &attr, sdi_executor_thread, NULL)) != 0) {
+            SDI_ERRMSG_LOG("Failed to start executor worker (errno=%d)\n", err);
+        }
+    }
+
+    pthread_attr_destroy(&attr);
+}
+
+/**
+ * Calls the function for each item on up to concurrency threads and waits for all.
+ *
+ * count[in] - number of items.
+ * concurrency[in] - maximal number of threads executing the items, the caller included.
+ * fn[in] - operation executed for each item.
+ * data[in] - user data passed to the function.
+ *
+ * return STD_ERR_OK if the function succeeded for all the items, otherwise the error
+ * of the failed item with the lowest index.
+ */
+t_std_error sdi_executor_run(uint_t count, uint_t concurrency, sdi_executor_fn_t fn, void *data)
+{
+    sdi_executor_job_t  *job = NULL;
+    sdi_executor_job_t **prev = NULL;
+    t_std_error          rc = STD_ERR_OK;
+    t_std_error          item_rc = STD_ERR_OK;
+    uint_t               i = 0;
+
+    STD_ASSERT(fn != NULL);
+
+    if ((concurrency == 0) || (concurrency > SDI_EXECUTOR_WORKERS + 1)) {
+        concurrency = SDI_EXECUTOR_WORKERS + 1;
+    }
+    if (concurrency > count) {
+        concurrency = count;
+    }
+
+    if (concurrency <= 1) {
+        for (i = 0; i < count; i++) {
+            if (((item_rc = (*fn)(i, data)) != STD_ERR_OK) && (rc == STD_ERR_OK)) {
+                rc = item_rc;
+            }
+        }
+        return rc;
+    }
+
+    job = (sdi_executor_job_t*)calloc(1, sizeof(sdi_executor_job_t) + concurrency * sizeof(sdi_executor_range_t));
+    STD_ASSERT(job != NULL);
+
+    job->fn = fn;
+    job->data = data;
+    job->slots = concurrency;
+    job->joined = 1;
+    job->err_index = count;
+    for (i = 0; i < concurrency; i++) {
+        pthread_mutex_init(&job->ranges[i].lock, NULL);
+        job->ranges[i].head = (uint_t)(((uint64_t)count * i) / concurrency);
+        job->ranges[i].tail = (uint_t)(((uint64_t)count * (i + 1)) / concurrency);
+    }
+
+    pthread_once(&sdi_executor_pool.once, sdi_executor_init);
+
+    pthread_mutex_lock(&sdi_executor_pool.lock);
+    job->next = sdi_executor_pool.head;
+    sdi_executor_pool.head = job;
+    pthread_cond_broadcast(&sdi_executor_pool.work);
+    pthread_mutex_unlock(&sdi_executor_pool.lock);
+
+    sdi_executor_participate(job, 0);
+
+    pthread_mutex_lock(&sdi_executor_pool.lock);
+
+    /* Every item is taken, later workers would find nothing to do */
+    for (prev = &sdi_executor_pool.head; *prev != job; prev = &(*prev)->next) {
+    }
+    *prev = job->next;
+
+    job->left++;
+    while (job->left < job->joined) {
+        pthread_cond_wait(&sdi_executor_pool.done, &sdi_executor_pool.lock);
+    }
+
+    rc = (job->err_index < count) ? job->rc : STD_ERR_OK;
+
+    pthread_mutex_unlock(&sdi_executor_pool.lock);
+
+    for (i = 0; i < concurrency; i++) {
+        pthread_mutex_destroy(&job->ranges[i].lock);
+    }
+    free(job);
+
+    return rc;
+}
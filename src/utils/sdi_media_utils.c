@@ -10,6 +10,244 @@
  ***************************************************************************************/
 
 #include "sdi_media_utils.h"
+#include "sdi_sysfs_trace.h"
+#include <pthread.h>
+#include <stdio.h>
+
+/**
+ * @struct sdi_media_sxd_session_t
+ * Process-wide session of the SXD register access, shared by all MCIA accesses.
+ *
+ * It is opened on the first access rather than at registration, and reopened when an
+ * access fails for the lost SDK handle, which is what an SDK restart looks like from here. Accesses hold the
+ * lock for reading, opening and closing the session holds it for writing.
+ */
+typedef struct sdi_media_sxd_session_s {
+    pthread_rwlock_t        lock;       /**< protects the session */
+    sdi_sxd_session_state_t state;      /**< state of the session */
+    uint_t                  generation; /**< incremented each time the session is opened */
+    uint_t                  failures;   /**< number of failed opens */
+    uint_t                  reconnects; /**< number of times the session was closed to be reopened */
+} sdi_media_sxd_session_t;
+
+static sdi_media_sxd_session_t sdi_media_sxd_session = {
+    .lock = PTHREAD_RWLOCK_INITIALIZER,
+    .state = SDI_SXD_SESSION_CLOSED
+};
+
+/**
+ * Takes the SXD session for an access, opening it if needed.
+ *
+ * On success the session is held for reading until sdi_media_sxd_session_release().
+ *
+ * generation[out] - generation of the held session.
+ *
+ * return STD_ERR_OK on success and standard error if the session can't be opened.
+ */
+static t_std_error sdi_media_sxd_session_take(uint_t *generation)
+{
+    sxd_status_t status = SXD_STATUS_SUCCESS;
+
+    for (;;) {
+        pthread_rwlock_rdlock(&sdi_media_sxd_session.lock);
+        if (sdi_media_sxd_session.state == SDI_SXD_SESSION_OPEN) {
+            *generation = sdi_media_sxd_session.generation;
+            return STD_ERR_OK;
+        }
+        pthread_rwlock_unlock(&sdi_media_sxd_session.lock);
+
+        pthread_rwlock_wrlock(&sdi_media_sxd_session.lock);
+        if (sdi_media_sxd_session.state != SDI_SXD_SESSION_OPEN) {
+            if ((status = sxd_access_reg_init(0, NULL, SX_VERBOSITY_LEVEL_INFO)) == SXD_STATUS_SUCCESS) {
+                sdi_media_sxd_session.state = SDI_SXD_SESSION_OPEN;
+                sdi_media_sxd_session.generation++;
+            } else {
+                /* Not retried until the next access */
+                if (sdi_media_sxd_session.state != SDI_SXD_SESSION_FAILED) {
+                    SDI_ERRMSG_LOG("Failed to open SXD register access (status=%d)\n", status);
+                }
+                sdi_media_sxd_session.state = SDI_SXD_SESSION_FAILED;
+                sdi_media_sxd_session.failures++;
+                pthread_rwlock_unlock(&sdi_media_sxd_session.lock);
+                return SDI_ERRCODE(ENOTCONN); /* Transport endpoint is not connected */
+            }
+        }
+        pthread_rwlock_unlock(&sdi_media_sxd_session.lock);
+    }
+}
+
+/**
+ * Releases the SXD session held for an access.
+ *
+ * return None.
+ */
+static void sdi_media_sxd_session_release(void)
+{
+    pthread_rwlock_unlock(&sdi_media_sxd_session.lock);
+}
+
+/**
+ * Closes the SXD session after an access lost the SDK, the next access reopens it.
+ *
+ * Only the session the access failed on is closed, so threads failing together
+ * reconnect once.
+ *
+ * generation[in] - generation of the session the access failed on.
+ *
+ * return None.
+ */
+static void sdi_media_sxd_session_reset(uint_t generation)
+{
+    pthread_rwlock_wrlock(&sdi_media_sxd_session.lock);
+    if ((sdi_media_sxd_session.state == SDI_SXD_SESSION_OPEN) &&
+        (sdi_media_sxd_session.generation == generation)) {
+        sxd_access_reg_deinit();
+        sdi_media_sxd_session.state = SDI_SXD_SESSION_CLOSED;
+        sdi_media_sxd_session.reconnects++;
+    }
+    pthread_rwlock_unlock(&sdi_media_sxd_session.lock);
+}
+
+/**
+ * Checks whether the failed access lost the SDK rather than failed on the module.
+ *
+ * status[in] - result of the access.
+ *
+ * return true if the session has to be reopened.
+ */
+static bool sdi_media_sxd_transport_lost(sxd_status_t status)
+{
+    switch (status) {
+    case SXD_STATUS_DEVICE_OPEN_ERROR:
+    case SXD_STATUS_HANDLE_ERROR:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * Accesses the MCIA register on the shared SXD session.
+ *
+ * The session is reopened only when the access lost the SDK. A read is then retried
+ * once on the new session; a write isn't, as it may have reached the module already.
+ *
+ * reg[in,out] - MCIA structure of the access.
+ * reg_meta[in] - metadata of the access.
+ *
+ * return status of the access.
+ */
+static sxd_status_t sdi_media_mcia_access(struct ku_mcia_reg *reg, sxd_reg_meta_t *reg_meta)
+{
+    struct ku_mcia_reg request = *reg;
+    sxd_status_t       status = SXD_STATUS_ERROR;
+    uint_t             generation = 0;
+    uint_t             attempts = (reg_meta->access_cmd == SXD_ACCESS_CMD_GET) ? 2 : 1;
+    uint_t             attempt = 0;
+
+    for (attempt = 0; attempt < attempts; attempt++) {
+        if (sdi_media_sxd_session_take(&generation) != STD_ERR_OK) {
+            return SXD_STATUS_ERROR;
+        }
+
+        status = sxd_access_reg_mcia(reg, reg_meta, 1, NULL, NULL);
+        sdi_media_sxd_session_release();
+
+        if ((status == SXD_STATUS_SUCCESS) || !sdi_media_sxd_transport_lost(status)) {
+            break;
+        }
+
+        sdi_media_sxd_session_reset(generation);
+        *reg = request;
+    }
+
+    return status;
+}
+
+/**
+ * Retrieves the state of the shared SXD session.
+ *
+ * info[out] - state and counters of the session.
+ *
+ * return None.
+ */
+void sdi_media_sxd_session_get(sdi_sxd_session_info_t *info)
+{
+    STD_ASSERT(info != NULL);
+
+    pthread_rwlock_rdlock(&sdi_media_sxd_session.lock);
+    info->state = sdi_media_sxd_session.state;
+    info->opens = sdi_media_sxd_session.generation;
+    info->failures = sdi_media_sxd_session.failures;
+    info->reconnects = sdi_media_sxd_session.reconnects;
+    pthread_rwlock_unlock(&sdi_media_sxd_session.lock);
+}
+
+/**
+ * Formats the name of the MCIA register access for the trace.
+ *
+ * reg[in] - MCIA structure of the access.
+ * buf[out] - buffer for the name.
+ * size[in] - size of the buffer.
+ *
+ * return None.
+ */
+static void sdi_media_mcia_name(const struct ku_mcia_reg *reg, char *buf, size_t size)
+{
+    snprintf(buf, size, "mcia/%u/%x/%x/%x/%u", reg->module, reg->i2c_device_address, reg->page_number,
+             reg->device_address, reg->size);
+}
+
+/**
+ * Records the MCIA register access in the trace.
+ *
+ * start[in] - value returned by sdi_sysfs_trace_start(), 0 is ignored.
+ * op[in] - SDI_SYSFS_TRACE_REG_GET or SDI_SYSFS_TRACE_REG_SET.
+ * reg[in] - MCIA structure of the access.
+ * data[in] - data read or written, in the host byte order.
+ * status[in] - result of the access.
+ *
+ * return None.
+ */
+static void sdi_media_mcia_trace(uint64_t start, sdi_sysfs_trace_op_t op, const struct ku_mcia_reg *reg,
+                                 const void *data, sxd_status_t status)
+{
+    char name[SDI_MAX_NAME_LEN];
+
+    if (start == 0) {
+        return;
+    }
+
+    sdi_media_mcia_name(reg, name, sizeof(name));
+    sdi_sysfs_trace_record(start, op, name, "", data, (status == SXD_STATUS_SUCCESS) ? MCIA_DATA_BATCH_SIZE : 0,
+                           (status == SXD_STATUS_SUCCESS) ? STD_ERR_OK : SDI_ERRCODE(EIO));
+}
+
+/**
+ * Serves the MCIA register access from the replayed trace.
+ *
+ * op[in] - SDI_SYSFS_TRACE_REG_GET or SDI_SYSFS_TRACE_REG_SET.
+ * reg[in,out] - MCIA structure of the access, gets the recorded data of the read.
+ *
+ * return recorded result of the access.
+ */
+static sxd_status_t sdi_media_mcia_replay(sdi_sysfs_trace_op_t op, struct ku_mcia_reg *reg)
+{
+    char        name[SDI_MAX_NAME_LEN];
+    const void *data = NULL;
+    size_t      len = 0;
+    t_std_error rc = STD_ERR_OK;
+
+    sdi_media_mcia_name(reg, name, sizeof(name));
+    rc = sdi_sysfs_trace_replay(op, name, "", &data, &len);
+
+    if ((op == SDI_SYSFS_TRACE_REG_GET) && (len > 0)) {
+        memcpy((uint8_t*)&reg->dword_0, data, (len < MCIA_DATA_BATCH_SIZE) ? len : MCIA_DATA_BATCH_SIZE);
+    }
+
+    return (rc == STD_ERR_OK) ? SXD_STATUS_SUCCESS : SXD_STATUS_ERROR;
+}
 
 
 /**
@@ -33,6 +271,7 @@ static sxd_status_t sxd_mcia_reg_get(uint8_t             module_id,
 {
     sxd_reg_meta_t reg_meta;
     sxd_status_t   status = SXD_STATUS_SUCCESS;
+    uint64_t       trace = sdi_sysfs_trace_start();
 
     if (reg == NULL) {
         return SXD_STATUS_ERROR;
@@ -50,8 +289,13 @@ static sxd_status_t sxd_mcia_reg_get(uint8_t             module_id,
     reg->size = size;
     reg->module = module_id;
 
-    status = sxd_access_reg_mcia(reg, &reg_meta, 1, NULL, NULL);
+    if (sdi_sysfs_trace_replaying() == true) {
+        return sdi_media_mcia_replay(SDI_SYSFS_TRACE_REG_GET, reg);
+    }
+
+    status = sdi_media_mcia_access(reg, &reg_meta);
     if (status != SXD_STATUS_SUCCESS) {
+        sdi_media_mcia_trace(trace, SDI_SYSFS_TRACE_REG_GET, reg, NULL, status);
         SDI_ERRMSG_LOG("Failed read MCIA register (i2c_addr:%x page_number:%x offset:%x size:%d).",
                        i2c_adrr, page, addr, size);
         return status;
@@ -70,6 +314,8 @@ static sxd_status_t sxd_mcia_reg_get(uint8_t             module_id,
     reg->dword_10 = ntohl(reg->dword_10);
     reg->dword_11 = ntohl(reg->dword_11);
 
+    sdi_media_mcia_trace(trace, SDI_SYSFS_TRACE_REG_GET, reg, &reg->dword_0, status);
+
     return status;
 }
 
@@ -94,6 +340,8 @@ static sxd_status_t sxd_mcia_reg_set(uint8_t             module_id,
 {
     sxd_reg_meta_t reg_meta;
     sxd_status_t   status = SXD_STATUS_SUCCESS;
+    uint64_t       trace = sdi_sysfs_trace_start();
+    uint8_t        data[MCIA_DATA_BATCH_SIZE];
 
     if (reg == NULL) {
         return SXD_STATUS_ERROR;
@@ -110,6 +358,15 @@ static sxd_status_t sxd_mcia_reg_set(uint8_t             module_id,
     reg->size = size;
     reg->module = module_id;
 
+    if (sdi_sysfs_trace_replaying() == true) {
+        return sdi_media_mcia_replay(SDI_SYSFS_TRACE_REG_SET, reg);
+    }
+
+    /* The trace keeps the data in the host byte order */
+    if (trace != 0) {
+        memcpy(data, (uint8_t*)&reg->dword_0, sizeof(data));
+    }
+
     reg->dword_0 = htonl(reg->dword_0);
     reg->dword_1 = htonl(reg->dword_1);
     reg->dword_2 = htonl(reg->dword_2);
@@ -123,7 +380,8 @@ static sxd_status_t sxd_mcia_reg_set(uint8_t             module_id,
     reg->dword_10 = htonl(reg->dword_10);
     reg->dword_11 = htonl(reg->dword_11);
 
-    status = sxd_access_reg_mcia(reg, &reg_meta, 1, NULL, NULL);
+    status = sdi_media_mcia_access(reg, &reg_meta);
+    sdi_media_mcia_trace(trace, SDI_SYSFS_TRACE_REG_SET, reg, data, status);
     if (status != SXD_STATUS_SUCCESS) {
         SDI_ERRMSG_LOG("Failed read MCIA register (i2c_addr:%x page_number:%x offset:%x size:%d).",
                        i2c_adrr, page, addr, size);
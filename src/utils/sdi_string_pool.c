@@ -0,0 +1,173 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/**************************************************************************************
+ * Process-wide pool of interned strings.
+ *
+ * Names of entities and resources, the values matched against SysFs attributes and
+ * the paths of the attributes are stored once and referenced by pointer, instead of
+ * a NAME_MAX buffer in every structure. Strings are packed into chunks and never
+ * freed, as the structures referencing them live as long as the process.
+ ***************************************************************************************/
+
+#include "sdi_common.h"
+#include "sdi_string_pool.h"
+#include <pthread.h>
+
+#define SDI_STRING_POOL_BUCKETS 256  /**< number of buckets of the index, power of 2 */
+#define SDI_STRING_POOL_CHUNK   4096 /**< size of a chunk the strings are packed into */
+
+/**
+ * @struct sdi_string_entry_t
+ * Interned string.
+ */
+typedef struct sdi_string_entry_s {
+    struct sdi_string_entry_s *next; /**< next string in the same bucket */
+    uint32_t                   hash; /**< hash of the string */
+    char                       str[]; /**< the string */
+} sdi_string_entry_t;
+
+/**
+ * @struct sdi_string_pool_t
+ * Used to hold the interned strings.
+ */
+typedef struct sdi_string_pool_s {
+    pthread_mutex_t          lock;                             /**< protects the pool */
+    sdi_string_entry_t      *buckets[SDI_STRING_POOL_BUCKETS]; /**< strings by their hash */
+    char                    *chunk;                            /**< chunk the next string is packed into */
+    size_t                   chunk_left;                       /**< free bytes of the chunk */
+    sdi_string_pool_usage_t  usage;                            /**< memory used by the pool */
+} sdi_string_pool_t;
+
+static sdi_string_pool_t sdi_string_pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+/**
+ * Calculates the hash of the string.
+ *
+ * str[in] - string to hash.
+ * len[out] - length of the string.
+ *
+ * return hash of the string.
+ */
+static uint32_t sdi_string_hash(const char *str, size_t *len)
+{
+    uint32_t    hash = 2166136261u;
+    const char *cur = str;
+
+    /* FNV-1a */
+    while (*cur != '\0') {
+        hash = (hash ^ (uint8_t)*cur++) * 16777619u;
+    }
+
+    *len = cur - str;
+
+    return hash;
+}
+
+/**
+ * Allocates an entry from the current chunk, starting a new chunk if it is full.
+ *
+ * Must be called with the pool locked.
+ *
+ * size[in] - size of the entry.
+ *
+ * return the entry.
+ */
+static sdi_string_entry_t * sdi_string_entry_alloc(size_t size)
+{
+    sdi_string_entry_t *entry = NULL;
+
+    /* Keep the next entry aligned */
+    size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    if (size > SDI_STRING_POOL_CHUNK / 4) {
+        entry = (sdi_string_entry_t*)malloc(size);
+        STD_ASSERT(entry != NULL);
+        sdi_string_pool.usage.allocated += size;
+
+        return entry;
+    }
+
+    if (size > sdi_string_pool.chunk_left) {
+        sdi_string_pool.chunk = (char*)malloc(SDI_STRING_POOL_CHUNK);
+        STD_ASSERT(sdi_string_pool.chunk != NULL);
+        sdi_string_pool.chunk_left = SDI_STRING_POOL_CHUNK;
+        sdi_string_pool.usage.allocated += SDI_STRING_POOL_CHUNK;
+    }
+
+    entry = (sdi_string_entry_t*)sdi_string_pool.chunk;
+    sdi_string_pool.chunk += size;
+    sdi_string_pool.chunk_left -= size;
+
+    return entry;
+}
+
+/**
+ * Returns the interned copy of the string.
+ *
+ * str[in] - string to intern.
+ *
+ * return interned copy of the string, valid for the life of the process.
+ */
+const char * sdi_string_intern(const char *str)
+{
+    sdi_string_entry_t **bucket = NULL;
+    sdi_string_entry_t  *entry = NULL;
+    size_t               len = 0;
+    uint32_t             hash = 0;
+
+    STD_ASSERT(str != NULL);
+
+    hash = sdi_string_hash(str, &len);
+    bucket = &sdi_string_pool.buckets[hash & (SDI_STRING_POOL_BUCKETS - 1)];
+
+    pthread_mutex_lock(&sdi_string_pool.lock);
+
+    sdi_string_pool.usage.requests++;
+
+    for (entry = *bucket; entry != NULL; entry = entry->next) {
+        if ((entry->hash == hash) && (strcmp(entry->str, str) == 0)) {
+            sdi_string_pool.usage.saved += len + 1;
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        entry = sdi_string_entry_alloc(sizeof(*entry) + len + 1);
+        entry->hash = hash;
+        memcpy(entry->str, str, len + 1);
+        entry->next = *bucket;
+        *bucket = entry;
+
+        sdi_string_pool.usage.strings++;
+        sdi_string_pool.usage.bytes += len + 1;
+    }
+
+    pthread_mutex_unlock(&sdi_string_pool.lock);
+
+    return entry->str;
+}
+
+/**
+ * Reports the memory used by the pool.
+ *
+ * usage[out] - memory used by the pool.
+ *
+ * return None.
+ */
+void sdi_string_pool_usage_get(sdi_string_pool_usage_t *usage)
+{
+    STD_ASSERT(usage != NULL);
+
+    pthread_mutex_lock(&sdi_string_pool.lock);
+    *usage = sdi_string_pool.usage;
+    pthread_mutex_unlock(&sdi_string_pool.lock);
+
+    usage->allocated += sizeof(sdi_string_pool.buckets);
+}
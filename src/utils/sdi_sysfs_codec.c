@@ -0,0 +1,278 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/**************************************************************************************
+ * Parsers and formatters of SysFs attribute values.
+ *
+ * Values are handled in bounded buffers without stdio, so reading an attribute doesn't
+ * touch FILE* or locale machinery.
+ ***************************************************************************************/
+
+#include "sdi_common.h"
+#include "sdi_sysfs_codec.h"
+#include <limits.h>
+
+#define SDI_SYSFS_CODEC_DIGITS_MAX 11 /**< maximum length of a formatted 32-bit integer, sign included */
+
+/**
+ * Checks whether the character is a whitespace.
+ *
+ * c[in] - character to check.
+ *
+ * return true if the character is a whitespace.
+ */
+static inline bool sdi_sysfs_codec_is_space(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+/**
+ * Checks whether the character is a decimal digit.
+ *
+ * c[in] - character to check.
+ *
+ * return true if the character is a digit.
+ */
+static inline bool sdi_sysfs_codec_is_digit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+/**
+ * Parses the sign and magnitude of decimal value.
+ *
+ * buf[in] - raw value.
+ * size[in] - maximum number of characters to look at.
+ * limit[in] - maximum allowed magnitude.
+ * negative[out] - true if the value has a minus sign.
+ * magnitude[out] - absolute value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_codec_dec_parse(const char *buf, size_t size, uint64_t limit,
+                                             bool *negative, uint64_t *magnitude)
+{
+    size_t   i = 0;
+    size_t   digits = 0;
+    uint64_t res = 0;
+
+    while ((i < size) && sdi_sysfs_codec_is_space(buf[i])) {
+        i++;
+    }
+
+    *negative = false;
+    if ((i < size) && ((buf[i] == '-') || (buf[i] == '+'))) {
+        *negative = (buf[i] == '-');
+        i++;
+    }
+
+    for (; (i < size) && sdi_sysfs_codec_is_digit(buf[i]); i++, digits++) {
+        res = res * 10 + (uint64_t)(buf[i] - '0');
+        if (res > limit) {
+            return SDI_ERRCODE(ERANGE); /* Result too large */
+        }
+    }
+
+    if (digits == 0) {
+        return SDI_ERRCODE(EIO); /* I/O error */
+    }
+
+    *magnitude = res;
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Parses the unsigned decimal value of SysFs attribute.
+ *
+ * buf[in] - raw value read from the attribute.
+ * size[in] - maximum number of characters to look at.
+ * val[out] - parsed value.
+ *
+ * return STD_ERR_OK on success, EIO if there are no digits and ERANGE on overflow.
+ */
+t_std_error sdi_sysfs_codec_uint_parse(const char *buf, size_t size, uint_t *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    bool        negative = false;
+    uint64_t    magnitude = 0;
+
+    STD_ASSERT(buf != NULL);
+    STD_ASSERT(val != NULL);
+
+    if ((rc = sdi_sysfs_codec_dec_parse(buf, size, UINT_MAX, &negative, &magnitude)) != STD_ERR_OK) {
+        return rc;
+    }
+
+    if (negative && (magnitude != 0)) {
+        return SDI_ERRCODE(ERANGE); /* Result too large */
+    }
+
+    *val = (uint_t)magnitude;
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Parses the signed decimal value of SysFs attribute.
+ *
+ * buf[in] - raw value read from the attribute.
+ * size[in] - maximum number of characters to look at.
+ * val[out] - parsed value.
+ *
+ * return STD_ERR_OK on success, EIO if there are no digits and ERANGE on overflow.
+ */
+t_std_error sdi_sysfs_codec_int_parse(const char *buf, size_t size, int *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    bool        negative = false;
+    uint64_t    magnitude = 0;
+
+    STD_ASSERT(buf != NULL);
+    STD_ASSERT(val != NULL);
+
+    if ((rc = sdi_sysfs_codec_dec_parse(buf, size, (uint64_t)INT_MAX + 1, &negative, &magnitude)) != STD_ERR_OK) {
+        return rc;
+    }
+
+    if (negative) {
+        *val = (int)(-(int64_t)magnitude);
+    } else if (magnitude <= INT_MAX) {
+        *val = (int)magnitude;
+    } else {
+        return SDI_ERRCODE(ERANGE); /* Result too large */
+    }
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Parses the temperature in millidegrees and converts it to degrees (Celsius).
+ *
+ * buf[in] - raw value read from the attribute.
+ * size[in] - maximum number of characters to look at.
+ * val[out] - temperature in degrees.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_codec_mdeg_parse(const char *buf, size_t size, int *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    int         mdeg = 0;
+
+    if ((rc = sdi_sysfs_codec_int_parse(buf, size, &mdeg)) == STD_ERR_OK) {
+        *val = mdeg / SDI_SYSFS_MDEG_DIVIDER;
+    }
+
+    return rc;
+}
+
+/**
+ * Extracts the first word of the string value of SysFs attribute.
+ *
+ * buf[in] - raw value read from the attribute.
+ * size[in] - maximum number of characters to look at.
+ * val[out] - NUL-terminated word, empty if the value is blank.
+ * val_size[in] - size of the val buffer.
+ *
+ * return STD_ERR_OK on success, ENOBUFS if the word doesn't fit into val.
+ */
+t_std_error sdi_sysfs_codec_str_parse(const char *buf, size_t size, char *val, size_t val_size)
+{
+    size_t i = 0;
+    size_t len = 0;
+
+    STD_ASSERT(buf != NULL);
+    STD_ASSERT(val != NULL);
+    STD_ASSERT(val_size > 0);
+
+    while ((i < size) && sdi_sysfs_codec_is_space(buf[i])) {
+        i++;
+    }
+
+    for (; (i < size) && (buf[i] != '\0') && !sdi_sysfs_codec_is_space(buf[i]); i++) {
+        if (len == val_size - 1) {
+            val[len] = '\0';
+            return SDI_ERRCODE(ENOBUFS); /* No buffer space available */
+        }
+        val[len++] = buf[i];
+    }
+
+    val[len] = '\0';
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Formats the decimal value from its sign and magnitude.
+ *
+ * negative[in] - true if the value has a minus sign.
+ * magnitude[in] - absolute value.
+ * buf[out] - buffer for the formatted value, NUL-terminated.
+ * size[in] - size of the buffer.
+ *
+ * return length of the formatted value, 0 if it doesn't fit into the buffer.
+ */
+static size_t sdi_sysfs_codec_dec_format(bool negative, uint64_t magnitude, char *buf, size_t size)
+{
+    char   digits[SDI_SYSFS_CODEC_DIGITS_MAX] = {0};
+    size_t count = 0;
+    size_t len = 0;
+
+    do {
+        digits[count++] = (char)('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if ((count + (negative ? 1 : 0)) >= size) {
+        return 0;
+    }
+
+    if (negative) {
+        buf[len++] = '-';
+    }
+
+    while (count > 0) {
+        buf[len++] = digits[--count];
+    }
+
+    buf[len] = '\0';
+
+    return len;
+}
+
+/**
+ * Formats the unsigned decimal value for writing to SysFs attribute.
+ *
+ * val[in] - value to format.
+ * buf[out] - buffer for the formatted value, NUL-terminated.
+ * size[in] - size of the buffer.
+ *
+ * return length of the formatted value, 0 if it doesn't fit into the buffer.
+ */
+size_t sdi_sysfs_codec_uint_format(uint_t val, char *buf, size_t size)
+{
+    STD_ASSERT(buf != NULL);
+
+    return sdi_sysfs_codec_dec_format(false, val, buf, size);
+}
+
+/**
+ * Formats the signed decimal value for writing to SysFs attribute.
+ *
+ * val[in] - value to format.
+ * buf[out] - buffer for the formatted value, NUL-terminated.
+ * size[in] - size of the buffer.
+ *
+ * return length of the formatted value, 0 if it doesn't fit into the buffer.
+ */
+size_t sdi_sysfs_codec_int_format(int val, char *buf, size_t size)
+{
+    STD_ASSERT(buf != NULL);
+
+    return sdi_sysfs_codec_dec_format(val < 0, (val < 0) ? -(int64_t)val : (int64_t)val, buf, size);
+}
@@ -0,0 +1,462 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/**************************************************************************************
+ * Call counts and latency histograms of SysFs attribute accesses.
+ *
+ * Every thread counts into its own table, so recording takes no locks. Tables are
+ * merged when the statistics are read. A table is kept when its thread exits and is
+ * handed over to the next new thread, so nothing counted is lost.
+ ***************************************************************************************/
+
+#include "sdi_common.h"
+#include "sdi_sysfs_stats.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <time.h>
+
+#define SDI_SYSFS_STATS_SLOTS 256 /**< number of attributes counted by one thread, power of 2 */
+
+/**
+ * @struct sdi_sysfs_stats_slot_t
+ * Counters of one attribute in the table of one thread.
+ *
+ * Only the owning thread writes the counters, readers merge them with relaxed loads.
+ */
+typedef struct sdi_sysfs_stats_slot_s {
+    uint32_t    hash;                          /**< hash of the attribute path, 0 if the slot is free */
+    const char *name;                          /**< joined path and name of the attribute */
+    uint64_t    calls;                         /**< number of accesses */
+    uint64_t    errors;                        /**< number of failed accesses */
+    uint64_t    hist[SDI_SYSFS_STATS_BUCKETS]; /**< latency histogram */
+} sdi_sysfs_stats_slot_t;
+
+/**
+ * @struct sdi_sysfs_stats_table_t
+ * Counters of one thread, an open addressing hash table keyed by the attribute name.
+ */
+typedef struct sdi_sysfs_stats_table_s {
+    struct sdi_sysfs_stats_table_s *next;    /**< next table */
+    bool                            in_use;  /**< whether the table is owned by a running thread */
+    uint64_t                        dropped; /**< accesses not counted, because the table was full */
+    sdi_sysfs_stats_slot_t          slots[SDI_SYSFS_STATS_SLOTS]; /**< counters of the attributes */
+} sdi_sysfs_stats_table_t;
+
+/**
+ * @struct sdi_sysfs_stats_name_t
+ * Name of the attribute shared by the tables of all the threads.
+ */
+typedef struct sdi_sysfs_stats_name_s {
+    struct sdi_sysfs_stats_name_s *next; /**< next name */
+    uint32_t                       hash; /**< hash of the attribute path */
+    char                          *name; /**< joined path and name of the attribute */
+} sdi_sysfs_stats_name_t;
+
+/**
+ * @struct sdi_sysfs_stats_state_t
+ * Used to hold the tables of all the threads.
+ */
+typedef struct sdi_sysfs_stats_state_s {
+    pthread_mutex_t          lock;    /**< protects the lists and the ownership of the tables */
+    pthread_once_t           once;    /**< creates the thread key */
+    pthread_key_t            key;     /**< releases the table when its thread exits */
+    bool                     enabled; /**< whether the accesses are counted */
+    sdi_sysfs_stats_table_t *tables;  /**< tables of all the threads */
+    sdi_sysfs_stats_name_t  *names;   /**< names of all the counted attributes */
+    uint_t                   count;   /**< number of names */
+} sdi_sysfs_stats_state_t;
+
+static sdi_sysfs_stats_state_t sdi_sysfs_stats = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .once = PTHREAD_ONCE_INIT
+};
+
+static __thread sdi_sysfs_stats_table_t *sdi_sysfs_stats_table;
+
+/**
+ * Returns monotonic time in nanoseconds.
+ *
+ * return monotonic time in nanoseconds.
+ */
+static uint64_t sdi_sysfs_stats_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/**
+ * Increments the counter, which is read concurrently by the other threads.
+ *
+ * cnt[in,out] - counter owned by the calling thread.
+ *
+ * return None.
+ */
+static void sdi_sysfs_stats_inc(uint64_t *cnt)
+{
+    __atomic_store_n(cnt, *cnt + 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Hands the table of the exiting thread over to the next new thread.
+ *
+ * arg[in] - table of the exiting thread.
+ *
+ * return None.
+ */
+static void sdi_sysfs_stats_table_release(void *arg)
+{
+    pthread_mutex_lock(&sdi_sysfs_stats.lock);
+    ((sdi_sysfs_stats_table_t*)arg)->in_use = false;
+    pthread_mutex_unlock(&sdi_sysfs_stats.lock);
+}
+
+/**
+ * Creates the key, which releases the tables of the exiting threads.
+ *
+ * return None.
+ */
+static void sdi_sysfs_stats_key_create(void)
+{
+    int err = pthread_key_create(&sdi_sysfs_stats.key, sdi_sysfs_stats_table_release);
+
+    STD_ASSERT(err == 0);
+}
+
+/**
+ * Assigns a table to the calling thread, the one released by an exited thread if any.
+ *
+ * return table of the calling thread.
+ */
+static sdi_sysfs_stats_table_t * sdi_sysfs_stats_table_get(void)
+{
+    sdi_sysfs_stats_table_t *table = NULL;
+
+    pthread_once(&sdi_sysfs_stats.once, sdi_sysfs_stats_key_create);
+
+    pthread_mutex_lock(&sdi_sysfs_stats.lock);
+
+    table = sdi_sysfs_stats.tables;
+    while ((table != NULL) && (table->in_use == true)) {
+        table = table->next;
+    }
+
+    if (table == NULL) {
+        table = (sdi_sysfs_stats_table_t*)calloc(1, sizeof(*table));
+        STD_ASSERT(table != NULL);
+
+        table->next = sdi_sysfs_stats.tables;
+        sdi_sysfs_stats.tables = table;
+    }
+
+    table->in_use = true;
+
+    pthread_mutex_unlock(&sdi_sysfs_stats.lock);
+
+    pthread_setspecific(sdi_sysfs_stats.key, table);
+    sdi_sysfs_stats_table = table;
+
+    return table;
+}
+
+/**
+ * Checks whether the joined name is the one of the attribute.
+ *
+ * name[in] - joined path and name of an attribute.
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ *
+ * return true if the name is the one of the attribute.
+ */
+static bool sdi_sysfs_stats_name_match(const char *name, const char *path, const char *attr)
+{
+    size_t len = strlen(path);
+
+    return ((strncmp(name, path, len) == 0) && (strcmp(name + len, attr) == 0));
+}
+
+/**
+ * Returns the shared name of the attribute, registering it if it is seen for the first time.
+ *
+ * hash[in] - hash of the attribute path.
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ *
+ * return joined path and name of the attribute.
+ */
+static const char * sdi_sysfs_stats_name_get(uint32_t hash, const char *path, const char *attr)
+{
+    sdi_sysfs_stats_name_t *name = NULL;
+    size_t                  len = 0;
+
+    pthread_mutex_lock(&sdi_sysfs_stats.lock);
+
+    name = sdi_sysfs_stats.names;
+    while ((name != NULL) &&
+           ((name->hash != hash) || !sdi_sysfs_stats_name_match(name->name, path, attr))) {
+        name = name->next;
+    }
+
+    if (name == NULL) {
+        name = (sdi_sysfs_stats_name_t*)calloc(1, sizeof(*name));
+        STD_ASSERT(name != NULL);
+
+        len = strlen(path) + strlen(attr) + 1;
+        name->name = (char*)malloc(len);
+        STD_ASSERT(name->name != NULL);
+
+        snprintf(name->name, len, "%s%s", path, attr);
+        name->hash = hash;
+        name->next = sdi_sysfs_stats.names;
+        sdi_sysfs_stats.names = name;
+        sdi_sysfs_stats.count++;
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_stats.lock);
+
+    return name->name;
+}
+
+/**
+ * Finds the slot of the attribute in the table.
+ *
+ * Attributes whose hashes collide share the probe sequence, the slot is told by its name.
+ *
+ * table[in] - table of a thread.
+ * hash[in] - hash of the attribute path, not 0.
+ * name[in] - shared name of the attribute, as returned by sdi_sysfs_stats_name_get().
+ *
+ * return slot of the attribute, NULL if the table doesn't have it.
+ */
+static sdi_sysfs_stats_slot_t * sdi_sysfs_stats_slot_find(sdi_sysfs_stats_table_t *table, uint32_t hash,
+                                                          const char *name)
+{
+    uint32_t slot_hash = 0;
+    uint_t   idx = hash & (SDI_SYSFS_STATS_SLOTS - 1);
+    uint_t   n = 0;
+
+    for (n = 0; n < SDI_SYSFS_STATS_SLOTS; n++, idx = (idx + 1) & (SDI_SYSFS_STATS_SLOTS - 1)) {
+        slot_hash = __atomic_load_n(&table->slots[idx].hash, __ATOMIC_ACQUIRE);
+        if ((slot_hash == hash) && (table->slots[idx].name == name)) {
+            return &table->slots[idx];
+        }
+        if (slot_hash == 0) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Enables or disables collection of the statistics.
+ *
+ * enable[in] - true to enable collection.
+ *
+ * return None.
+ */
+void sdi_sysfs_stats_enable(bool enable)
+{
+    __atomic_store_n(&sdi_sysfs_stats.enabled, enable, __ATOMIC_RELAXED);
+}
+
+/**
+ * Starts measuring an access to SysFs attribute.
+ *
+ * return start time to pass to sdi_sysfs_stats_record(), 0 if collection is disabled.
+ */
+uint64_t sdi_sysfs_stats_start(void)
+{
+    if (__atomic_load_n(&sdi_sysfs_stats.enabled, __ATOMIC_RELAXED) == false) {
+        return 0;
+    }
+
+    return sdi_sysfs_stats_time_ns();
+}
+
+/**
+ * Records an access to SysFs attribute in the counters of the calling thread.
+ *
+ * start[in] - value returned by sdi_sysfs_stats_start(), 0 is ignored.
+ * hash[in] - hash of the joined path of the attribute.
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * rc[in] - result of the access.
+ *
+ * return None.
+ */
+void sdi_sysfs_stats_record(uint64_t start, uint32_t hash, const char *path, const char *attr,
+                            t_std_error rc)
+{
+    sdi_sysfs_stats_table_t *table = sdi_sysfs_stats_table;
+    sdi_sysfs_stats_slot_t  *slot = NULL;
+    uint64_t                 elapsed_us = 0;
+    uint_t                   idx = 0;
+    uint_t                   n = 0;
+    uint_t                   bucket = 0;
+
+    if (start == 0) {
+        return;
+    }
+
+    elapsed_us = (sdi_sysfs_stats_time_ns() - start) / 1000;
+
+    if (table == NULL) {
+        table = sdi_sysfs_stats_table_get();
+    }
+
+    /* Zero marks the free slot */
+    if (hash == 0) {
+        hash = 1;
+    }
+
+    idx = hash & (SDI_SYSFS_STATS_SLOTS - 1);
+    for (n = 0; n < SDI_SYSFS_STATS_SLOTS; n++, idx = (idx + 1) & (SDI_SYSFS_STATS_SLOTS - 1)) {
+        slot = &table->slots[idx];
+        if ((slot->hash == hash) && sdi_sysfs_stats_name_match(slot->name, path, attr)) {
+            break;
+        }
+        if (slot->hash == 0) {
+            /* Name has to be visible before the slot is found by the readers */
+            slot->name = sdi_sysfs_stats_name_get(hash, path, attr);
+            __atomic_store_n(&slot->hash, hash, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+
+    if (n == SDI_SYSFS_STATS_SLOTS) {
+        sdi_sysfs_stats_inc(&table->dropped);
+        return;
+    }
+
+    bucket = (elapsed_us == 0) ? 0 : (64 - __builtin_clzll(elapsed_us));
+    if (bucket >= SDI_SYSFS_STATS_BUCKETS) {
+        bucket = SDI_SYSFS_STATS_BUCKETS - 1;
+    }
+
+    sdi_sysfs_stats_inc(&slot->calls);
+    sdi_sysfs_stats_inc(&slot->hist[bucket]);
+    if (rc != STD_ERR_OK) {
+        sdi_sysfs_stats_inc(&slot->errors);
+    }
+}
+
+/**
+ * Merges the counters of all the threads and calls the function for each attribute.
+ *
+ * fn[in] - function called for each accessed attribute.
+ * data[in] - user data passed to the function.
+ *
+ * return None.
+ */
+void sdi_sysfs_stats_walk(void (*fn)(const sdi_sysfs_stats_t *stats, void *data), void *data)
+{
+    sdi_sysfs_stats_t       *stats = NULL;
+    sdi_sysfs_stats_name_t  *name = NULL;
+    sdi_sysfs_stats_table_t *table = NULL;
+    sdi_sysfs_stats_slot_t  *slot = NULL;
+    uint_t                   count = 0;
+    uint_t                   i = 0;
+    uint_t                   bucket = 0;
+
+    STD_ASSERT(fn != NULL);
+
+    pthread_mutex_lock(&sdi_sysfs_stats.lock);
+
+    if (sdi_sysfs_stats.count > 0) {
+        stats = (sdi_sysfs_stats_t*)calloc(sdi_sysfs_stats.count, sizeof(*stats));
+        STD_ASSERT(stats != NULL);
+    }
+
+    for (name = sdi_sysfs_stats.names; (name != NULL); name = name->next, count++) {
+        stats[count].name = name->name;
+
+        for (table = sdi_sysfs_stats.tables; (table != NULL); table = table->next) {
+            if ((slot = sdi_sysfs_stats_slot_find(table, name->hash, name->name)) == NULL) {
+                continue;
+            }
+
+            stats[count].calls += __atomic_load_n(&slot->calls, __ATOMIC_RELAXED);
+            stats[count].errors += __atomic_load_n(&slot->errors, __ATOMIC_RELAXED);
+            for (bucket = 0; bucket < SDI_SYSFS_STATS_BUCKETS; bucket++) {
+                stats[count].hist[bucket] += __atomic_load_n(&slot->hist[bucket], __ATOMIC_RELAXED);
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_stats.lock);
+
+    /* Names are never freed, so they stay valid without the lock */
+    for (i = 0; i < count; i++) {
+        (*fn)(&stats[i], data);
+    }
+
+    free(stats);
+}
+
+/**
+ * Writes the statistics of one attribute as a line of text.
+ *
+ * stats[in] - merged statistics of the attribute.
+ * data[in] - pointer to the descriptor to write to.
+ *
+ * return None.
+ */
+static void sdi_sysfs_stats_line_dump(const sdi_sysfs_stats_t *stats, void *data)
+{
+    char   line[1024];
+    size_t len = 0;
+    uint_t bucket = 0;
+
+    len = snprintf(line, sizeof(line), "%s calls=%" PRIu64 " errors=%" PRIu64 " us:",
+                   stats->name, stats->calls, stats->errors);
+
+    for (bucket = 0; (bucket < SDI_SYSFS_STATS_BUCKETS) && (len < sizeof(line)); bucket++) {
+        if (stats->hist[bucket] == 0) {
+            continue;
+        }
+
+        if (bucket == SDI_SYSFS_STATS_BUCKETS - 1) {
+            len += snprintf(line + len, sizeof(line) - len, " >=%u:%" PRIu64,
+                            1u << (bucket - 1), stats->hist[bucket]);
+        } else {
+            len += snprintf(line + len, sizeof(line) - len, " <%u:%" PRIu64,
+                            1u << bucket, stats->hist[bucket]);
+        }
+    }
+
+    dprintf(*(int*)data, "%.*s\n", (int)sizeof(line), line);
+}
+
+/**
+ * Writes the merged statistics as text, one attribute per line.
+ *
+ * fd[in] - descriptor to write to.
+ *
+ * return None.
+ */
+void sdi_sysfs_stats_dump(int fd)
+{
+    sdi_sysfs_stats_table_t *table = NULL;
+    uint64_t                 dropped = 0;
+
+    sdi_sysfs_stats_walk(sdi_sysfs_stats_line_dump, &fd);
+
+    pthread_mutex_lock(&sdi_sysfs_stats.lock);
+    for (table = sdi_sysfs_stats.tables; (table != NULL); table = table->next) {
+        dropped += __atomic_load_n(&table->dropped, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&sdi_sysfs_stats.lock);
+
+    if (dropped > 0) {
+        dprintf(fd, "not counted (too many attributes) calls=%" PRIu64 "\n", dropped);
+    }
+}
@@ -0,0 +1,620 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/**************************************************************************************
+ * Recording and replay of the hardware accesses.
+ *
+ * While recording, every SysFs access and register access is appended to a binary
+ * trace with its time, latency, result and data. While replaying, the same accesses
+ * are served from a trace loaded into memory, so the access pattern of a box can be
+ * reproduced without its hardware.
+ ***************************************************************************************/
+
+#include "sdi_common.h"
+#include "sdi_sysfs_utils.h"
+#include "sdi_sysfs_trace.h"
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+
+#define SDI_SYSFS_TRACE_BUCKETS  1024 /**< number of buckets of the name table, power of 2 */
+#define SDI_SYSFS_TRACE_HDR_LEN  16   /**< length of the file header */
+#define SDI_SYSFS_TRACE_NAME_LEN 7    /**< length of a name record without the name */
+#define SDI_SYSFS_TRACE_REC_LEN  25   /**< length of an access record without the data */
+
+/**
+ * @defgroup sdi_sysfs_trace_mode_t
+ * List of the trace modes.
+ */
+typedef enum {
+    SDI_SYSFS_TRACE_OFF,    /**< accesses go to the hardware and aren't recorded */
+    SDI_SYSFS_TRACE_RECORD, /**< accesses go to the hardware and are recorded */
+    SDI_SYSFS_TRACE_REPLAY  /**< accesses are served from the trace */
+} sdi_sysfs_trace_mode_t;
+
+/**
+ * @struct sdi_sysfs_trace_rec_t
+ * Recorded access served by the replay.
+ */
+typedef struct sdi_sysfs_trace_rec_s {
+    uint32_t       lat_ns; /**< recorded latency */
+    t_std_error    rc;     /**< recorded result */
+    uint32_t       len;    /**< length of the recorded data */
+    const uint8_t *data;   /**< recorded data, points into the loaded trace */
+} sdi_sysfs_trace_rec_t;
+
+/**
+ * @struct sdi_sysfs_trace_name_t
+ * Accessed name, an attribute path or a register.
+ *
+ * Recorded accesses are kept separately for reads (index 0) and writes (index 1).
+ */
+typedef struct sdi_sysfs_trace_name_s {
+    struct sdi_sysfs_trace_name_s *next;      /**< next name in the bucket */
+    uint32_t                       hash;      /**< hash of the name */
+    uint32_t                       id;        /**< ID of the name in the trace */
+    char                          *name;      /**< name */
+    sdi_sysfs_trace_rec_t         *recs[2];   /**< recorded accesses, replay only */
+    uint32_t                       count[2];  /**< number of recorded accesses */
+    uint32_t                       cursor[2]; /**< next access to replay */
+} sdi_sysfs_trace_name_t;
+
+/**
+ * @struct sdi_sysfs_trace_state_t
+ * Used to hold the recorded or replayed trace.
+ */
+typedef struct sdi_sysfs_trace_state_s {
+    pthread_mutex_t          lock;     /**< protects the state */
+    sdi_sysfs_trace_mode_t   mode;     /**< current mode, read without the lock */
+    bool                     timed;    /**< whether the replay reproduces the latencies */
+    FILE                    *file;     /**< recorded trace */
+    uint64_t                 start_ns; /**< time of the start of the recording */
+    uint32_t                 count;    /**< number of names */
+    sdi_sysfs_trace_name_t **ids;      /**< names by ID, replay only */
+    uint8_t                 *data;     /**< contents of the replayed trace */
+    sdi_sysfs_trace_name_t  *buckets[SDI_SYSFS_TRACE_BUCKETS]; /**< names by hash */
+} sdi_sysfs_trace_state_t;
+
+static sdi_sysfs_trace_state_t sdi_sysfs_trace = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+/**
+ * Returns monotonic time in nanoseconds.
+ *
+ * return monotonic time in nanoseconds.
+ */
+static uint64_t sdi_sysfs_trace_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/**
+ * Calculates hash of the name (FNV-1a).
+ *
+ * name[in] - accessed name.
+ *
+ * return hash of the name.
+ */
+static uint32_t sdi_sysfs_trace_hash(const char *name)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*name != '\0') {
+        hash = (hash ^ (uint8_t)*name++) * 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * Joins the path and the name of the attribute, without the SysFs root.
+ *
+ * A trace recorded on a relocated tree is thus replayable on the real one and back.
+ *
+ * path[in] - path to SysFs attribute or name of the register.
+ * attr[in] - name of SysFs attribute.
+ * buf[out] - buffer for the joined name.
+ * size[in] - size of the buffer.
+ *
+ * return hash of the joined name.
+ */
+static uint32_t sdi_sysfs_trace_name_join(const char *path, const char *attr, char *buf, size_t size)
+{
+    const char *root = sdi_sysfs_root_get();
+    size_t      root_len = strlen(root);
+
+    if ((root_len > 0) && (strncmp(path, root, root_len) == 0)) {
+        path += root_len;
+    }
+
+    snprintf(buf, size, "%s%s", path, attr);
+
+    return sdi_sysfs_trace_hash(buf);
+}
+
+/**
+ * Finds the name in the table.
+ *
+ * name[in] - joined name.
+ * hash[in] - hash of the name.
+ *
+ * return found name, NULL if not found.
+ */
+static sdi_sysfs_trace_name_t * sdi_sysfs_trace_name_find(const char *name, uint32_t hash)
+{
+    sdi_sysfs_trace_name_t *cur = sdi_sysfs_trace.buckets[hash & (SDI_SYSFS_TRACE_BUCKETS - 1)];
+
+    while ((cur != NULL) && ((cur->hash != hash) || (strcmp(cur->name, name) != 0))) {
+        cur = cur->next;
+    }
+
+    return cur;
+}
+
+/**
+ * Adds the name to the table under the next ID.
+ *
+ * name[in] - name, copied.
+ * len[in] - length of the name.
+ * hash[in] - hash of the name.
+ *
+ * return added name.
+ */
+static sdi_sysfs_trace_name_t * sdi_sysfs_trace_name_add(const char *name, size_t len, uint32_t hash)
+{
+    sdi_sysfs_trace_name_t *entry = NULL;
+    uint32_t                bucket = hash & (SDI_SYSFS_TRACE_BUCKETS - 1);
+
+    entry = (sdi_sysfs_trace_name_t*)calloc(1, sizeof(*entry));
+    STD_ASSERT(entry != NULL);
+    entry->name = (char*)calloc(1, len + 1);
+    STD_ASSERT(entry->name != NULL);
+
+    memcpy(entry->name, name, len);
+    entry->hash = hash;
+    entry->id = sdi_sysfs_trace.count++;
+    entry->next = sdi_sysfs_trace.buckets[bucket];
+    sdi_sysfs_trace.buckets[bucket] = entry;
+
+    return entry;
+}
+
+/**
+ * Frees all the names and the loaded trace.
+ *
+ * return None.
+ */
+static void sdi_sysfs_trace_free(void)
+{
+    sdi_sysfs_trace_name_t *cur = NULL;
+    sdi_sysfs_trace_name_t *next = NULL;
+    uint_t                  i = 0;
+
+    for (i = 0; i < SDI_SYSFS_TRACE_BUCKETS; i++) {
+        for (cur = sdi_sysfs_trace.buckets[i]; (cur != NULL); cur = next) {
+            next = cur->next;
+            free(cur->recs[0]);
+            free(cur->recs[1]);
+            free(cur->name);
+            free(cur);
+        }
+        sdi_sysfs_trace.buckets[i] = NULL;
+    }
+
+    free(sdi_sysfs_trace.ids);
+    free(sdi_sysfs_trace.data);
+    sdi_sysfs_trace.ids = NULL;
+    sdi_sysfs_trace.data = NULL;
+    sdi_sysfs_trace.count = 0;
+}
+
+/**
+ * Maps the access to the index of its recorded accesses.
+ *
+ * op[in] - accessed operation.
+ *
+ * return 0 for reads and 1 for writes.
+ */
+static uint_t sdi_sysfs_trace_dir(uint8_t op)
+{
+    return ((op == SDI_SYSFS_TRACE_READ) || (op == SDI_SYSFS_TRACE_REG_GET)) ? 0 : 1;
+}
+
+/**
+ * Starts recording all the hardware accesses to the trace file.
+ *
+ * file[in] - path to the trace file, truncated if exists.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_trace_record_start(const char *file)
+{
+    uint8_t     hdr[SDI_SYSFS_TRACE_HDR_LEN] = {0};
+    uint32_t    version = SDI_SYSFS_TRACE_VERSION;
+    t_std_error rc = STD_ERR_OK;
+
+    STD_ASSERT(file != NULL);
+
+    pthread_mutex_lock(&sdi_sysfs_trace.lock);
+
+    if (sdi_sysfs_trace.mode != SDI_SYSFS_TRACE_OFF) {
+        pthread_mutex_unlock(&sdi_sysfs_trace.lock);
+        return SDI_ERRCODE(EALREADY); /* Operation already in progress */
+    }
+
+    memcpy(hdr, SDI_SYSFS_TRACE_MAGIC, 8);
+    memcpy(hdr + 8, &version, sizeof(version));
+
+    if (((sdi_sysfs_trace.file = fopen(file, "wb")) == NULL) ||
+        (fwrite(hdr, sizeof(hdr), 1, sdi_sysfs_trace.file) != 1)) {
+        rc = SDI_ERRNO;
+        SDI_ERRMSG_LOG("Failed to create trace %s (rc=%d)\n", file, rc);
+        if (sdi_sysfs_trace.file != NULL) {
+            fclose(sdi_sysfs_trace.file);
+            sdi_sysfs_trace.file = NULL;
+        }
+    } else {
+        sdi_sysfs_trace.start_ns = sdi_sysfs_trace_time_ns();
+        __atomic_store_n(&sdi_sysfs_trace.mode, SDI_SYSFS_TRACE_RECORD, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_trace.lock);
+
+    return rc;
+}
+
+/**
+ * Parses the loaded trace.
+ *
+ * The first pass adds the names and counts their accesses, the second one fills the
+ * accesses in.
+ *
+ * data[in] - loaded trace.
+ * size[in] - size of the trace.
+ * fill[in] - false for the first pass, true for the second one.
+ *
+ * return STD_ERR_OK on success, EINVAL if the trace is malformed.
+ */
+static t_std_error sdi_sysfs_trace_parse(const uint8_t *data, size_t size, bool fill)
+{
+    const uint8_t          *p = data + SDI_SYSFS_TRACE_HDR_LEN;
+    const uint8_t          *end = data + size;
+    sdi_sysfs_trace_name_t *entry = NULL;
+    sdi_sysfs_trace_rec_t  *rec = NULL;
+    char                    name[PATH_MAX];
+    uint32_t                names = 0;
+    uint32_t                id = 0;
+    uint16_t                name_len = 0;
+    uint32_t                len = 0;
+    uint_t                  dir = 0;
+
+    while (p < end) {
+        if (*p == SDI_SYSFS_TRACE_NAME) {
+            if ((size_t)(end - p) < SDI_SYSFS_TRACE_NAME_LEN) {
+                return SDI_ERRCODE(EINVAL);
+            }
+            memcpy(&id, p + 1, sizeof(id));
+            memcpy(&name_len, p + 5, sizeof(name_len));
+            p += SDI_SYSFS_TRACE_NAME_LEN;
+            if (((size_t)(end - p) < name_len) || (name_len >= sizeof(name)) || (id != names++)) {
+                return SDI_ERRCODE(EINVAL);
+            }
+            if (fill == false) {
+                memcpy(name, p, name_len);
+                name[name_len] = '\0';
+                entry = sdi_sysfs_trace_name_add(name, name_len, sdi_sysfs_trace_hash(name));
+
+                sdi_sysfs_trace.ids = (sdi_sysfs_trace_name_t**)realloc(sdi_sysfs_trace.ids,
+                                                                     names * sizeof(entry));
+                STD_ASSERT(sdi_sysfs_trace.ids != NULL);
+                sdi_sysfs_trace.ids[id] = entry;
+            }
+            p += name_len;
+            continue;
+        }
+
+        if (((size_t)(end - p) < SDI_SYSFS_TRACE_REC_LEN) || (*p > SDI_SYSFS_TRACE_REG_SET)) {
+            return SDI_ERRCODE(EINVAL);
+        }
+        memcpy(&id, p + 1, sizeof(id));
+        memcpy(&len, p + 21, sizeof(len));
+        if ((id >= names) || ((size_t)(end - p - SDI_SYSFS_TRACE_REC_LEN) < len)) {
+            return SDI_ERRCODE(EINVAL);
+        }
+
+        entry = sdi_sysfs_trace.ids[id];
+        dir = sdi_sysfs_trace_dir(*p);
+        if (fill == true) {
+            rec = &entry->recs[dir][entry->cursor[dir]++];
+            memcpy(&rec->lat_ns, p + 13, sizeof(rec->lat_ns));
+            memcpy(&rec->rc, p + 17, sizeof(rec->rc));
+            rec->len = len;
+            rec->data = p + SDI_SYSFS_TRACE_REC_LEN;
+        } else {
+            entry->count[dir]++;
+        }
+        p += SDI_SYSFS_TRACE_REC_LEN + len;
+    }
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Loads the trace file into memory.
+ *
+ * file[in] - path to the trace file.
+ * size[out] - size of the trace.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_trace_load(const char *file, size_t *size)
+{
+    FILE       *fp = NULL;
+    long        len = 0;
+    uint32_t    version = 0;
+    t_std_error rc = STD_ERR_OK;
+
+    if ((fp = fopen(file, "rb")) == NULL) {
+        return SDI_ERRNO;
+    }
+
+    if ((fseek(fp, 0, SEEK_END) != 0) || ((len = ftell(fp)) < 0) || (fseek(fp, 0, SEEK_SET) != 0)) {
+        rc = SDI_ERRNO;
+    } else if (len < SDI_SYSFS_TRACE_HDR_LEN) {
+        rc = SDI_ERRCODE(EINVAL);
+    } else {
+        sdi_sysfs_trace.data = (uint8_t*)malloc(len);
+        STD_ASSERT(sdi_sysfs_trace.data != NULL);
+
+        if (fread(sdi_sysfs_trace.data, len, 1, fp) != 1) {
+            rc = SDI_ERRCODE(EIO);
+        } else {
+            memcpy(&version, sdi_sysfs_trace.data + 8, sizeof(version));
+            if ((memcmp(sdi_sysfs_trace.data, SDI_SYSFS_TRACE_MAGIC, 8) != 0) ||
+                (version != SDI_SYSFS_TRACE_VERSION)) {
+                rc = SDI_ERRCODE(EINVAL);
+            }
+        }
+    }
+
+    fclose(fp);
+    *size = len;
+
+    return rc;
+}
+
+/**
+ * Starts serving all the hardware accesses from the trace file.
+ *
+ * file[in] - path to the trace file.
+ * timed[in] - true to delay each access by its recorded latency.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_trace_replay_start(const char *file, bool timed)
+{
+    sdi_sysfs_trace_name_t *entry = NULL;
+    t_std_error             rc = STD_ERR_OK;
+    size_t                  size = 0;
+    uint32_t                i = 0;
+
+    STD_ASSERT(file != NULL);
+
+    pthread_mutex_lock(&sdi_sysfs_trace.lock);
+
+    if (sdi_sysfs_trace.mode != SDI_SYSFS_TRACE_OFF) {
+        pthread_mutex_unlock(&sdi_sysfs_trace.lock);
+        return SDI_ERRCODE(EALREADY); /* Operation already in progress */
+    }
+
+    if (((rc = sdi_sysfs_trace_load(file, &size)) == STD_ERR_OK) &&
+        ((rc = sdi_sysfs_trace_parse(sdi_sysfs_trace.data, size, false)) == STD_ERR_OK)) {
+        for (i = 0; i < sdi_sysfs_trace.count; i++) {
+            entry = sdi_sysfs_trace.ids[i];
+            entry->recs[0] = (sdi_sysfs_trace_rec_t*)calloc(entry->count[0] + 1, sizeof(sdi_sysfs_trace_rec_t));
+            entry->recs[1] = (sdi_sysfs_trace_rec_t*)calloc(entry->count[1] + 1, sizeof(sdi_sysfs_trace_rec_t));
+            STD_ASSERT((entry->recs[0] != NULL) && (entry->recs[1] != NULL));
+        }
+
+        rc = sdi_sysfs_trace_parse(sdi_sysfs_trace.data, size, true);
+
+        for (i = 0; i < sdi_sysfs_trace.count; i++) {
+            sdi_sysfs_trace.ids[i]->cursor[0] = 0;
+            sdi_sysfs_trace.ids[i]->cursor[1] = 0;
+        }
+    }
+
+    if (rc == STD_ERR_OK) {
+        sdi_sysfs_trace.timed = timed;
+        __atomic_store_n(&sdi_sysfs_trace.mode, SDI_SYSFS_TRACE_REPLAY, __ATOMIC_RELEASE);
+        SDI_ERRMSG_LOG("Replaying trace %s, %u names\n", file, sdi_sysfs_trace.count);
+    } else {
+        SDI_ERRMSG_LOG("Failed to load trace %s (rc=%d)\n", file, rc);
+        sdi_sysfs_trace_free();
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_trace.lock);
+
+    return rc;
+}
+
+/**
+ * Stops the recording or the replay.
+ *
+ * return None.
+ */
+void sdi_sysfs_trace_stop(void)
+{
+    pthread_mutex_lock(&sdi_sysfs_trace.lock);
+
+    __atomic_store_n(&sdi_sysfs_trace.mode, SDI_SYSFS_TRACE_OFF, __ATOMIC_RELEASE);
+
+    if (sdi_sysfs_trace.file != NULL) {
+        fclose(sdi_sysfs_trace.file);
+        sdi_sysfs_trace.file = NULL;
+    }
+
+    sdi_sysfs_trace_free();
+
+    pthread_mutex_unlock(&sdi_sysfs_trace.lock);
+}
+
+/**
+ * Checks whether the accesses are served from a trace.
+ *
+ * return true if replaying, false otherwise.
+ */
+bool sdi_sysfs_trace_replaying(void)
+{
+    return (__atomic_load_n(&sdi_sysfs_trace.mode, __ATOMIC_ACQUIRE) == SDI_SYSFS_TRACE_REPLAY);
+}
+
+/**
+ * Starts measuring a recorded access.
+ *
+ * return start time to pass to sdi_sysfs_trace_record(), 0 if not recording.
+ */
+uint64_t sdi_sysfs_trace_start(void)
+{
+    if (__atomic_load_n(&sdi_sysfs_trace.mode, __ATOMIC_RELAXED) != SDI_SYSFS_TRACE_RECORD) {
+        return 0;
+    }
+
+    return sdi_sysfs_trace_time_ns();
+}
+
+/**
+ * Records an access.
+ *
+ * start[in] - value returned by sdi_sysfs_trace_start(), 0 is ignored.
+ * op[in] - accessed operation.
+ * path[in] - path to SysFs attribute or name of the register.
+ * attr[in] - name of SysFs attribute, appended to the path.
+ * data[in] - data read or written.
+ * len[in] - length of the data.
+ * rc[in] - result of the access.
+ *
+ * return None.
+ */
+void sdi_sysfs_trace_record(uint64_t start, sdi_sysfs_trace_op_t op, const char *path, const char *attr,
+                            const void *data, size_t len, t_std_error rc)
+{
+    char                    name[PATH_MAX];
+    uint8_t                 rec[SDI_SYSFS_TRACE_REC_LEN];
+    sdi_sysfs_trace_name_t *entry = NULL;
+    uint64_t                now = 0;
+    uint64_t                lat = 0;
+    uint32_t                hash = 0;
+    uint32_t                data_len = len;
+    uint16_t                name_len = 0;
+
+    if (start == 0) {
+        return;
+    }
+
+    now = sdi_sysfs_trace_time_ns();
+    lat = ((now - start) > UINT32_MAX) ? UINT32_MAX : (now - start);
+    hash = sdi_sysfs_trace_name_join(path, attr, name, sizeof(name));
+
+    pthread_mutex_lock(&sdi_sysfs_trace.lock);
+
+    if (sdi_sysfs_trace.mode != SDI_SYSFS_TRACE_RECORD) {
+        pthread_mutex_unlock(&sdi_sysfs_trace.lock);
+        return;
+    }
+
+    if ((entry = sdi_sysfs_trace_name_find(name, hash)) == NULL) {
+        name_len = strlen(name);
+        entry = sdi_sysfs_trace_name_add(name, name_len, hash);
+
+        rec[0] = SDI_SYSFS_TRACE_NAME;
+        memcpy(rec + 1, &entry->id, sizeof(entry->id));
+        memcpy(rec + 5, &name_len, sizeof(name_len));
+        fwrite(rec, SDI_SYSFS_TRACE_NAME_LEN, 1, sdi_sysfs_trace.file);
+        fwrite(name, name_len, 1, sdi_sysfs_trace.file);
+    }
+
+    rec[0] = op;
+    memcpy(rec + 1, &entry->id, sizeof(entry->id));
+    now = start - sdi_sysfs_trace.start_ns;
+    memcpy(rec + 5, &now, sizeof(now));
+    memcpy(rec + 13, &lat, sizeof(uint32_t));
+    memcpy(rec + 17, &rc, sizeof(rc));
+    if (data == NULL) {
+        data_len = 0;
+    }
+    memcpy(rec + 21, &data_len, sizeof(data_len));
+
+    fwrite(rec, sizeof(rec), 1, sdi_sysfs_trace.file);
+    if (data_len > 0) {
+        fwrite(data, data_len, 1, sdi_sysfs_trace.file);
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_trace.lock);
+}
+
+/**
+ * Serves an access from the trace.
+ *
+ * op[in] - accessed operation.
+ * path[in] - path to SysFs attribute or name of the register.
+ * attr[in] - name of SysFs attribute, appended to the path.
+ * data[out] - recorded data of the read, valid until sdi_sysfs_trace_stop().
+ * len[out] - length of the recorded data.
+ *
+ * return recorded result of the access.
+ */
+t_std_error sdi_sysfs_trace_replay(sdi_sysfs_trace_op_t op, const char *path, const char *attr,
+                                   const void **data, size_t *len)
+{
+    char                    name[PATH_MAX];
+    sdi_sysfs_trace_name_t *entry = NULL;
+    sdi_sysfs_trace_rec_t  *rec = NULL;
+    struct timespec         ts;
+    uint32_t                hash = 0;
+    uint_t                  dir = sdi_sysfs_trace_dir(op);
+    t_std_error             rc = STD_ERR_OK;
+
+    *data = NULL;
+    *len = 0;
+
+    hash = sdi_sysfs_trace_name_join(path, attr, name, sizeof(name));
+
+    pthread_mutex_lock(&sdi_sysfs_trace.lock);
+
+    if ((entry = sdi_sysfs_trace_name_find(name, hash)) == NULL) {
+        rc = SDI_ERRCODE(ENOENT);
+    } else if (entry->cursor[dir] < entry->count[dir]) {
+        rec = &entry->recs[dir][entry->cursor[dir]++];
+    } else if ((dir == 0) && (entry->count[dir] > 0)) {
+        /* Reads past the end of the trace keep returning the last value */
+        rec = &entry->recs[dir][entry->count[dir] - 1];
+    } else if (dir == 0) {
+        rc = SDI_ERRCODE(ENOENT);
+    }
+
+    if (rec != NULL) {
+        rc = rec->rc;
+        *data = rec->data;
+        *len = rec->len;
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_trace.lock);
+
+    if ((rec != NULL) && (sdi_sysfs_trace.timed == true)) {
+        ts.tv_sec = rec->lat_ns / 1000000000;
+        ts.tv_nsec = rec->lat_ns % 1000000000;
+        nanosleep(&ts, NULL);
+    }
+
+    return rc;
+}
@@ -9,256 +9,2498 @@
  * SysFs util functions to get and set attributes of resources.
  ***************************************************************************************/
 
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include "sdi_common.h"
 #include "sdi_sysfs_utils.h"
+#include "sdi_sysfs_codec.h"
+#include "sdi_sysfs_stats.h"
+#include "sdi_sysfs_trace.h"
+#include "sdi_string_pool.h"
 #include <stdio.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#if defined(HAVE_LIBURING_H) && defined(HAVE_IO_URING)
+#define SDI_SYSFS_USE_IO_URING
+#include <liburing.h>
+#endif
 
+#define SDI_SYSFS_FD_CACHE_SIZE     64  /**< maximum number of SysFs attributes kept open */
+#define SDI_SYSFS_FD_CACHE_BUCKETS  128 /**< number of hash buckets in the fd cache, power of 2 */
+#define SDI_SYSFS_VAL_MAX_LEN       SDI_MAX_NAME_LEN /**< maximum length of a SysFs attribute value */
+#define SDI_SYSFS_HDL_RETRY_US      1000000 /**< interval between probes of a missing attribute */
+#define SDI_SYSFS_BATCH_CHUNK       32  /**< maximum number of reads submitted at once by a batch */
+#define SDI_SYSFS_DATA_MIN_SIZE     256 /**< initial buffer size for raw data of unknown size */
+#define SDI_SYSFS_SHADOW_REFRESH_MS 60000 /**< default interval after which a shadowed value is re-written */
+#define SDI_SYSFS_TIMED_WORKERS     4 /**< number of threads kept for the timed reads */
+#define SDI_SYSFS_TIMED_WORKERS_MAX 32 /**< maximum number of threads, stuck ones included */
+#define SDI_SYSFS_QUARANTINE_COUNT  3 /**< consecutive timeouts after which an attribute is quarantined */
+#define SDI_SYSFS_QUARANTINE_US     30000000 /**< interval during which a quarantined attribute isn't read */
+#define SDI_SYSFS_ROOT_ENV          "SDI_SYSFS_ROOT" /**< environment variable relocating all SysFs paths */
+#define SDI_SYSFS_DELAY_ENV         "SDI_SYSFS_DELAY_US" /**< environment variable setting simulated I/O latency */
 
 /**
- * Sets string value for SysFs attribute.
+ * @struct sdi_sysfs_fd_entry_t
+ * Used to hold an open SysFs attribute in the fd cache.
+ */
+typedef struct sdi_sysfs_fd_entry_s {
+    std_dll                      node;      /**< node in the LRU list, must be the first member */
+    struct sdi_sysfs_fd_entry_s *next;      /**< next entry in the same hash bucket */
+    char                        *full_path; /**< joined path and name of the SysFs attribute */
+    uint32_t                     hash;      /**< hash of the (path, attr, flags) key */
+    int                          flags;     /**< flags the attribute was opened with */
+    int                          fd;        /**< file descriptor of the open attribute */
+    uint_t                       refcnt;    /**< number of callers currently doing I/O on fd */
+    bool                         stale;     /**< entry has to be closed once it is released */
+} sdi_sysfs_fd_entry_t;
+
+/**
+ * @struct sdi_sysfs_fd_cache_t
+ * Bounded LRU cache of open SysFs attributes keyed by (path, attr).
+ */
+typedef struct sdi_sysfs_fd_cache_s {
+    pthread_mutex_t       lock;     /**< protects all the fields below */
+    std_dll_head          lru;      /**< entries from the most to the least recently used */
+    sdi_sysfs_fd_entry_t *buckets[SDI_SYSFS_FD_CACHE_BUCKETS]; /**< hash buckets */
+    uint_t                count;    /**< number of entries in the cache */
+    bool                  init;     /**< whether lru list is initialized */
+} sdi_sysfs_fd_cache_t;
+
+static sdi_sysfs_fd_cache_t sdi_sysfs_fd_cache = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+/**
+ * @struct sdi_sysfs_attr_s
+ * Pre-resolved SysFs attribute, created once when the resource settings are registered.
+ */
+struct sdi_sysfs_attr_s {
+    const char              *path;          /**< joined path and name of the SysFs attribute, interned */
+    uint32_t                 hash;          /**< hash of the path, used as the fd cache key */
+    sdi_sysfs_attr_type_t    type;          /**< type of the attribute value */
+    uint_t                   flags;         /**< SDI_SYSFS_HDL_F_* flags */
+    pthread_rwlock_t         lock;          /**< protects the pinned descriptor */
+    int                      fd;            /**< pinned descriptor, -1 if not pinned or not opened yet */
+    bool                     exists;        /**< whether the attribute existed on the last access */
+    uint64_t                 retry_ts;      /**< time (us) after which a missing attribute is probed again */
+    pthread_mutex_t          wlock;         /**< serializes writes to the shadowed attribute */
+    char                    *shadow;        /**< last value written, NULL if the attribute is not shadowed */
+    size_t                   shadow_len;    /**< length of the last value written, 0 if it is unknown */
+    uint64_t                 shadow_ts;     /**< time (us) of the last actual write */
+    uint64_t                 refresh_us;    /**< interval after which the same value is re-written, 0 - never */
+    char                    *pending;       /**< value waiting in the write queue, NULL if writes are synchronous */
+    size_t                   pending_len;   /**< length of the pending value */
+    bool                     queued;        /**< whether the handle is in the write queue */
+    uint64_t                 queued_seq;    /**< number of writes pushed to the queue */
+    uint64_t                 done_seq;      /**< number of queued writes completed, coalesced ones included */
+    t_std_error              async_rc;      /**< result of the last queued write */
+    struct sdi_sysfs_attr_s *wq_next;       /**< next handle in the write queue */
+    char                    *last;          /**< last value read by the timed reads, NULL until the first one */
+    bool                     last_valid;    /**< whether the last value is valid */
+    bool                     rd_pending;    /**< whether a timed read is queued or being executed */
+    uint64_t                 rd_start_us;   /**< time (us) a worker took the pending read, 0 while queued */
+    uint64_t                 rd_seq;        /**< number of reads submitted to the workers */
+    uint64_t                 rd_done;       /**< number of reads completed by the workers */
+    t_std_error              rd_rc;         /**< result of the last read completed by the workers */
+    uint_t                   timeouts;      /**< number of consecutive timed out reads */
+    uint64_t                 quarantine_ts; /**< time (us) until which reads fail fast, 0 if not quarantined */
+    struct sdi_sysfs_attr_s *rq_next;       /**< next handle in the read queue */
+    struct sdi_sysfs_attr_s *next;          /**< next handle in the registry */
+};
+
+/**
+ * @struct sdi_sysfs_shadow_stats_t
+ * Used to count writes to the shadowed attributes.
+ */
+typedef struct sdi_sysfs_shadow_stats_s {
+    uint64_t written;    /**< number of writes which reached the attribute */
+    uint64_t suppressed; /**< number of writes skipped because the value didn't change */
+} sdi_sysfs_shadow_stats_t;
+
+static sdi_sysfs_shadow_stats_t sdi_sysfs_shadow_stats;
+
+/**
+ * @struct sdi_sysfs_rq_t
+ * Queue of reads with a deadline, executed by the worker threads.
+ *
+ * A handle is queued at most once, callers arriving while its read is pending wait
+ * for the same read. A worker blocked in a wedged read doesn't hold the queue up: a
+ * read queued while no worker is idle starts another one, up to
+ * SDI_SYSFS_TIMED_WORKERS_MAX. Workers above SDI_SYSFS_TIMED_WORKERS exit once their
+ * read completes and the queue is empty.
+ */
+typedef struct sdi_sysfs_rq_s {
+    pthread_once_t  once;    /**< starts the workers */
+    pthread_mutex_t lock;    /**< protects the queue, the counts and the timed read state of the handles */
+    pthread_cond_t  push;    /**< signaled when a handle is queued */
+    pthread_cond_t  done;    /**< signaled when a read is completed, uses CLOCK_MONOTONIC */
+    sdi_sysfs_hdl_t head;    /**< oldest queued handle */
+    sdi_sysfs_hdl_t tail;    /**< newest queued handle */
+    uint_t          queued;  /**< number of queued handles */
+    uint_t          workers; /**< number of running workers */
+    uint_t          idle;    /**< number of workers waiting for a handle */
+} sdi_sysfs_rq_t;
+
+static sdi_sysfs_rq_t sdi_sysfs_rq = {
+    .once = PTHREAD_ONCE_INIT,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .push = PTHREAD_COND_INITIALIZER
+};
+
+/**
+ * @struct sdi_sysfs_root_t
+ * Location of the SysFs tree, which may be relocated to a simulated one for testing.
+ */
+typedef struct sdi_sysfs_root_s {
+    pthread_once_t once;           /**< reads the environment */
+    char           path[PATH_MAX]; /**< prefix of all absolute SysFs paths, empty if not relocated */
+    uint_t         delay_us;       /**< latency added to each access of the simulated tree */
+} sdi_sysfs_root_t;
+
+static sdi_sysfs_root_t sdi_sysfs_root = {
+    .once = PTHREAD_ONCE_INIT
+};
+
+/**
+ * @struct sdi_sysfs_wq_t
+ * Queue of writes to SDI_SYSFS_HDL_F_ASYNC attributes, drained by the writer thread.
+ *
+ * The queue links the handles themselves and a handle is queued at most once, so it
+ * never holds more entries than there are async handles.
+ */
+typedef struct sdi_sysfs_wq_s {
+    pthread_mutex_t lock;    /**< protects the queue and the pending values of the handles */
+    pthread_cond_t  push;    /**< signaled when a handle is queued or the writer has to stop */
+    pthread_cond_t  done;    /**< signaled when a queued write is completed */
+    sdi_sysfs_hdl_t head;    /**< oldest queued handle */
+    sdi_sysfs_hdl_t tail;    /**< newest queued handle */
+    sdi_sysfs_hdl_t busy;    /**< handle being written by the writer, NULL if it is idle */
+    bool            running; /**< whether writes to async attributes are queued */
+    bool            stop;    /**< writer thread has to exit */
+    pthread_t       thread;  /**< writer thread */
+} sdi_sysfs_wq_t;
+
+static sdi_sysfs_wq_t sdi_sysfs_wq = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .push = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER
+};
+
+/**
+ * @struct sdi_sysfs_hdl_registry_t
+ * List of all created SysFs attribute handles.
+ */
+typedef struct sdi_sysfs_hdl_registry_s {
+    pthread_mutex_t lock;  /**< protects the list */
+    sdi_sysfs_hdl_t head;  /**< most recently created handle */
+} sdi_sysfs_hdl_registry_t;
+
+static sdi_sysfs_hdl_registry_t sdi_sysfs_hdl_registry = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+/**
+ * @struct sdi_sysfs_batch_slot_t
+ * Used to hold the state of one read submitted by a batch.
+ */
+typedef struct sdi_sysfs_batch_slot_s {
+    sdi_sysfs_fd_entry_t *entry;                     /**< fd cache entry the descriptor belongs to */
+    int                   fd;                        /**< descriptor to read, -1 if it isn't available */
+    ssize_t               res;                       /**< number of bytes read or negative errno */
+    char                  buf[SDI_SYSFS_VAL_MAX_LEN]; /**< raw value of the attribute */
+} sdi_sysfs_batch_slot_t;
+
+#ifdef SDI_SYSFS_USE_IO_URING
+/**
+ * @struct sdi_sysfs_uring_t
+ * Ring shared by the batch reads.
+ */
+typedef struct sdi_sysfs_uring_s {
+    pthread_mutex_t lock;      /**< serializes the use of the ring */
+    bool            init_done; /**< whether the ring initialization was attempted */
+    bool            available; /**< whether the ring may be used */
+    struct io_uring ring;      /**< the ring itself */
+    char            buf[SDI_SYSFS_BATCH_CHUNK][SDI_SYSFS_VAL_MAX_LEN]; /**< buffers the reads complete into */
+} sdi_sysfs_uring_t;
+
+static sdi_sysfs_uring_t sdi_sysfs_uring = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+#endif
+
+/**
+ * Returns monotonic time in microseconds.
+ *
+ * return monotonic time in microseconds.
+ */
+static uint64_t sdi_sysfs_time_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+/**
+ * Calculates hash of the SysFs attribute path.
+ *
+ * The hash covers the joined path, so it doesn't depend on how the path is split
+ * between path and attr.
  *
  * path[in] - path to SysFs attribute.
  * attr[in] - name of SysFs attribute.
- * val[in] - value which should be set.
  *
- * return STD_ERR_OK on success and standard error on failure.
+ * return hash of the path.
  */
-t_std_error sdi_sysfs_attr_str_set(const char *path, const char *attr, const char *val)
+static uint32_t sdi_sysfs_path_hash(const char *path, const char *attr)
 {
-    FILE *f = NULL;
-    char  full_path[PATH_MAX] = {0};
+    uint32_t hash = 2166136261u; /* FNV-1a */
 
-    if ((path == NULL) || (attr == NULL) || (val == NULL)) {
-        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    for (; *path != '\0'; path++) {
+        hash = (hash ^ (uint8_t)*path) * 16777619u;
     }
 
-    snprintf(full_path, sizeof(full_path) - 1, "%s%s", path, attr);
+    for (; *attr != '\0'; attr++) {
+        hash = (hash ^ (uint8_t)*attr) * 16777619u;
+    }
 
-    if (access(full_path, F_OK) == -1) {
-        return SDI_ERRNO;
+    return hash;
+}
+
+/**
+ * Reads the location of the SysFs tree from the environment.
+ *
+ * return None.
+ */
+static void sdi_sysfs_root_init(void)
+{
+    const char *env = NULL;
+    size_t      len = 0;
+
+    if (((env = getenv(SDI_SYSFS_ROOT_ENV)) == NULL) || (*env == '\0')) {
+        return;
     }
 
-    if ((f = fopen(full_path, "w")) == NULL) {
-        return SDI_ERRNO;
+    strncpy(sdi_sysfs_root.path, env, sizeof(sdi_sysfs_root.path) - 1);
+
+    len = strlen(sdi_sysfs_root.path);
+    while ((len > 0) && (sdi_sysfs_root.path[len - 1] == '/')) {
+        sdi_sysfs_root.path[--len] = '\0';
     }
 
-    fprintf(f, "%s", val);
+    if ((env = getenv(SDI_SYSFS_DELAY_ENV)) != NULL) {
+        sdi_sysfs_root.delay_us = atoi(env);
+    }
 
-    fclose(f);
+    SDI_ERRMSG_LOG("SysFs is relocated to %s, simulated latency %u us\n",
+                   sdi_sysfs_root.path, sdi_sysfs_root.delay_us);
+}
 
-    return STD_ERR_OK;
+/**
+ * Gets the prefix of all absolute SysFs paths.
+ *
+ * return prefix set by SDI_SYSFS_ROOT environment variable, empty string if not set.
+ */
+const char * sdi_sysfs_root_get(void)
+{
+    pthread_once(&sdi_sysfs_root.once, sdi_sysfs_root_init);
+
+    return sdi_sysfs_root.path;
 }
 
 /**
- * Gets the string value from SysFs attribute.
+ * Prefixes absolute SysFs path with the root of the relocated tree.
  *
  * path[in] - path to SysFs attribute.
- * attr[in] - name of SysFs attribute.
- * val[out] - retrieved value.
+ * buf[out] - buffer for the prefixed path.
+ * size[in] - size of the buffer.
  *
- * return STD_ERR_OK on success and standard error on failure.
+ * return the path itself if SysFs is not relocated, buf otherwise.
  */
-t_std_error sdi_sysfs_attr_str_get(const char *path, const char *attr, char *val)
+static const char * sdi_sysfs_root_join(const char *path, char *buf, size_t size)
 {
-    FILE *f = NULL;
-    char  full_path[PATH_MAX] = {0};
+    const char *root = sdi_sysfs_root_get();
 
-    if ((path == NULL) || (attr == NULL) || (val == NULL)) {
-        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    if ((*root == '\0') || (*path != '/')) {
+        return path;
     }
 
-    snprintf(full_path, sizeof(full_path) - 1, "%s%s", path, attr);
+    snprintf(buf, size, "%s%s", root, path);
 
-    if (access(full_path, F_OK) == -1) {
-        return SDI_ERRNO;
-    }
+    return buf;
+}
 
-    if ((f = fopen(full_path, "r")) == NULL) {
-        return SDI_ERRNO;
+/**
+ * Adds the simulated latency to an access of the relocated SysFs tree.
+ *
+ * return None.
+ */
+static void sdi_sysfs_sim_delay(void)
+{
+    if (sdi_sysfs_root.delay_us > 0) {
+        usleep(sdi_sysfs_root.delay_us);
     }
+}
+
+/**
+ * Checks whether the cache entry matches the given key.
+ *
+ * entry[in] - cache entry.
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * flags[in] - open flags.
+ *
+ * return true if entry matches the key, false otherwise.
+ */
+static bool sdi_sysfs_fd_match(const sdi_sysfs_fd_entry_t *entry, const char *path, const char *attr, int flags)
+{
+    const char *full_path = entry->full_path;
 
-    fscanf(f, "%s", val);
+    if (entry->flags != flags) {
+        return false;
+    }
 
-    fclose(f);
+    for (; *path != '\0'; path++, full_path++) {
+        if (*full_path != *path) {
+            return false;
+        }
+    }
 
-    return STD_ERR_OK;
+    return (strcmp(full_path, attr) == 0);
 }
 
 /**
- * Sets the unsigned integer value for SysFs attribute.
+ * Unlinks the entry from the cache and closes it unless it is still in use.
  *
- * path[in] - path to SysFs attribute.
- * attr[in] - name of SysFs attribute.
- * val[in] - value which should be set.
+ * Must be called with the cache lock held and only for entries, which are not stale.
  *
- * return STD_ERR_OK on success and standard error on failure.
+ * entry[in] - cache entry to remove.
+ *
+ * return None.
  */
-t_std_error sdi_sysfs_attr_uint_set(const char *path, const char *attr, uint_t val)
+static void sdi_sysfs_fd_unlink(sdi_sysfs_fd_entry_t *entry)
 {
-    FILE *f = NULL;
-    char  full_path[PATH_MAX] = {0};
+    sdi_sysfs_fd_entry_t **pp = &sdi_sysfs_fd_cache.buckets[entry->hash & (SDI_SYSFS_FD_CACHE_BUCKETS - 1)];
 
-    if ((path == NULL) || (attr == NULL)) {
-        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    while (*pp != entry) {
+        pp = &(*pp)->next;
     }
 
-    snprintf(full_path, sizeof(full_path) - 1, "%s%s", path, attr);
+    *pp = entry->next;
+    std_dll_remove(&sdi_sysfs_fd_cache.lru, &entry->node);
+    sdi_sysfs_fd_cache.count--;
 
-    if (access(full_path, F_OK) == -1) {
-        return SDI_ERRNO;
+    if (entry->refcnt > 0) {
+        entry->stale = true;
+        return;
     }
 
-    if ((f = fopen(full_path, "w")) == NULL) {
-        return SDI_ERRNO;
+    close(entry->fd);
+    free(entry->full_path);
+    free(entry);
+}
+
+/**
+ * Evicts the least recently used entry, which is not in use.
+ *
+ * Must be called with the cache lock held.
+ *
+ * return true if an entry was evicted, false if all entries are busy.
+ */
+static bool sdi_sysfs_fd_evict(void)
+{
+    sdi_sysfs_fd_entry_t *entry = NULL;
+
+    for (entry = (sdi_sysfs_fd_entry_t*)std_dll_getlast(&sdi_sysfs_fd_cache.lru);
+         (entry != NULL);
+         entry = (sdi_sysfs_fd_entry_t*)std_dll_getprev(&sdi_sysfs_fd_cache.lru, &entry->node)) {
+        if (entry->refcnt == 0) {
+            sdi_sysfs_fd_unlink(entry);
+            return true;
+        }
     }
 
-    fprintf(f, "%d", val);
+    return false;
+}
+
+/**
+ * Looks the descriptor up in the cache and takes a reference to it.
+ *
+ * Must be called with the cache lock held.
+ *
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * hash[in] - hash of the cache key.
+ * flags[in] - open flags.
+ *
+ * return cache entry, NULL if the attribute is not cached.
+ */
+static sdi_sysfs_fd_entry_t * sdi_sysfs_fd_lookup(const char *path, const char *attr, uint32_t hash, int flags)
+{
+    sdi_sysfs_fd_entry_t *cur = NULL;
 
-    fclose(f);
+    for (cur = sdi_sysfs_fd_cache.buckets[hash & (SDI_SYSFS_FD_CACHE_BUCKETS - 1)]; (cur != NULL); cur = cur->next) {
+        if ((cur->hash == hash) && sdi_sysfs_fd_match(cur, path, attr, flags)) {
+            cur->refcnt++;
+            std_dll_remove(&sdi_sysfs_fd_cache.lru, &cur->node);
+            std_dll_insertatfront(&sdi_sysfs_fd_cache.lru, &cur->node);
+            return cur;
+        }
+    }
 
-    return STD_ERR_OK;
+    return NULL;
 }
 
 /**
- * Gets the unsigned integer value from SysFs attribute.
+ * Gets the file descriptor of SysFs attribute, opening it if it is not cached yet.
+ *
+ * The descriptor must be released with sdi_sysfs_fd_put().
  *
  * path[in] - path to SysFs attribute.
  * attr[in] - name of SysFs attribute.
- * val[out] - retrieved value.
+ * path_hash[in] - hash of the path, as returned by sdi_sysfs_path_hash().
+ * flags[in] - open flags.
+ * entry[out] - cache entry holding the descriptor, NULL if it could not be cached.
+ * fd[out] - file descriptor.
  *
  * return STD_ERR_OK on success and standard error on failure.
  */
-t_std_error sdi_sysfs_attr_uint_get(const char *path, const char *attr, uint_t *val)
+static t_std_error sdi_sysfs_fd_get(const char *path, const char *attr, uint32_t path_hash, int flags,
+                                    sdi_sysfs_fd_entry_t **entry, int *fd)
 {
-    FILE *f = NULL;
-    char  full_path[PATH_MAX] = {0};
+    sdi_sysfs_fd_entry_t *cur = NULL;
+    char                  full_path[PATH_MAX] = {0};
+    uint32_t              hash = (path_hash ^ (uint32_t)flags) * 16777619u;
+    uint_t                bucket = hash & (SDI_SYSFS_FD_CACHE_BUCKETS - 1);
+    int                   new_fd = -1;
 
-    if ((path == NULL) || (attr == NULL) || (val == NULL)) {
-        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    *entry = NULL;
+
+    pthread_mutex_lock(&sdi_sysfs_fd_cache.lock);
+
+    if (sdi_sysfs_fd_cache.init == false) {
+        std_dll_init(&sdi_sysfs_fd_cache.lru);
+        sdi_sysfs_fd_cache.init = true;
+    }
+
+    if ((cur = sdi_sysfs_fd_lookup(path, attr, hash, flags)) != NULL) {
+        pthread_mutex_unlock(&sdi_sysfs_fd_cache.lock);
+
+        *entry = cur;
+        *fd = cur->fd;
+        return STD_ERR_OK;
     }
 
+    pthread_mutex_unlock(&sdi_sysfs_fd_cache.lock);
+
+    /* Open outside of the lock, since open of SysFs attribute can be slow */
     snprintf(full_path, sizeof(full_path) - 1, "%s%s", path, attr);
 
-    if (access(full_path, F_OK) == -1) {
+    if ((new_fd = open(full_path, flags | O_CLOEXEC)) == -1) {
         return SDI_ERRNO;
     }
 
-    if ((f = fopen(full_path, "r")) == NULL) {
-        return SDI_ERRNO;
+    *fd = new_fd;
+
+    cur = (sdi_sysfs_fd_entry_t*)calloc(1, sizeof(sdi_sysfs_fd_entry_t));
+    if ((cur == NULL) || ((cur->full_path = strdup(full_path)) == NULL)) {
+        free(cur);
+        return STD_ERR_OK; /* Use the descriptor uncached */
+    }
+
+    cur->hash = hash;
+    cur->flags = flags;
+    cur->fd = new_fd;
+    cur->refcnt = 1;
+
+    pthread_mutex_lock(&sdi_sysfs_fd_cache.lock);
+
+    /* Another thread may have cached the same attribute meanwhile, its entry is used */
+    if ((*entry = sdi_sysfs_fd_lookup(path, attr, hash, flags)) != NULL) {
+        pthread_mutex_unlock(&sdi_sysfs_fd_cache.lock);
+
+        close(new_fd);
+        free(cur->full_path);
+        free(cur);
+        *fd = (*entry)->fd;
+        return STD_ERR_OK;
+    }
+
+    if ((sdi_sysfs_fd_cache.count < SDI_SYSFS_FD_CACHE_SIZE) || sdi_sysfs_fd_evict()) {
+        cur->next = sdi_sysfs_fd_cache.buckets[bucket];
+        sdi_sysfs_fd_cache.buckets[bucket] = cur;
+        std_dll_insertatfront(&sdi_sysfs_fd_cache.lru, &cur->node);
+        sdi_sysfs_fd_cache.count++;
+        *entry = cur;
+        cur = NULL;
     }
 
-    fscanf(f, "%u", val);
+    pthread_mutex_unlock(&sdi_sysfs_fd_cache.lock);
 
-    fclose(f);
+    if (cur != NULL) {
+        /* All cached descriptors are busy, use this one uncached */
+        free(cur->full_path);
+        free(cur);
+    }
 
     return STD_ERR_OK;
 }
 
 /**
- * Gets the integer value from SysFs attribute.
+ * Releases the file descriptor obtained with sdi_sysfs_fd_get().
+ *
+ * entry[in] - cache entry holding the descriptor, NULL for uncached descriptor.
+ * fd[in] - file descriptor.
+ * drop[in] - true if the descriptor should not be reused, e.g. after I/O error.
+ *
+ * return None.
+ */
+static void sdi_sysfs_fd_put(sdi_sysfs_fd_entry_t *entry, int fd, bool drop)
+{
+    if (entry == NULL) {
+        close(fd);
+        return;
+    }
+
+    pthread_mutex_lock(&sdi_sysfs_fd_cache.lock);
+
+    entry->refcnt--;
+
+    if ((drop == true) && (entry->stale == false)) {
+        sdi_sysfs_fd_unlink(entry);
+    } else if ((entry->stale == true) && (entry->refcnt == 0)) {
+        close(entry->fd);
+        free(entry->full_path);
+        free(entry);
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_fd_cache.lock);
+}
+
+/**
+ * Reads the value of SysFs attribute as a NUL-terminated string.
+ *
+ * The attribute is re-read from offset 0 through the cached descriptor. If the cached
+ * descriptor went bad (e.g. the device was removed and re-added), the attribute is
+ * re-opened once.
  *
  * path[in] - path to SysFs attribute.
  * attr[in] - name of SysFs attribute.
- * val[out] - retrieved value.
+ * hash[in] - hash of the path, as returned by sdi_sysfs_path_hash().
+ * buf[out] - buffer for the value.
+ * size[in] - size of the buffer.
  *
  * return STD_ERR_OK on success and standard error on failure.
  */
-t_std_error sdi_sysfs_attr_int_get(const char *path, const char *attr, int *val)
+static t_std_error sdi_sysfs_attr_pread(const char *path, const char *attr, uint32_t hash, char *buf, size_t size)
 {
-    FILE *f = NULL;
-    char  full_path[PATH_MAX] = {0};
+    sdi_sysfs_fd_entry_t *entry = NULL;
+    t_std_error           rc = STD_ERR_OK;
+    ssize_t               len = -1;
+    int                   fd = -1;
+    int                   attempt = 0;
 
-    if ((path == NULL) || (attr == NULL) || (val == NULL)) {
-        return SDI_ERRCODE(EINVAL); /* Invalid argument */
-    }
+    for (attempt = 0; attempt < 2; attempt++) {
+        if ((rc = sdi_sysfs_fd_get(path, attr, hash, O_RDONLY, &entry, &fd)) != STD_ERR_OK) {
+            return rc;
+        }
 
-    snprintf(full_path, sizeof(full_path) - 1, "%s%s", path, attr);
+        if ((len = pread(fd, buf, size - 1, 0)) >= 0) {
+            sdi_sysfs_fd_put(entry, fd, false);
+            buf[len] = '\0';
+            return STD_ERR_OK;
+        }
 
-    if (access(full_path, F_OK) == -1) {
-        return SDI_ERRNO;
-    }
+        rc = SDI_ERRNO;
+        sdi_sysfs_fd_put(entry, fd, true);
 
-    if ((f = fopen(full_path, "r")) == NULL) {
-        return SDI_ERRNO;
+        if (entry == NULL) {
+            break;
+        }
     }
 
-    fscanf(f, "%d", val);
-
-    fclose(f);
+    return rc;
+}
 
-    return STD_ERR_OK;
+/**
+ * Checks whether the error means the descriptor no longer refers to the attribute.
+ *
+ * A removed and re-inserted device gets a new SysFs file, the descriptor of the old one
+ * fails with ENODEV or ENXIO, depending on the driver.
+ *
+ * err[in] - errno of the failed access.
+ *
+ * return true if re-opening the attribute may succeed.
+ */
+static bool sdi_sysfs_fd_gone(int err)
+{
+    return (err == EBADF) || (err == ESTALE) || (err == ENODEV) || (err == ENXIO);
 }
 
 /**
- * Gets the size in bytes of raw data in the specified SysFs attribute.
+ * Writes the value to SysFs attribute.
+ *
+ * If the cached descriptor went bad, the attribute is re-opened and written once more.
+ * A failed or short write is not repeated.
  *
  * path[in] - path to SysFs attribute.
  * attr[in] - name of SysFs attribute.
- * size[in] - size of the raw data from specified SysFs attribute.
+ * hash[in] - hash of the path, as returned by sdi_sysfs_path_hash().
+ * buf[in] - value to write.
+ * len[in] - length of the value.
  *
  * return STD_ERR_OK on success and standard error on failure.
  */
-t_std_error sdi_sysfs_attr_data_size_get(const char *path, const char *attr, size_t *size)
+static t_std_error sdi_sysfs_attr_pwrite(const char *path, const char *attr, uint32_t hash,
+                                         const char *buf, size_t len)
 {
-    t_std_error rc = STD_ERR_OK;
-    FILE       *f = NULL;
-    char        full_path[PATH_MAX] = {0};
+    sdi_sysfs_fd_entry_t *entry = NULL;
+    t_std_error           rc = STD_ERR_OK;
+    ssize_t               written = -1;
+    int                   fd = -1;
+    int                   err = 0;
+    int                   attempt = 0;
 
-    if ((path == NULL) || (attr == NULL) || (size == NULL)) {
-        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    for (attempt = 0; attempt < 2; attempt++) {
+        if ((rc = sdi_sysfs_fd_get(path, attr, hash, O_WRONLY, &entry, &fd)) != STD_ERR_OK) {
+            return rc;
+        }
+
+        /* Unlike SysFs, files of the simulated tree keep the tail of a longer old value */
+        if (((written = pwrite(fd, buf, len, 0)) == (ssize_t)len) &&
+            ((*sdi_sysfs_root.path == '\0') || (ftruncate(fd, len) == 0))) {
+            sdi_sysfs_fd_put(entry, fd, false);
+            return STD_ERR_OK;
+        }
+
+        err = ((written >= 0) && (written < (ssize_t)len)) ? EIO : errno;
+        rc = SDI_ERRCODE(err);
+        sdi_sysfs_fd_put(entry, fd, true);
+
+        /* Only a cached descriptor gone bad is retried, anything else may have reached the device */
+        if ((entry == NULL) || (sdi_sysfs_fd_gone(err) == false)) {
+            break;
+        }
     }
 
-    snprintf(full_path, sizeof(full_path) - 1, "%s%s", path, attr);
+    return rc;
+}
 
-    if ((f = fopen(full_path, "rb")) == NULL) {
-        return SDI_ERRNO;
+/**
+ * Serves the read of SysFs attribute from the replayed trace.
+ *
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * buf[out] - buffer for the value.
+ * size[in] - size of the buffer.
+ *
+ * return recorded result of the read.
+ */
+static t_std_error sdi_sysfs_attr_replay(const char *path, const char *attr, char *buf, size_t size)
+{
+    const void *data = NULL;
+    size_t      len = 0;
+    t_std_error rc = sdi_sysfs_trace_replay(SDI_SYSFS_TRACE_READ, path, attr, &data, &len);
+
+    if (len > size - 1) {
+        len = size - 1;
+    }
+
+    if (len > 0) {
+        memcpy(buf, data, len);
     }
+    buf[len] = '\0';
+
+    return rc;
+}
 
-    rc = fseek(f, 0, SEEK_END);
-    if (rc == 0) {
-        *size = ftell(f);
-        rc = fseek(f, 0, SEEK_SET);
+/**
+ * Reads the value of SysFs attribute and records the access in the statistics and
+ * the trace.
+ *
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * hash[in] - hash of the path, as returned by sdi_sysfs_path_hash().
+ * buf[out] - buffer for the value.
+ * size[in] - size of the buffer.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_attr_read(const char *path, const char *attr, uint32_t hash, char *buf, size_t size)
+{
+    uint64_t    start = sdi_sysfs_stats_start();
+    uint64_t    trace = sdi_sysfs_trace_start();
+    t_std_error rc = STD_ERR_OK;
+
+    sdi_sysfs_sim_delay();
+    if (sdi_sysfs_trace_replaying() == true) {
+        rc = sdi_sysfs_attr_replay(path, attr, buf, size);
+    } else {
+        rc = sdi_sysfs_attr_pread(path, attr, hash, buf, size);
     }
 
-    fclose(f);
+    sdi_sysfs_stats_record(start, hash, path, attr, rc);
+    sdi_sysfs_trace_record(trace, SDI_SYSFS_TRACE_READ, path, attr, buf, (rc == STD_ERR_OK) ? strlen(buf) : 0, rc);
 
     return rc;
 }
 
 /**
- * Gets the raw data from the specified SysFs attribute.
+ * Writes the value to SysFs attribute and records the access in the statistics and
+ * the trace.
  *
  * path[in] - path to SysFs attribute.
  * attr[in] - name of SysFs attribute.
- * size[in] - size the of buffer, where raw data should be stored.
- * buf[out] - buffer, where raw data should be stored.
+ * hash[in] - hash of the path, as returned by sdi_sysfs_path_hash().
+ * buf[in] - value to write.
+ * len[in] - length of the value.
  *
  * return STD_ERR_OK on success and standard error on failure.
  */
-t_std_error sdi_sysfs_attr_data_get(const char *path, const char *attr, size_t size, char *buf)
+static t_std_error sdi_sysfs_attr_write(const char *path, const char *attr, uint32_t hash,
+                                        const char *buf, size_t len)
 {
+    uint64_t    start = sdi_sysfs_stats_start();
+    uint64_t    trace = sdi_sysfs_trace_start();
     t_std_error rc = STD_ERR_OK;
-    FILE       *f = NULL;
-    char        full_path[PATH_MAX] = {0};
+    const void *data = NULL;
+    size_t      data_len = 0;
 
-    if ((path == NULL) || (attr == NULL) || (buf == NULL) || (size == 0)) {
-        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    sdi_sysfs_sim_delay();
+    if (sdi_sysfs_trace_replaying() == true) {
+        rc = sdi_sysfs_trace_replay(SDI_SYSFS_TRACE_WRITE, path, attr, &data, &data_len);
+    } else {
+        rc = sdi_sysfs_attr_pwrite(path, attr, hash, buf, len);
     }
 
-    snprintf(full_path, sizeof(full_path) - 1, "%s%s", path, attr);
+    sdi_sysfs_stats_record(start, hash, path, attr, rc);
+    sdi_sysfs_trace_record(trace, SDI_SYSFS_TRACE_WRITE, path, attr, buf, len, rc);
 
-    if ((f = fopen(full_path, "rb")) == NULL) {
-        return SDI_ERRNO;
+    return rc;
+}
+
+/**
+ * Creates handle of SysFs attribute.
+ *
+ * The path is joined once and the existence of the attribute is checked, so the getters
+ * and setters neither format the path nor call access() afterwards.
+ *
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * type[in] - type of the attribute value.
+ * flags[in] - SDI_SYSFS_HDL_F_* flags.
+ *
+ * return handle of the attribute.
+ */
+sdi_sysfs_hdl_t sdi_sysfs_hdl_create(const char *path, const char *attr, sdi_sysfs_attr_type_t type, uint_t flags)
+{
+    sdi_sysfs_hdl_t hdl = NULL;
+    const char     *root = NULL;
+    char            full_path[PATH_MAX];
+
+    STD_ASSERT(path != NULL);
+    STD_ASSERT(attr != NULL);
+
+    hdl = (sdi_sysfs_hdl_t)calloc(1, sizeof(*hdl));
+    STD_ASSERT(hdl != NULL);
+
+    root = (*path == '/') ? sdi_sysfs_root_get() : "";
+
+    snprintf(full_path, sizeof(full_path), "%s%s%s", root, path, attr);
+    hdl->path = sdi_string_intern(full_path);
+    hdl->hash = sdi_sysfs_path_hash(hdl->path, "");
+    hdl->type = type;
+    hdl->flags = flags;
+    hdl->fd = -1;
+    pthread_rwlock_init(&hdl->lock, NULL);
+    pthread_mutex_init(&hdl->wlock, NULL);
+
+    if ((flags & SDI_SYSFS_HDL_F_SHADOW) != 0) {
+        hdl->shadow = (char*)malloc(SDI_SYSFS_VAL_MAX_LEN);
+        STD_ASSERT(hdl->shadow != NULL);
+        hdl->refresh_us = (uint64_t)SDI_SYSFS_SHADOW_REFRESH_MS * 1000;
     }
 
-    if (fread(buf, sizeof(*buf), size, f) != size) {
-        if (feof(f) || ferror(f)) {
-            rc = SDI_ERRCODE(EIO); /* I/O error */
-        }
+    if ((flags & SDI_SYSFS_HDL_F_ASYNC) != 0) {
+        hdl->pending = (char*)malloc(SDI_SYSFS_VAL_MAX_LEN);
+        STD_ASSERT(hdl->pending != NULL);
     }
 
-    fclose(f);
+    hdl->exists = (access(hdl->path, F_OK) == 0);
+    if (hdl->exists == false) {
+        hdl->retry_ts = sdi_sysfs_time_us() + SDI_SYSFS_HDL_RETRY_US;
+    } else if ((flags & SDI_SYSFS_HDL_F_PIN) != 0) {
+        hdl->fd = open(hdl->path, O_RDONLY | O_CLOEXEC);
+    }
 
-    return rc;
+    pthread_mutex_lock(&sdi_sysfs_hdl_registry.lock);
+    hdl->next = sdi_sysfs_hdl_registry.head;
+    sdi_sysfs_hdl_registry.head = hdl;
+    pthread_mutex_unlock(&sdi_sysfs_hdl_registry.lock);
+
+    return hdl;
+}
+
+/**
+ * Returns the full path of SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return full path of the attribute.
+ */
+const char * sdi_sysfs_hdl_path_get(sdi_sysfs_hdl_t hdl)
+{
+    STD_ASSERT(hdl != NULL);
+
+    return hdl->path;
+}
+
+/**
+ * Returns the hash of the full path of SysFs attribute, the key of its statistics.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return hash of the full path.
+ */
+uint32_t sdi_sysfs_hdl_hash_get(sdi_sysfs_hdl_t hdl)
+{
+    STD_ASSERT(hdl != NULL);
+
+    return hdl->hash;
+}
+
+/**
+ * Returns the type of SysFs attribute value.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return type of the attribute value.
+ */
+sdi_sysfs_attr_type_t sdi_sysfs_hdl_type_get(sdi_sysfs_hdl_t hdl)
+{
+    STD_ASSERT(hdl != NULL);
+
+    return hdl->type;
+}
+
+/**
+ * Forgets that SysFs attribute was missing, so the next access probes it right away.
+ *
+ * Used when the attribute is known to have (re)appeared, e.g. on hotplug.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return None.
+ */
+void sdi_sysfs_hdl_expire(sdi_sysfs_hdl_t hdl)
+{
+    STD_ASSERT(hdl != NULL);
+
+    __atomic_store_n(&hdl->retry_ts, 0, __ATOMIC_RELAXED);
+}
+
+/**
+ * Logs SysFs attributes, which didn't exist when their handles were created.
+ *
+ * return number of missing attributes.
+ */
+uint_t sdi_sysfs_hdl_report_missing(void)
+{
+    sdi_sysfs_hdl_t hdl = NULL;
+    uint_t          total = 0;
+    uint_t          missing = 0;
+
+    pthread_mutex_lock(&sdi_sysfs_hdl_registry.lock);
+
+    for (hdl = sdi_sysfs_hdl_registry.head; (hdl != NULL); hdl = hdl->next) {
+        total++;
+        if (__atomic_load_n(&hdl->exists, __ATOMIC_RELAXED) == false) {
+            SDI_ERRMSG_LOG("SysFs attribute %s does not exist.", hdl->path);
+            missing++;
+        }
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_hdl_registry.lock);
+
+    if (missing > 0) {
+        SDI_ERRMSG_LOG("%u of %u SysFs attributes do not exist.", missing, total);
+    }
+
+    return missing;
+}
+
+/**
+ * Checks whether the attribute may be accessed.
+ *
+ * Missing attributes are probed again only once per SDI_SYSFS_HDL_RETRY_US, in between
+ * the access fails immediately. The replayed trace decides itself which attributes
+ * exist.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return true if the attribute should be accessed, false otherwise.
+ */
+static bool sdi_sysfs_hdl_accessible(sdi_sysfs_hdl_t hdl)
+{
+    if ((__atomic_load_n(&hdl->exists, __ATOMIC_RELAXED) == true) || (sdi_sysfs_trace_replaying() == true)) {
+        return true;
+    }
+
+    return (sdi_sysfs_time_us() >= __atomic_load_n(&hdl->retry_ts, __ATOMIC_RELAXED));
+}
+
+/**
+ * Updates the existence state of the attribute after it was accessed.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * rc[in] - result of the access.
+ *
+ * return rc.
+ */
+static t_std_error sdi_sysfs_hdl_update(sdi_sysfs_hdl_t hdl, t_std_error rc)
+{
+    if (rc == SDI_ERRCODE(ENOENT)) {
+        __atomic_store_n(&hdl->retry_ts, sdi_sysfs_time_us() + SDI_SYSFS_HDL_RETRY_US, __ATOMIC_RELAXED);
+        __atomic_store_n(&hdl->exists, false, __ATOMIC_RELAXED);
+    } else if (rc == STD_ERR_OK) {
+        __atomic_store_n(&hdl->exists, true, __ATOMIC_RELAXED);
+    }
+
+    return rc;
+}
+
+/**
+ * Reads the value of SysFs attribute through the pinned descriptor.
+ *
+ * The descriptor is opened on the first access and re-opened when it goes bad.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * buf[out] - buffer for the value.
+ * size[in] - size of the buffer.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_hdl_pinned_read(sdi_sysfs_hdl_t hdl, char *buf, size_t size)
+{
+    t_std_error rc = STD_ERR_OK;
+    ssize_t     len = -1;
+    int         fd = -1;
+
+    pthread_rwlock_rdlock(&hdl->lock);
+
+    fd = hdl->fd;
+    if ((fd >= 0) && ((len = pread(fd, buf, size - 1, 0)) >= 0)) {
+        pthread_rwlock_unlock(&hdl->lock);
+        buf[len] = '\0';
+        return STD_ERR_OK;
+    }
+
+    pthread_rwlock_unlock(&hdl->lock);
+
+    /* Descriptor is not opened yet or went bad, re-open it unless somebody else did */
+    pthread_rwlock_wrlock(&hdl->lock);
+
+    if (hdl->fd == fd) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        if ((hdl->fd = open(hdl->path, O_RDONLY | O_CLOEXEC)) == -1) {
+            rc = SDI_ERRNO;
+        }
+    }
+
+    if ((rc == STD_ERR_OK) && (hdl->fd >= 0)) {
+        if ((len = pread(hdl->fd, buf, size - 1, 0)) >= 0) {
+            buf[len] = '\0';
+        } else {
+            rc = SDI_ERRNO;
+        }
+    } else if (rc == STD_ERR_OK) {
+        rc = SDI_ERRCODE(ENOENT);
+    }
+
+    pthread_rwlock_unlock(&hdl->lock);
+
+    return rc;
+}
+
+/**
+ * Reads the value of SysFs attribute as a NUL-terminated string.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * buf[out] - buffer for the value.
+ * size[in] - size of the buffer.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_hdl_read(sdi_sysfs_hdl_t hdl, char *buf, size_t size)
+{
+    t_std_error rc = STD_ERR_OK;
+    uint64_t    start = 0;
+    uint64_t    trace = 0;
+
+    if (sdi_sysfs_hdl_accessible(hdl) == false) {
+        return SDI_ERRCODE(ENOENT);
+    }
+
+    /* The replay serves pinned attributes as well, without opening them */
+    if (((hdl->flags & SDI_SYSFS_HDL_F_PIN) != 0) && (sdi_sysfs_trace_replaying() == false)) {
+        start = sdi_sysfs_stats_start();
+        trace = sdi_sysfs_trace_start();
+        sdi_sysfs_sim_delay();
+        rc = sdi_sysfs_hdl_pinned_read(hdl, buf, size);
+        sdi_sysfs_stats_record(start, hdl->hash, hdl->path, "", rc);
+        sdi_sysfs_trace_record(trace, SDI_SYSFS_TRACE_READ, hdl->path, "", buf,
+                               (rc == STD_ERR_OK) ? strlen(buf) : 0, rc);
+    } else {
+        rc = sdi_sysfs_attr_read(hdl->path, "", hdl->hash, buf, size);
+    }
+
+    return sdi_sysfs_hdl_update(hdl, rc);
+}
+
+/**
+ * Writes the value to SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * buf[in] - value to write.
+ * len[in] - length of the value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_hdl_write(sdi_sysfs_hdl_t hdl, const char *buf, size_t len)
+{
+    t_std_error rc = STD_ERR_OK;
+    uint64_t    now = 0;
+
+    if (sdi_sysfs_hdl_accessible(hdl) == false) {
+        return SDI_ERRCODE(ENOENT);
+    }
+
+    if (hdl->shadow == NULL) {
+        return sdi_sysfs_hdl_update(hdl, sdi_sysfs_attr_write(hdl->path, "", hdl->hash, buf, len));
+    }
+
+    pthread_mutex_lock(&hdl->wlock);
+
+    now = sdi_sysfs_time_us();
+
+    /* Skip re-assertion of the value, which is already there */
+    if ((hdl->shadow_len == len) && (memcmp(hdl->shadow, buf, len) == 0) &&
+        ((hdl->refresh_us == 0) || (now < hdl->shadow_ts + hdl->refresh_us))) {
+        pthread_mutex_unlock(&hdl->wlock);
+        __atomic_add_fetch(&sdi_sysfs_shadow_stats.suppressed, 1, __ATOMIC_RELAXED);
+        return STD_ERR_OK;
+    }
+
+    rc = sdi_sysfs_hdl_update(hdl, sdi_sysfs_attr_write(hdl->path, "", hdl->hash, buf, len));
+
+    /* Zero length marks unknown value, since empty values are never shadowed */
+    hdl->shadow_len = 0;
+    if ((rc == STD_ERR_OK) && (len > 0) && (len <= SDI_SYSFS_VAL_MAX_LEN)) {
+        memcpy(hdl->shadow, buf, len);
+        hdl->shadow_len = len;
+        hdl->shadow_ts = now;
+    }
+
+    pthread_mutex_unlock(&hdl->wlock);
+
+    __atomic_add_fetch(&sdi_sysfs_shadow_stats.written, 1, __ATOMIC_RELAXED);
+
+    return rc;
+}
+
+/**
+ * Sets the interval after which the shadowed value is re-written even if it didn't change.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * refresh_ms[in] - refresh interval, 0 to never re-write the same value.
+ *
+ * return None.
+ */
+void sdi_sysfs_hdl_shadow_refresh_set(sdi_sysfs_hdl_t hdl, uint_t refresh_ms)
+{
+    STD_ASSERT(hdl != NULL);
+
+    pthread_mutex_lock(&hdl->wlock);
+    hdl->refresh_us = (uint64_t)refresh_ms * 1000;
+    pthread_mutex_unlock(&hdl->wlock);
+}
+
+/**
+ * Forgets the last value written to SysFs attribute, so the next write reaches it.
+ *
+ * hdl[in] - handle of SysFs attribute, NULL is ignored.
+ *
+ * return None.
+ */
+void sdi_sysfs_hdl_shadow_invalidate(sdi_sysfs_hdl_t hdl)
+{
+    if ((hdl == NULL) || (hdl->shadow == NULL)) {
+        return;
+    }
+
+    pthread_mutex_lock(&hdl->wlock);
+    hdl->shadow_len = 0;
+    pthread_mutex_unlock(&hdl->wlock);
+}
+
+/**
+ * Gets the numbers of writes to the shadowed attributes.
+ *
+ * written[out] - number of writes which reached the attributes.
+ * suppressed[out] - number of writes skipped because the value didn't change.
+ *
+ * return None.
+ */
+void sdi_sysfs_shadow_stats_get(uint64_t *written, uint64_t *suppressed)
+{
+    STD_ASSERT(written != NULL);
+    STD_ASSERT(suppressed != NULL);
+
+    *written = __atomic_load_n(&sdi_sysfs_shadow_stats.written, __ATOMIC_RELAXED);
+    *suppressed = __atomic_load_n(&sdi_sysfs_shadow_stats.suppressed, __ATOMIC_RELAXED);
+}
+
+/**
+ * Gets the string value from SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[out] - retrieved value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_str_get(sdi_sysfs_hdl_t hdl, char *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN] = {0};
+
+    if ((hdl == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    if ((rc = sdi_sysfs_hdl_read(hdl, buf, sizeof(buf))) != STD_ERR_OK) {
+        return rc;
+    }
+
+    return sdi_sysfs_codec_str_parse(buf, sizeof(buf), val, SDI_SYSFS_VAL_MAX_LEN);
+}
+
+/**
+ * Gets the unsigned integer value from SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[out] - retrieved value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_uint_get(sdi_sysfs_hdl_t hdl, uint_t *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN] = {0};
+
+    if ((hdl == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    if ((rc = sdi_sysfs_hdl_read(hdl, buf, sizeof(buf))) != STD_ERR_OK) {
+        return rc;
+    }
+
+    return sdi_sysfs_codec_uint_parse(buf, sizeof(buf), val);
+}
+
+/**
+ * Gets the integer value from SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[out] - retrieved value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_int_get(sdi_sysfs_hdl_t hdl, int *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN] = {0};
+
+    if ((hdl == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    if ((rc = sdi_sysfs_hdl_read(hdl, buf, sizeof(buf))) != STD_ERR_OK) {
+        return rc;
+    }
+
+    return sdi_sysfs_codec_int_parse(buf, sizeof(buf), val);
+}
+
+/**
+ * Gets the temperature from SysFs attribute, which reports it in millidegrees.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[out] - retrieved temperature in degrees (Celsius).
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_mdeg_get(sdi_sysfs_hdl_t hdl, int *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN] = {0};
+
+    if ((hdl == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    if ((rc = sdi_sysfs_hdl_read(hdl, buf, sizeof(buf))) != STD_ERR_OK) {
+        return rc;
+    }
+
+    return sdi_sysfs_codec_mdeg_parse(buf, sizeof(buf), val);
+}
+
+/**
+ * Writer thread, which drains the write queue.
+ *
+ * arg[in] - unused.
+ *
+ * return NULL.
+ */
+static void * sdi_sysfs_wq_thread(void *arg)
+{
+    sdi_sysfs_hdl_t hdl = NULL;
+    char            buf[SDI_SYSFS_VAL_MAX_LEN];
+    size_t          len = 0;
+    uint64_t        seq = 0;
+    t_std_error     rc = STD_ERR_OK;
+
+    pthread_mutex_lock(&sdi_sysfs_wq.lock);
+
+    while (sdi_sysfs_wq.stop == false) {
+        if ((hdl = sdi_sysfs_wq.head) == NULL) {
+            pthread_cond_wait(&sdi_sysfs_wq.push, &sdi_sysfs_wq.lock);
+            continue;
+        }
+
+        sdi_sysfs_wq.head = hdl->wq_next;
+        if (sdi_sysfs_wq.head == NULL) {
+            sdi_sysfs_wq.tail = NULL;
+        }
+        sdi_sysfs_wq.busy = hdl;
+
+        /* Writes pushed from now on queue the handle again */
+        hdl->queued = false;
+        hdl->wq_next = NULL;
+        len = hdl->pending_len;
+        memcpy(buf, hdl->pending, len);
+        seq = hdl->queued_seq;
+
+        pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+
+        rc = sdi_sysfs_hdl_write(hdl, buf, len);
+        if (rc != STD_ERR_OK) {
+            SDI_ERRMSG_LOG("Queued write of %s failed (rc=%d)\n", hdl->path, rc);
+        }
+
+        pthread_mutex_lock(&sdi_sysfs_wq.lock);
+
+        hdl->async_rc = rc;
+        hdl->done_seq = seq;
+        sdi_sysfs_wq.busy = NULL;
+        pthread_cond_broadcast(&sdi_sysfs_wq.done);
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+
+    return NULL;
+}
+
+/**
+ * Pushes the value to the write queue, replacing the value still pending for the handle.
+ *
+ * If the queue is not running, the value is written synchronously.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * buf[in] - value to write.
+ * len[in] - length of the value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_wq_push(sdi_sysfs_hdl_t hdl, const char *buf, size_t len)
+{
+    pthread_mutex_lock(&sdi_sysfs_wq.lock);
+
+    if ((sdi_sysfs_wq.running == false) || (len > SDI_SYSFS_VAL_MAX_LEN)) {
+        pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+        return sdi_sysfs_hdl_write(hdl, buf, len);
+    }
+
+    memcpy(hdl->pending, buf, len);
+    hdl->pending_len = len;
+    ++hdl->queued_seq;
+
+    if (hdl->queued == false) {
+        hdl->queued = true;
+        if (sdi_sysfs_wq.tail != NULL) {
+            sdi_sysfs_wq.tail->wq_next = hdl;
+        } else {
+            sdi_sysfs_wq.head = hdl;
+        }
+        sdi_sysfs_wq.tail = hdl;
+        pthread_cond_signal(&sdi_sysfs_wq.push);
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Writes the value to SysFs attribute or queues it if the attribute is asynchronous.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * buf[in] - value to write.
+ * len[in] - length of the value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_hdl_set(sdi_sysfs_hdl_t hdl, const char *buf, size_t len)
+{
+    if (hdl->pending != NULL) {
+        return sdi_sysfs_wq_push(hdl, buf, len);
+    }
+
+    return sdi_sysfs_hdl_write(hdl, buf, len);
+}
+
+/**
+ * Starts the writer thread, so writes to SDI_SYSFS_HDL_F_ASYNC attributes are queued.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_async_start(void)
+{
+    int err = 0;
+
+    pthread_mutex_lock(&sdi_sysfs_wq.lock);
+
+    if (sdi_sysfs_wq.running == true) {
+        pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+        return SDI_ERRCODE(EALREADY); /* Operation already in progress */
+    }
+
+    sdi_sysfs_wq.stop = false;
+
+    if ((err = pthread_create(&sdi_sysfs_wq.thread, NULL, sdi_sysfs_wq_thread, NULL)) != 0) {
+        pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+        SDI_ERRMSG_LOG("Failed to start SysFs writer (errno=%d), attributes are written directly\n", err);
+        return SDI_ERRCODE(err);
+    }
+
+    sdi_sysfs_wq.running = true;
+    pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Completes the queued writes and stops the writer thread.
+ *
+ * Writes issued after that are synchronous again.
+ *
+ * return None.
+ */
+void sdi_sysfs_async_stop(void)
+{
+    pthread_mutex_lock(&sdi_sysfs_wq.lock);
+
+    if (sdi_sysfs_wq.running == false) {
+        pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+        return;
+    }
+
+    /* Writes pushed meanwhile are drained too, so none of them is overtaken */
+    while ((sdi_sysfs_wq.head != NULL) || (sdi_sysfs_wq.busy != NULL)) {
+        pthread_cond_wait(&sdi_sysfs_wq.done, &sdi_sysfs_wq.lock);
+    }
+
+    sdi_sysfs_wq.running = false;
+    sdi_sysfs_wq.stop = true;
+    pthread_cond_signal(&sdi_sysfs_wq.push);
+    pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+
+    pthread_join(sdi_sysfs_wq.thread, NULL);
+}
+
+/**
+ * Waits until all the writes queued so far are completed.
+ *
+ * return None.
+ */
+void sdi_sysfs_async_flush(void)
+{
+    pthread_mutex_lock(&sdi_sysfs_wq.lock);
+
+    while ((sdi_sysfs_wq.head != NULL) || (sdi_sysfs_wq.busy != NULL)) {
+        pthread_cond_wait(&sdi_sysfs_wq.done, &sdi_sysfs_wq.lock);
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+}
+
+/**
+ * Waits until the writes to SysFs attribute queued so far are completed.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ *
+ * return result of the last completed write, STD_ERR_OK if the attribute is synchronous.
+ */
+t_std_error sdi_sysfs_hdl_flush(sdi_sysfs_hdl_t hdl)
+{
+    t_std_error rc = STD_ERR_OK;
+    uint64_t    seq = 0;
+
+    if (hdl == NULL) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    if (hdl->pending == NULL) {
+        return STD_ERR_OK;
+    }
+
+    pthread_mutex_lock(&sdi_sysfs_wq.lock);
+
+    seq = hdl->queued_seq;
+    while (hdl->done_seq < seq) {
+        pthread_cond_wait(&sdi_sysfs_wq.done, &sdi_sysfs_wq.lock);
+    }
+    rc = hdl->async_rc;
+
+    pthread_mutex_unlock(&sdi_sysfs_wq.lock);
+
+    return rc;
+}
+
+/**
+ * Worker thread, which executes the timed reads.
+ *
+ * arg[in] - unused.
+ *
+ * return NULL.
+ */
+static void * sdi_sysfs_rq_thread(void *arg)
+{
+    sdi_sysfs_hdl_t hdl = NULL;
+    char            buf[SDI_SYSFS_VAL_MAX_LEN];
+    t_std_error     rc = STD_ERR_OK;
+
+    pthread_mutex_lock(&sdi_sysfs_rq.lock);
+
+    for (;;) {
+        if ((hdl = sdi_sysfs_rq.head) == NULL) {
+            sdi_sysfs_rq.idle++;
+            pthread_cond_wait(&sdi_sysfs_rq.push, &sdi_sysfs_rq.lock);
+            sdi_sysfs_rq.idle--;
+            continue;
+        }
+
+        sdi_sysfs_rq.head = hdl->rq_next;
+        if (sdi_sysfs_rq.head == NULL) {
+            sdi_sysfs_rq.tail = NULL;
+        }
+        sdi_sysfs_rq.queued--;
+        hdl->rq_next = NULL;
+        hdl->rd_start_us = sdi_sysfs_time_us();
+
+        pthread_mutex_unlock(&sdi_sysfs_rq.lock);
+
+        /* May block for long, the callers give up on their deadlines meanwhile */
+        rc = sdi_sysfs_hdl_read(hdl, buf, sizeof(buf));
+
+        pthread_mutex_lock(&sdi_sysfs_rq.lock);
+
+        if (rc == STD_ERR_OK) {
+            memcpy(hdl->last, buf, sizeof(buf));
+            hdl->last_valid = true;
+        }
+
+        /* The attribute responds again, even if with an error */
+        hdl->timeouts = 0;
+        hdl->quarantine_ts = 0;
+        hdl->rd_rc = rc;
+        hdl->rd_done = hdl->rd_seq;
+        hdl->rd_pending = false;
+        pthread_cond_broadcast(&sdi_sysfs_rq.done);
+
+        /* Extra workers go away, a read queued while the rest are stuck starts a new one */
+        if ((sdi_sysfs_rq.workers > SDI_SYSFS_TIMED_WORKERS) && (sdi_sysfs_rq.head == NULL)) {
+            sdi_sysfs_rq.workers--;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_rq.lock);
+
+    return NULL;
+}
+
+/**
+ * Starts a worker thread of the timed reads.
+ *
+ * To be called under the queue lock.
+ *
+ * return None.
+ */
+static void sdi_sysfs_rq_spawn(void)
+{
+    pthread_attr_t thread_attr;
+    pthread_t      thread;
+    int            err = 0;
+
+    pthread_attr_init(&thread_attr);
+    pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED);
+
+    if ((err = pthread_create(&thread, &thread_attr, sdi_sysfs_rq_thread, NULL)) != 0) {
+        SDI_ERRMSG_LOG("Failed to start SysFs read worker (errno=%d)\n", err);
+    } else {
+        sdi_sysfs_rq.workers++;
+    }
+
+    pthread_attr_destroy(&thread_attr);
+}
+
+/**
+ * Starts the worker threads of the timed reads.
+ *
+ * return None.
+ */
+static void sdi_sysfs_rq_init(void)
+{
+    pthread_condattr_t attr;
+    uint_t             i = 0;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sdi_sysfs_rq.done, &attr);
+    pthread_condattr_destroy(&attr);
+
+    pthread_mutex_lock(&sdi_sysfs_rq.lock);
+    for (i = 0; i < SDI_SYSFS_TIMED_WORKERS; i++) {
+        sdi_sysfs_rq_spawn();
+    }
+    pthread_mutex_unlock(&sdi_sysfs_rq.lock);
+}
+
+/**
+ * Reads the value of SysFs attribute on a worker thread, waiting for it until the deadline.
+ *
+ * The timeout runs from the moment a worker takes the read, so a read which waited in
+ * the queue gets its whole timeout too; the wait is never longer than twice the
+ * timeout. If the deadline passes, the read keeps running and its value is kept for
+ * the later calls. A read which never left the queue doesn't count against the
+ * attribute. An attribute which timed out SDI_SYSFS_QUARANTINE_COUNT times in a row isn't
+ * read for SDI_SYSFS_QUARANTINE_US, unless its pending read completes meanwhile. If it
+ * is still wedged afterwards, the next SDI_SYSFS_QUARANTINE_COUNT timeouts quarantine it again.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * timeout_ms[in] - time to wait for the value.
+ * buf[out] - buffer for the value, holds the last known value on timeout, empty if none.
+ * size[in] - size of the buffer, at least SDI_SYSFS_VAL_MAX_LEN.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed or the attribute is
+ * quarantined and standard error on other failures.
+ */
+static t_std_error sdi_sysfs_hdl_read_timed(sdi_sysfs_hdl_t hdl, uint_t timeout_ms, char *buf, size_t size)
+{
+    t_std_error     rc = STD_ERR_OK;
+    struct timespec deadline;
+    uint64_t        seq = 0;
+    uint64_t        now = 0;
+    uint64_t        end_us = 0;
+    bool            extended = false;
+    int             err = 0;
+
+    STD_ASSERT(size >= SDI_SYSFS_VAL_MAX_LEN);
+
+    *buf = '\0';
+
+    pthread_once(&sdi_sysfs_rq.once, sdi_sysfs_rq_init);
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&sdi_sysfs_rq.lock);
+
+    if (hdl->last == NULL) {
+        hdl->last = (char*)calloc(1, SDI_SYSFS_VAL_MAX_LEN);
+        STD_ASSERT(hdl->last != NULL);
+    }
+
+    now = sdi_sysfs_time_us();
+
+    if (now >= hdl->quarantine_ts) {
+        if (hdl->rd_pending == false) {
+            hdl->rd_pending = true;
+            hdl->rd_start_us = 0;
+            hdl->rd_seq++;
+            if (sdi_sysfs_rq.tail != NULL) {
+                sdi_sysfs_rq.tail->rq_next = hdl;
+            } else {
+                sdi_sysfs_rq.head = hdl;
+            }
+            sdi_sysfs_rq.tail = hdl;
+            sdi_sysfs_rq.queued++;
+
+            /* The busy workers may be stuck in wedged reads */
+            if ((sdi_sysfs_rq.queued > sdi_sysfs_rq.idle) && (sdi_sysfs_rq.workers < SDI_SYSFS_TIMED_WORKERS_MAX)) {
+                sdi_sysfs_rq_spawn();
+            }
+            pthread_cond_signal(&sdi_sysfs_rq.push);
+        }
+
+        seq = hdl->rd_seq;
+        while ((hdl->rd_done < seq) && (err != ETIMEDOUT)) {
+            err = pthread_cond_timedwait(&sdi_sysfs_rq.done, &sdi_sysfs_rq.lock, &deadline);
+
+            /* The timeout is counted from the moment a worker took the read, not queued it */
+            end_us = hdl->rd_start_us + (uint64_t)timeout_ms * 1000;
+            if ((err == ETIMEDOUT) && (extended == false) && (hdl->rd_done < seq) &&
+                (hdl->rd_start_us != 0) && (end_us > sdi_sysfs_time_us())) {
+                extended = true;
+                deadline.tv_sec = end_us / 1000000;
+                deadline.tv_nsec = (long)(end_us % 1000000) * 1000;
+                err = 0;
+            }
+        }
+    }
+
+    if ((now >= hdl->quarantine_ts) && (hdl->rd_done >= seq)) {
+        rc = hdl->rd_rc;
+    } else {
+        rc = SDI_ERRCODE(ETIMEDOUT);
+
+        /* A read still in the queue says nothing about the driver */
+        if ((now >= hdl->quarantine_ts) && (hdl->rd_start_us != 0) &&
+            (++hdl->timeouts == SDI_SYSFS_QUARANTINE_COUNT)) {
+            /* Counted anew, so an attribute still wedged afterwards is quarantined again */
+            hdl->timeouts = 0;
+            hdl->quarantine_ts = now + SDI_SYSFS_QUARANTINE_US;
+            SDI_ERRMSG_LOG("Reads of %s timed out %u times, quarantined\n", hdl->path,
+                           SDI_SYSFS_QUARANTINE_COUNT);
+        }
+    }
+
+    if ((rc == STD_ERR_OK) || (rc == SDI_ERRCODE(ETIMEDOUT))) {
+        if (hdl->last_valid == true) {
+            memcpy(buf, hdl->last, SDI_SYSFS_VAL_MAX_LEN);
+        }
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_rq.lock);
+
+    return rc;
+}
+
+/**
+ * Gets the string value from SysFs attribute, waiting for it until the deadline.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * timeout_ms[in] - time to wait for the value.
+ * val[out] - retrieved value, the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed (val is set if the
+ * value is known) and standard error on other failures.
+ */
+t_std_error sdi_sysfs_hdl_str_get_timed(sdi_sysfs_hdl_t hdl, uint_t timeout_ms, char *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    t_std_error parse_rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN];
+
+    if ((hdl == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    rc = sdi_sysfs_hdl_read_timed(hdl, timeout_ms, buf, sizeof(buf));
+    if ((rc != STD_ERR_OK) && (*buf == '\0')) {
+        return rc;
+    }
+
+    parse_rc = sdi_sysfs_codec_str_parse(buf, sizeof(buf), val, SDI_SYSFS_VAL_MAX_LEN);
+
+    return (rc != STD_ERR_OK) ? rc : parse_rc;
+}
+
+/**
+ * Gets the unsigned integer value from SysFs attribute, waiting for it until the deadline.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * timeout_ms[in] - time to wait for the value.
+ * val[out] - retrieved value, the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed (val is set if the
+ * value is known) and standard error on other failures.
+ */
+t_std_error sdi_sysfs_hdl_uint_get_timed(sdi_sysfs_hdl_t hdl, uint_t timeout_ms, uint_t *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    t_std_error parse_rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN];
+
+    if ((hdl == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    rc = sdi_sysfs_hdl_read_timed(hdl, timeout_ms, buf, sizeof(buf));
+    if ((rc != STD_ERR_OK) && (*buf == '\0')) {
+        return rc;
+    }
+
+    parse_rc = sdi_sysfs_codec_uint_parse(buf, sizeof(buf), val);
+
+    return (rc != STD_ERR_OK) ? rc : parse_rc;
+}
+
+/**
+ * Gets the integer value from SysFs attribute, waiting for it until the deadline.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * timeout_ms[in] - time to wait for the value.
+ * val[out] - retrieved value, the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed (val is set if the
+ * value is known) and standard error on other failures.
+ */
+t_std_error sdi_sysfs_hdl_int_get_timed(sdi_sysfs_hdl_t hdl, uint_t timeout_ms, int *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    t_std_error parse_rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN];
+
+    if ((hdl == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    rc = sdi_sysfs_hdl_read_timed(hdl, timeout_ms, buf, sizeof(buf));
+    if ((rc != STD_ERR_OK) && (*buf == '\0')) {
+        return rc;
+    }
+
+    parse_rc = sdi_sysfs_codec_int_parse(buf, sizeof(buf), val);
+
+    return (rc != STD_ERR_OK) ? rc : parse_rc;
+}
+
+/**
+ * Gets the temperature from SysFs attribute in millidegrees, waiting for it until the deadline.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * timeout_ms[in] - time to wait for the value.
+ * val[out] - retrieved temperature in degrees (Celsius), the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed (val is set if the
+ * value is known) and standard error on other failures.
+ */
+t_std_error sdi_sysfs_hdl_mdeg_get_timed(sdi_sysfs_hdl_t hdl, uint_t timeout_ms, int *val)
+{
+    t_std_error rc = STD_ERR_OK;
+    t_std_error parse_rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN];
+
+    if ((hdl == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    rc = sdi_sysfs_hdl_read_timed(hdl, timeout_ms, buf, sizeof(buf));
+    if ((rc != STD_ERR_OK) && (*buf == '\0')) {
+        return rc;
+    }
+
+    parse_rc = sdi_sysfs_codec_mdeg_parse(buf, sizeof(buf), val);
+
+    return (rc != STD_ERR_OK) ? rc : parse_rc;
+}
+
+/**
+ * Sets string value for SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[in] - value which should be set.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_str_set(sdi_sysfs_hdl_t hdl, const char *val)
+{
+    if ((hdl == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    return sdi_sysfs_hdl_set(hdl, val, strlen(val));
+}
+
+/**
+ * Sets the unsigned integer value for SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * val[in] - value which should be set.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_uint_set(sdi_sysfs_hdl_t hdl, uint_t val)
+{
+    char   buf[SDI_SYSFS_VAL_MAX_LEN] = {0};
+    size_t len = 0;
+
+    if (hdl == NULL) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    len = sdi_sysfs_codec_uint_format(val, buf, sizeof(buf));
+
+    return sdi_sysfs_hdl_set(hdl, buf, len);
+}
+
+#ifdef SDI_SYSFS_USE_IO_URING
+/**
+ * Creates the ring and checks that the kernel supports IORING_OP_READ.
+ *
+ * To be called under the ring lock.
+ *
+ * return None.
+ */
+static void sdi_sysfs_uring_init(void)
+{
+    struct io_uring_probe *probe = NULL;
+
+    sdi_sysfs_uring.init_done = true;
+
+    if (io_uring_queue_init(SDI_SYSFS_BATCH_CHUNK, &sdi_sysfs_uring.ring, 0) != 0) {
+        return;
+    }
+
+    probe = io_uring_get_probe_ring(&sdi_sysfs_uring.ring);
+    sdi_sysfs_uring.available = (probe != NULL) && io_uring_opcode_supported(probe, IORING_OP_READ);
+    if (probe != NULL) {
+        io_uring_free_probe(probe);
+    }
+
+    if (sdi_sysfs_uring.available == false) {
+        io_uring_queue_exit(&sdi_sysfs_uring.ring);
+    }
+}
+
+/**
+ * Reads the pending batch slots through io_uring in one submission.
+ *
+ * The reads complete into the buffers of the ring and are copied to the slots, so a
+ * read the ring lost track of never writes into the caller's memory. A failed read
+ * only fails its own slot. Slots the ring couldn't read stay pending, they are read
+ * with pread() by the caller.
+ *
+ * slots[in,out] - slots to read, only the ones with res -EINPROGRESS are read.
+ * count[in] - number of slots, not more than SDI_SYSFS_BATCH_CHUNK.
+ *
+ * return None.
+ */
+static void sdi_sysfs_uring_read(sdi_sysfs_batch_slot_t *slots, size_t count)
+{
+    struct io_uring_sqe    *sqe = NULL;
+    struct io_uring_cqe    *cqe = NULL;
+    sdi_sysfs_batch_slot_t *slot = NULL;
+    size_t                  i = 0;
+    int                     queued = 0;
+    int                     submitted = 0;
+    int                     reaped = 0;
+    int                     ret = 0;
+
+    pthread_mutex_lock(&sdi_sysfs_uring.lock);
+
+    if (sdi_sysfs_uring.init_done == false) {
+        sdi_sysfs_uring_init();
+    }
+
+    if (sdi_sysfs_uring.available == false) {
+        pthread_mutex_unlock(&sdi_sysfs_uring.lock);
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (slots[i].res != -EINPROGRESS) {
+            continue;
+        }
+
+        /* The ring has a submission entry for each slot of a chunk */
+        sqe = io_uring_get_sqe(&sdi_sysfs_uring.ring);
+        STD_ASSERT(sqe != NULL);
+
+        io_uring_prep_read(sqe, slots[i].fd, sdi_sysfs_uring.buf[i], sizeof(sdi_sysfs_uring.buf[i]) - 1, 0);
+        io_uring_sqe_set_data(sqe, &slots[i]);
+        queued++;
+    }
+
+    if (queued == 0) {
+        pthread_mutex_unlock(&sdi_sysfs_uring.lock);
+        return;
+    }
+
+    if ((submitted = io_uring_submit(&sdi_sysfs_uring.ring)) < 0) {
+        submitted = 0;
+    }
+
+    while (reaped < submitted) {
+        if ((ret = io_uring_wait_cqe(&sdi_sysfs_uring.ring, &cqe)) == -EINTR) {
+            continue;
+        }
+        if (ret != 0) {
+            break;
+        }
+
+        slot = (sdi_sysfs_batch_slot_t*)io_uring_cqe_get_data(cqe);
+        slot->res = cqe->res;
+        if (cqe->res > 0) {
+            memcpy(slot->buf, sdi_sysfs_uring.buf[slot - slots], cqe->res);
+        }
+        io_uring_cqe_seen(&sdi_sysfs_uring.ring, cqe);
+        reaped++;
+    }
+
+    if (reaped < submitted) {
+        /* Reads may still complete into the buffers, so the ring is abandoned, not torn down */
+        SDI_ERRMSG_LOG("io_uring completion failed (errno=%d), batch reads use pread()\n", -ret);
+        sdi_sysfs_uring.available = false;
+    } else if (submitted < queued) {
+        /* Nothing is in flight, the entries left unsubmitted go away with the ring */
+        SDI_ERRMSG_LOG("io_uring submitted %d of %d reads, batch reads use pread()\n", submitted, queued);
+        io_uring_queue_exit(&sdi_sysfs_uring.ring);
+        sdi_sysfs_uring.available = false;
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_uring.lock);
+}
+#endif
+
+/**
+ * Reads the batch slots.
+ *
+ * slots[in,out] - slots to read, the ones with fd -1 are skipped.
+ * count[in] - number of slots, not more than SDI_SYSFS_BATCH_CHUNK.
+ *
+ * return None.
+ */
+static void sdi_sysfs_batch_read(sdi_sysfs_batch_slot_t *slots, size_t count)
+{
+    size_t i = 0;
+
+    for (i = 0; i < count; i++) {
+        slots[i].res = (slots[i].fd >= 0) ? -EINPROGRESS : -EBADF;
+    }
+
+#ifdef SDI_SYSFS_USE_IO_URING
+    sdi_sysfs_uring_read(slots, count);
+#endif
+
+    for (i = 0; i < count; i++) {
+        if ((slots[i].res == -EINPROGRESS) &&
+            ((slots[i].res = pread(slots[i].fd, slots[i].buf, sizeof(slots[i].buf) - 1, 0)) < 0)) {
+            slots[i].res = -errno;
+        }
+    }
+}
+
+/**
+ * Takes the descriptor of SysFs attribute for the batch read.
+ *
+ * Pinned descriptors are read-locked until sdi_sysfs_batch_fd_put(), the others are
+ * taken from the fd cache.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * slot[out] - slot to store the descriptor in, fd is -1 if it isn't available.
+ *
+ * return None.
+ */
+static void sdi_sysfs_batch_fd_get(sdi_sysfs_hdl_t hdl, sdi_sysfs_batch_slot_t *slot)
+{
+    slot->entry = NULL;
+    slot->fd = -1;
+
+    /* Attributes without a descriptor are read one by one, which the replay serves */
+    if ((sdi_sysfs_hdl_accessible(hdl) == false) || (sdi_sysfs_trace_replaying() == true)) {
+        return;
+    }
+
+    if ((hdl->flags & SDI_SYSFS_HDL_F_PIN) != 0) {
+        pthread_rwlock_rdlock(&hdl->lock);
+        if ((slot->fd = hdl->fd) < 0) {
+            pthread_rwlock_unlock(&hdl->lock);
+        }
+    } else if (sdi_sysfs_fd_get(hdl->path, "", hdl->hash, O_RDONLY, &slot->entry, &slot->fd) != STD_ERR_OK) {
+        slot->fd = -1;
+    }
+}
+
+/**
+ * Releases the descriptor taken by sdi_sysfs_batch_fd_get().
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * slot[in] - slot holding the descriptor.
+ *
+ * return None.
+ */
+static void sdi_sysfs_batch_fd_put(sdi_sysfs_hdl_t hdl, sdi_sysfs_batch_slot_t *slot)
+{
+    if (slot->fd < 0) {
+        return;
+    }
+
+    if ((hdl->flags & SDI_SYSFS_HDL_F_PIN) != 0) {
+        pthread_rwlock_unlock(&hdl->lock);
+    } else {
+        sdi_sysfs_fd_put(slot->entry, slot->fd, (slot->res < 0));
+    }
+}
+
+/**
+ * Parses the raw value of the batch item according to the attribute type.
+ *
+ * item[in,out] - batch item.
+ * buf[in] - raw value of the attribute.
+ * size[in] - size of the buffer.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_batch_parse(sdi_sysfs_batch_item_t *item, const char *buf, size_t size)
+{
+    switch (item->hdl->type) {
+        case SDI_SYSFS_ATTR_STR:
+            return sdi_sysfs_codec_str_parse(buf, size, item->val.str_val, sizeof(item->val.str_val));
+        case SDI_SYSFS_ATTR_UINT:
+            return sdi_sysfs_codec_uint_parse(buf, size, &item->val.uint_val);
+        case SDI_SYSFS_ATTR_INT:
+            return sdi_sysfs_codec_int_parse(buf, size, &item->val.int_val);
+        default:
+            return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+}
+
+/**
+ * Reads and parses a chunk of the batch.
+ *
+ * items[in,out] - batch items.
+ * count[in] - number of items, not more than SDI_SYSFS_BATCH_CHUNK.
+ *
+ * return None.
+ */
+static void sdi_sysfs_batch_chunk_get(sdi_sysfs_batch_item_t *items, size_t count)
+{
+    sdi_sysfs_batch_slot_t slots[SDI_SYSFS_BATCH_CHUNK];
+    size_t                 i = 0;
+    uint64_t               start = 0;
+    uint64_t               trace = 0;
+
+    for (i = 0; i < count; i++) {
+        slots[i].fd = -1;
+        if (items[i].hdl != NULL) {
+            sdi_sysfs_batch_fd_get(items[i].hdl, &slots[i]);
+        }
+    }
+
+    /* Reads of a batch are issued together, so they are delayed once */
+    start = sdi_sysfs_stats_start();
+    trace = sdi_sysfs_trace_start();
+    sdi_sysfs_sim_delay();
+    sdi_sysfs_batch_read(slots, count);
+
+    for (i = 0; i < count; i++) {
+        if (items[i].hdl == NULL) {
+            items[i].rc = SDI_ERRCODE(EINVAL); /* Invalid argument */
+            continue;
+        }
+
+        sdi_sysfs_batch_fd_put(items[i].hdl, &slots[i]);
+
+        if (slots[i].res >= 0) {
+            /* Each attribute read in the batch took as long as the whole batch */
+            sdi_sysfs_stats_record(start, items[i].hdl->hash, items[i].hdl->path, "", STD_ERR_OK);
+            sdi_sysfs_trace_record(trace, SDI_SYSFS_TRACE_READ, items[i].hdl->path, "", slots[i].buf,
+                                   slots[i].res, STD_ERR_OK);
+            slots[i].buf[slots[i].res] = '\0';
+            items[i].rc = sdi_sysfs_hdl_update(items[i].hdl, STD_ERR_OK);
+        } else {
+            /* Not read in the batch, the regular path re-opens the attribute if needed */
+            items[i].rc = sdi_sysfs_hdl_read(items[i].hdl, slots[i].buf, sizeof(slots[i].buf));
+        }
+
+        if (items[i].rc == STD_ERR_OK) {
+            items[i].rc = sdi_sysfs_batch_parse(&items[i], slots[i].buf, sizeof(slots[i].buf));
+        }
+    }
+}
+
+/**
+ * Gets the values of several SysFs attributes at once.
+ *
+ * Descriptors of all attributes are taken first and the reads are submitted together,
+ * through io_uring when it is available and with pread() otherwise. Each value is
+ * parsed according to the type of its handle.
+ *
+ * items[in,out] - attributes to read, the values and results are stored in them.
+ * count[in] - number of items.
+ *
+ * return STD_ERR_OK if all attributes were read, otherwise the result of the first failed item.
+ */
+t_std_error sdi_sysfs_attr_batch_get(sdi_sysfs_batch_item_t *items, size_t count)
+{
+    size_t i = 0;
+
+    if ((items == NULL) && (count > 0)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    for (i = 0; i < count; i += SDI_SYSFS_BATCH_CHUNK) {
+        sdi_sysfs_batch_chunk_get(&items[i], ((count - i) < SDI_SYSFS_BATCH_CHUNK) ? (count - i) : SDI_SYSFS_BATCH_CHUNK);
+    }
+
+    for (i = 0; i < count; i++) {
+        if (items[i].rc != STD_ERR_OK) {
+            return items[i].rc;
+        }
+    }
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Grows the raw data buffer, moving the data out of caller storage if needed.
+ *
+ * buf[in,out] - buffer to grow.
+ * size[in] - new size of the buffer.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_buf_grow(sdi_sysfs_buf_t *buf, size_t size)
+{
+    char *data = NULL;
+
+    if (buf->owned == true) {
+        if ((data = (char*)realloc(buf->data, size)) == NULL) {
+            return SDI_ERRCODE(ENOMEM); /* Out of memory */
+        }
+    } else {
+        if ((data = (char*)malloc(size)) == NULL) {
+            return SDI_ERRCODE(ENOMEM); /* Out of memory */
+        }
+        if (buf->len > 0) {
+            memcpy(data, buf->data, buf->len);
+        }
+    }
+
+    buf->data = data;
+    buf->size = size;
+    buf->owned = true;
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Reads the raw data of SysFs attribute in a single pass.
+ *
+ * The attribute is opened once and read until EOF. The size reported by stat() is only
+ * a hint: binary attributes may report 0 and are then read until EOF as well.
+ *
+ * fd[in] - descriptor of the attribute.
+ * buf[in,out] - buffer for the data.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+static t_std_error sdi_sysfs_data_read(int fd, sdi_sysfs_buf_t *buf)
+{
+    struct stat st;
+    t_std_error rc = STD_ERR_OK;
+    size_t      hint = 0;
+    ssize_t     len = 0;
+
+    if ((fstat(fd, &st) == 0) && (st.st_size > 0)) {
+        hint = st.st_size;
+    }
+
+    if ((buf->size < hint) && ((rc = sdi_sysfs_buf_grow(buf, hint)) != STD_ERR_OK)) {
+        return rc;
+    }
+
+    for (;;) {
+        if (buf->len == buf->size) {
+            /* Binary attributes don't return more than their size, skip the read of EOF */
+            if ((hint > 0) && (buf->len >= hint)) {
+                break;
+            }
+
+            if ((rc = sdi_sysfs_buf_grow(buf, (buf->size > 0) ? (buf->size * 2) : SDI_SYSFS_DATA_MIN_SIZE))
+                != STD_ERR_OK) {
+                return rc;
+            }
+        }
+
+        if ((len = pread(fd, buf->data + buf->len, buf->size - buf->len, buf->len)) < 0) {
+            return SDI_ERRNO;
+        }
+
+        if (len == 0) {
+            break;
+        }
+
+        buf->len += len;
+    }
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Serves the read of raw data of SysFs attribute from the replayed trace.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * buf[in,out] - buffer for the data.
+ *
+ * return recorded result of the read.
+ */
+static t_std_error sdi_sysfs_data_replay(sdi_sysfs_hdl_t hdl, sdi_sysfs_buf_t *buf)
+{
+    const void *data = NULL;
+    size_t      len = 0;
+    t_std_error replay_rc = sdi_sysfs_trace_replay(SDI_SYSFS_TRACE_READ, hdl->path, "", &data, &len);
+    t_std_error rc = STD_ERR_OK;
+
+    if ((buf->size < len) && ((rc = sdi_sysfs_buf_grow(buf, len)) != STD_ERR_OK)) {
+        return rc;
+    }
+
+    if (len > 0) {
+        memcpy(buf->data, data, len);
+    }
+    buf->len = len;
+
+    return replay_rc;
+}
+
+/**
+ * Reads the raw data of SysFs attribute.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * buf[in,out] - buffer for the data.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_hdl_data_read(sdi_sysfs_hdl_t hdl, sdi_sysfs_buf_t *buf)
+{
+    sdi_sysfs_fd_entry_t *entry = NULL;
+    t_std_error           rc = STD_ERR_OK;
+    int                   fd = -1;
+    uint64_t              start = 0;
+    uint64_t              trace = 0;
+
+    if ((hdl == NULL) || (buf == NULL) || ((buf->data == NULL) && (buf->size > 0))) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    buf->len = 0;
+
+    if (sdi_sysfs_hdl_accessible(hdl) == false) {
+        return SDI_ERRCODE(ENOENT);
+    }
+
+    start = sdi_sysfs_stats_start();
+    trace = sdi_sysfs_trace_start();
+    sdi_sysfs_sim_delay();
+    if (sdi_sysfs_trace_replaying() == true) {
+        rc = sdi_sysfs_data_replay(hdl, buf);
+    } else if ((rc = sdi_sysfs_fd_get(hdl->path, "", hdl->hash, O_RDONLY, &entry, &fd)) == STD_ERR_OK) {
+        rc = sdi_sysfs_data_read(fd, buf);
+        sdi_sysfs_fd_put(entry, fd, (rc != STD_ERR_OK));
+    }
+    sdi_sysfs_stats_record(start, hdl->hash, hdl->path, "", rc);
+    sdi_sysfs_trace_record(trace, SDI_SYSFS_TRACE_READ, hdl->path, "", buf->data, buf->len, rc);
+
+    return sdi_sysfs_hdl_update(hdl, rc);
+}
+
+/**
+ * Frees the raw data buffer, if it was allocated by the reader.
+ *
+ * buf[in,out] - buffer to free.
+ *
+ * return None.
+ */
+void sdi_sysfs_buf_release(sdi_sysfs_buf_t *buf)
+{
+    STD_ASSERT(buf != NULL);
+
+    if (buf->owned == true) {
+        free(buf->data);
+    }
+
+    memset(buf, 0, sizeof(*buf));
+}
+
+/**
+ * Closes all cached SysFs attributes.
+ *
+ * Attributes that are in use at the moment are closed once the I/O on them completes.
+ *
+ * return None.
+ */
+void sdi_sysfs_fd_cache_flush(void)
+{
+    sdi_sysfs_fd_entry_t *entry = NULL;
+
+    pthread_mutex_lock(&sdi_sysfs_fd_cache.lock);
+
+    if (sdi_sysfs_fd_cache.init == true) {
+        while ((entry = (sdi_sysfs_fd_entry_t*)std_dll_getfirst(&sdi_sysfs_fd_cache.lru)) != NULL) {
+            sdi_sysfs_fd_unlink(entry);
+        }
+    }
+
+    pthread_mutex_unlock(&sdi_sysfs_fd_cache.lock);
+}
+
+/**
+ * Sets string value for SysFs attribute.
+ *
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * val[in] - value which should be set.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_attr_str_set(const char *path, const char *attr, const char *val)
+{
+    char root_path[PATH_MAX];
+
+    if ((path == NULL) || (attr == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    path = sdi_sysfs_root_join(path, root_path, sizeof(root_path));
+
+    return sdi_sysfs_attr_write(path, attr, sdi_sysfs_path_hash(path, attr), val, strlen(val));
+}
+
+/**
+ * Gets the string value from SysFs attribute.
+ *
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * val[out] - retrieved value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_attr_str_get(const char *path, const char *attr, char *val)
+{
+    char        root_path[PATH_MAX];
+    t_std_error rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN] = {0};
+
+    if ((path == NULL) || (attr == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    path = sdi_sysfs_root_join(path, root_path, sizeof(root_path));
+
+    if ((rc = sdi_sysfs_attr_read(path, attr, sdi_sysfs_path_hash(path, attr), buf, sizeof(buf))) != STD_ERR_OK) {
+        return rc;
+    }
+
+    return sdi_sysfs_codec_str_parse(buf, sizeof(buf), val, SDI_SYSFS_VAL_MAX_LEN);
+}
+
+/**
+ * Sets the unsigned integer value for SysFs attribute.
+ *
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * val[in] - value which should be set.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_attr_uint_set(const char *path, const char *attr, uint_t val)
+{
+    char   root_path[PATH_MAX];
+    char   buf[SDI_SYSFS_VAL_MAX_LEN] = {0};
+    size_t len = 0;
+
+    if ((path == NULL) || (attr == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    path = sdi_sysfs_root_join(path, root_path, sizeof(root_path));
+
+    len = sdi_sysfs_codec_uint_format(val, buf, sizeof(buf));
+
+    return sdi_sysfs_attr_write(path, attr, sdi_sysfs_path_hash(path, attr), buf, len);
+}
+
+/**
+ * Gets the unsigned integer value from SysFs attribute.
+ *
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * val[out] - retrieved value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_attr_uint_get(const char *path, const char *attr, uint_t *val)
+{
+    char        root_path[PATH_MAX];
+    t_std_error rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN] = {0};
+
+    if ((path == NULL) || (attr == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    path = sdi_sysfs_root_join(path, root_path, sizeof(root_path));
+
+    if ((rc = sdi_sysfs_attr_read(path, attr, sdi_sysfs_path_hash(path, attr), buf, sizeof(buf))) != STD_ERR_OK) {
+        return rc;
+    }
+
+    return sdi_sysfs_codec_uint_parse(buf, sizeof(buf), val);
+}
+
+/**
+ * Gets the integer value from SysFs attribute.
+ *
+ * path[in] - path to SysFs attribute.
+ * attr[in] - name of SysFs attribute.
+ * val[out] - retrieved value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_attr_int_get(const char *path, const char *attr, int *val)
+{
+    char        root_path[PATH_MAX];
+    t_std_error rc = STD_ERR_OK;
+    char        buf[SDI_SYSFS_VAL_MAX_LEN] = {0};
+
+    if ((path == NULL) || (attr == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    path = sdi_sysfs_root_join(path, root_path, sizeof(root_path));
+
+    if ((rc = sdi_sysfs_attr_read(path, attr, sdi_sysfs_path_hash(path, attr), buf, sizeof(buf))) != STD_ERR_OK) {
+        return rc;
+    }
+
+    return sdi_sysfs_codec_int_parse(buf, sizeof(buf), val);
 }
@@ -0,0 +1,560 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/**************************************************************************************
+ * Watcher, which keeps cached values of SysFs attributes up to date.
+ *
+ * Attributes are registered in epoll for POLLPRI, which is raised by sysfs_notify().
+ * Attributes whose drivers don't notify are re-read on a timer instead.
+ ***************************************************************************************/
+
+#include "sdi_common.h"
+#include "sdi_sysfs_utils.h"
+#include "sdi_sysfs_codec.h"
+#include "sdi_sysfs_stats.h"
+#include "sdi_sysfs_trace.h"
+#include "sdi_sysfs_watch.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define SDI_SYSFS_WATCH_EVENTS_MAX 16    /**< maximum number of epoll events handled at once */
+#define SDI_SYSFS_WATCH_REFRESH_MS 10000 /**< interval of the safety re-read of notifying attributes */
+
+/**
+ * @struct sdi_sysfs_watch_s
+ * Used to hold the watched SysFs attribute and its cached value.
+ */
+struct sdi_sysfs_watch_s {
+    sdi_sysfs_hdl_t           hdl;       /**< handle of SysFs attribute */
+    uint_t                    poll_ms;   /**< interval of the timed polling */
+    int                       fd;        /**< descriptor used by the watcher, -1 if not opened */
+    bool                      notify;    /**< whether the driver was seen calling sysfs_notify() */
+    uint64_t                  next_ms;   /**< time (ms) of the next timed re-read */
+    bool                      expired;   /**< re-read requested by sdi_sysfs_watch_expire() */
+    pthread_mutex_t           lock;      /**< protects the cached value */
+    bool                      valid;     /**< whether the cached value is valid */
+    char                      value[SDI_MAX_NAME_LEN]; /**< cached raw value of the attribute */
+    struct sdi_sysfs_watch_s *next;      /**< next watched attribute */
+};
+
+/**
+ * @struct sdi_sysfs_watcher_t
+ * Used to hold the state of the watcher thread.
+ */
+typedef struct sdi_sysfs_watcher_s {
+    pthread_mutex_t       lock;    /**< protects the list and the running state */
+    sdi_sysfs_watch_hdl_t head;    /**< most recently added attribute */
+    bool                  running; /**< whether the thread is running */
+    bool                  stop;    /**< whether the thread has to exit */
+    pthread_t             thread;  /**< watcher thread */
+    int                   epfd;    /**< epoll descriptor */
+    int                   wakefd;  /**< eventfd used to wake up the thread */
+} sdi_sysfs_watcher_t;
+
+static sdi_sysfs_watcher_t sdi_sysfs_watcher = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .epfd = -1,
+    .wakefd = -1
+};
+
+/**
+ * Returns monotonic time in milliseconds.
+ *
+ * return monotonic time in milliseconds.
+ */
+static uint64_t sdi_sysfs_watch_time_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+/**
+ * Drops the cached value and closes the descriptor of the watched attribute.
+ *
+ * watch[in] - handle of the watched attribute.
+ *
+ * return None.
+ */
+static void sdi_sysfs_watch_invalidate(sdi_sysfs_watch_hdl_t watch)
+{
+    pthread_mutex_lock(&watch->lock);
+    watch->valid = false;
+    pthread_mutex_unlock(&watch->lock);
+
+    if (watch->fd >= 0) {
+        /* Closing the descriptor removes it from epoll as well */
+        close(watch->fd);
+        watch->fd = -1;
+    }
+}
+
+/**
+ * Re-reads the watched attribute and updates its cached value.
+ *
+ * Reading the attribute also re-arms the notification, so it has to be done after
+ * every POLLPRI.
+ *
+ * watch[in] - handle of the watched attribute.
+ *
+ * return None.
+ */
+static void sdi_sysfs_watch_refresh(sdi_sysfs_watch_hdl_t watch)
+{
+    char        buf[SDI_MAX_NAME_LEN] = {0};
+    ssize_t     len = -1;
+    t_std_error rc = STD_ERR_OK;
+    uint64_t    start = sdi_sysfs_stats_start();
+    uint64_t    trace = sdi_sysfs_trace_start();
+
+    len = pread(watch->fd, buf, sizeof(buf) - 1, 0);
+    rc = (len < 0) ? SDI_ERRNO : STD_ERR_OK;
+    sdi_sysfs_stats_record(start, sdi_sysfs_hdl_hash_get(watch->hdl), sdi_sysfs_hdl_path_get(watch->hdl), "", rc);
+    sdi_sysfs_trace_record(trace, SDI_SYSFS_TRACE_READ, sdi_sysfs_hdl_path_get(watch->hdl), "", buf,
+                           (len > 0) ? len : 0, rc);
+
+    if (len < 0) {
+        /* Attribute went away (e.g. the device was removed), re-open it on the timer */
+        sdi_sysfs_watch_invalidate(watch);
+        watch->next_ms = sdi_sysfs_watch_time_ms() + watch->poll_ms;
+        return;
+    }
+
+    buf[len] = '\0';
+
+    pthread_mutex_lock(&watch->lock);
+    memcpy(watch->value, buf, len + 1);
+    watch->valid = true;
+    pthread_mutex_unlock(&watch->lock);
+}
+
+/**
+ * Opens the watched attribute, reads it and registers it in epoll.
+ *
+ * Attributes which can't be registered (e.g. not SysFs files) are only polled.
+ *
+ * watch[in] - handle of the watched attribute.
+ *
+ * return None.
+ */
+static void sdi_sysfs_watch_arm(sdi_sysfs_watch_hdl_t watch)
+{
+    struct epoll_event ev = {0};
+
+    watch->next_ms = sdi_sysfs_watch_time_ms() + watch->poll_ms;
+
+    /* Without the descriptor the value is read through the handle, which the replay serves */
+    if (sdi_sysfs_trace_replaying() == true) {
+        return;
+    }
+
+    if ((watch->fd = open(sdi_sysfs_hdl_path_get(watch->hdl), O_RDONLY | O_CLOEXEC)) == -1) {
+        return;
+    }
+
+    sdi_sysfs_watch_refresh(watch);
+    if (watch->fd < 0) {
+        return;
+    }
+
+    ev.events = EPOLLPRI | EPOLLERR;
+    ev.data.ptr = watch;
+    epoll_ctl(sdi_sysfs_watcher.epfd, EPOLL_CTL_ADD, watch->fd, &ev);
+}
+
+/**
+ * Re-reads the attributes that are due for the timed polling.
+ *
+ * now[in] - current time in milliseconds.
+ *
+ * return time in milliseconds until the next timed re-read.
+ */
+static int sdi_sysfs_watch_poll(uint64_t now)
+{
+    sdi_sysfs_watch_hdl_t watch = NULL;
+    uint64_t              next = now + SDI_SYSFS_WATCH_REFRESH_MS;
+
+    pthread_mutex_lock(&sdi_sysfs_watcher.lock);
+    watch = sdi_sysfs_watcher.head;
+    pthread_mutex_unlock(&sdi_sysfs_watcher.lock);
+
+    /* Attributes are only prepended to the list, so it can be walked without the lock */
+    for (; (watch != NULL); watch = watch->next) {
+        if (__atomic_exchange_n(&watch->expired, false, __ATOMIC_ACQ_REL) || (watch->next_ms <= now)) {
+            if (watch->fd < 0) {
+                sdi_sysfs_watch_arm(watch);
+            } else {
+                watch->next_ms = now + (watch->notify ? SDI_SYSFS_WATCH_REFRESH_MS : watch->poll_ms);
+                sdi_sysfs_watch_refresh(watch);
+            }
+        }
+
+        if (watch->next_ms < next) {
+            next = watch->next_ms;
+        }
+    }
+
+    return (int)(next - now);
+}
+
+/**
+ * Main loop of the watcher thread.
+ *
+ * arg[in] - unused.
+ *
+ * return NULL.
+ */
+static void * sdi_sysfs_watch_thread(void *arg)
+{
+    struct epoll_event    events[SDI_SYSFS_WATCH_EVENTS_MAX];
+    sdi_sysfs_watch_hdl_t watch = NULL;
+    eventfd_t             val = 0;
+    int                   timeout = 0;
+    int                   count = 0;
+    int                   i = 0;
+
+    for (;;) {
+        timeout = sdi_sysfs_watch_poll(sdi_sysfs_watch_time_ms());
+
+        if ((count = epoll_wait(sdi_sysfs_watcher.epfd, events, SDI_SYSFS_WATCH_EVENTS_MAX, timeout)) < 0) {
+            continue;
+        }
+
+        for (i = 0; i < count; i++) {
+            if (events[i].data.ptr == NULL) {
+                if (__atomic_load_n(&sdi_sysfs_watcher.stop, __ATOMIC_ACQUIRE)) {
+                    return NULL;
+                }
+                /* Woken up by sdi_sysfs_watch_expire(), the timed poll does the re-read */
+                eventfd_read(sdi_sysfs_watcher.wakefd, &val);
+                continue;
+            }
+
+            watch = (sdi_sysfs_watch_hdl_t)events[i].data.ptr;
+            if (watch->fd < 0) {
+                continue;
+            }
+
+            if ((events[i].events & EPOLLPRI) != 0) {
+                watch->notify = true;
+                watch->next_ms = sdi_sysfs_watch_time_ms() + SDI_SYSFS_WATCH_REFRESH_MS;
+            }
+
+            sdi_sysfs_watch_refresh(watch);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Adds SysFs attribute to the watcher.
+ *
+ * hdl[in] - handle of SysFs attribute.
+ * poll_ms[in] - interval of the timed polling.
+ *
+ * return handle of the watched attribute.
+ */
+sdi_sysfs_watch_hdl_t sdi_sysfs_watch_add(sdi_sysfs_hdl_t hdl, uint_t poll_ms)
+{
+    sdi_sysfs_watch_hdl_t watch = NULL;
+
+    STD_ASSERT(hdl != NULL);
+    STD_ASSERT(poll_ms > 0);
+
+    watch = (sdi_sysfs_watch_hdl_t)calloc(1, sizeof(*watch));
+    STD_ASSERT(watch != NULL);
+
+    watch->hdl = hdl;
+    watch->poll_ms = poll_ms;
+    watch->fd = -1;
+    pthread_mutex_init(&watch->lock, NULL);
+
+    pthread_mutex_lock(&sdi_sysfs_watcher.lock);
+    /* Added to a running watcher, it is armed on the next timed poll */
+    watch->next = sdi_sysfs_watcher.head;
+    sdi_sysfs_watcher.head = watch;
+    pthread_mutex_unlock(&sdi_sysfs_watcher.lock);
+
+    return watch;
+}
+
+/**
+ * Closes the epoll and wake-up descriptors of the watcher.
+ *
+ * return None.
+ */
+static void sdi_sysfs_watch_close(void)
+{
+    if (sdi_sysfs_watcher.wakefd >= 0) {
+        close(sdi_sysfs_watcher.wakefd);
+        sdi_sysfs_watcher.wakefd = -1;
+    }
+
+    if (sdi_sysfs_watcher.epfd >= 0) {
+        close(sdi_sysfs_watcher.epfd);
+        sdi_sysfs_watcher.epfd = -1;
+    }
+}
+
+/**
+ * Starts the watcher thread.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_watch_start(void)
+{
+    sdi_sysfs_watch_hdl_t watch = NULL;
+    struct epoll_event    ev = {0};
+    int                   err = 0;
+
+    pthread_mutex_lock(&sdi_sysfs_watcher.lock);
+
+    if (sdi_sysfs_watcher.running == true) {
+        pthread_mutex_unlock(&sdi_sysfs_watcher.lock);
+        return SDI_ERRCODE(EALREADY); /* Operation already in progress */
+    }
+
+    /* NULL data marks the wake-up descriptor */
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+
+    if (((sdi_sysfs_watcher.epfd = epoll_create1(EPOLL_CLOEXEC)) == -1) ||
+        ((sdi_sysfs_watcher.wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1) ||
+        (epoll_ctl(sdi_sysfs_watcher.epfd, EPOLL_CTL_ADD, sdi_sysfs_watcher.wakefd, &ev) == -1)) {
+        err = errno;
+    } else {
+        for (watch = sdi_sysfs_watcher.head; (watch != NULL); watch = watch->next) {
+            sdi_sysfs_watch_arm(watch);
+        }
+
+        /* Cleared before the thread is created, so a restarted thread doesn't see the old stop */
+        __atomic_store_n(&sdi_sysfs_watcher.stop, false, __ATOMIC_RELEASE);
+
+        if ((err = pthread_create(&sdi_sysfs_watcher.thread, NULL, sdi_sysfs_watch_thread, NULL)) != 0) {
+            for (watch = sdi_sysfs_watcher.head; (watch != NULL); watch = watch->next) {
+                sdi_sysfs_watch_invalidate(watch);
+            }
+        }
+    }
+
+    if (err != 0) {
+        sdi_sysfs_watch_close();
+        pthread_mutex_unlock(&sdi_sysfs_watcher.lock);
+        SDI_ERRMSG_LOG("Failed to start SysFs watcher (errno=%d), attributes are read directly\n", err);
+        return SDI_ERRCODE(err);
+    }
+
+    sdi_sysfs_watcher.running = true;
+    pthread_mutex_unlock(&sdi_sysfs_watcher.lock);
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Stops the watcher thread.
+ *
+ * return None.
+ */
+void sdi_sysfs_watch_stop(void)
+{
+    sdi_sysfs_watch_hdl_t watch = NULL;
+
+    pthread_mutex_lock(&sdi_sysfs_watcher.lock);
+
+    if (sdi_sysfs_watcher.running == false) {
+        pthread_mutex_unlock(&sdi_sysfs_watcher.lock);
+        return;
+    }
+
+    sdi_sysfs_watcher.running = false;
+    __atomic_store_n(&sdi_sysfs_watcher.stop, true, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&sdi_sysfs_watcher.lock);
+
+    eventfd_write(sdi_sysfs_watcher.wakefd, 1);
+    pthread_join(sdi_sysfs_watcher.thread, NULL);
+
+    pthread_mutex_lock(&sdi_sysfs_watcher.lock);
+
+    for (watch = sdi_sysfs_watcher.head; (watch != NULL); watch = watch->next) {
+        sdi_sysfs_watch_invalidate(watch);
+    }
+
+    sdi_sysfs_watch_close();
+
+    pthread_mutex_unlock(&sdi_sysfs_watcher.lock);
+}
+
+/**
+ * Drops the cached value of the watched attribute and makes the watcher re-read it.
+ *
+ * watch[in] - handle of the watched attribute.
+ *
+ * return None.
+ */
+void sdi_sysfs_watch_expire(sdi_sysfs_watch_hdl_t watch)
+{
+    STD_ASSERT(watch != NULL);
+
+    sdi_sysfs_hdl_expire(watch->hdl);
+
+    pthread_mutex_lock(&watch->lock);
+    watch->valid = false;
+    pthread_mutex_unlock(&watch->lock);
+
+    __atomic_store_n(&watch->expired, true, __ATOMIC_RELEASE);
+
+    pthread_mutex_lock(&sdi_sysfs_watcher.lock);
+    if (sdi_sysfs_watcher.running == true) {
+        eventfd_write(sdi_sysfs_watcher.wakefd, 1);
+    }
+    pthread_mutex_unlock(&sdi_sysfs_watcher.lock);
+}
+
+/**
+ * Gets the cached string value of the watched attribute.
+ *
+ * watch[in] - handle of the watched attribute.
+ * val[out] - retrieved value.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_sysfs_watch_str_get(sdi_sysfs_watch_hdl_t watch, char *val)
+{
+    t_std_error rc = STD_ERR_OK;
+
+    if ((watch == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    pthread_mutex_lock(&watch->lock);
+
+    if (watch->valid == true) {
+        rc = sdi_sysfs_codec_str_parse(watch->value, sizeof(watch->value), val, SDI_MAX_NAME_LEN);
+        pthread_mutex_unlock(&watch->lock);
+        return rc;
+    }
+
+    pthread_mutex_unlock(&watch->lock);
+
+    return sdi_sysfs_hdl_str_get(watch->hdl, val);
+}
+
+/**
+ * Gets the cached string value of the watched attribute, reading it within a deadline
+ * if there is none.
+ *
+ * watch[in] - handle of the watched attribute.
+ * timeout_ms[in] - time to wait for the direct read.
+ * val[out] - retrieved value, the last known one on timeout.
+ *
+ * return STD_ERR_OK on success, ETIMEDOUT if the deadline passed and standard error
+ * on other failures.
+ */
+t_std_error sdi_sysfs_watch_str_get_timed(sdi_sysfs_watch_hdl_t watch, uint_t timeout_ms, char *val)
+{
+    t_std_error rc = STD_ERR_OK;
+
+    if ((watch == NULL) || (val == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    pthread_mutex_lock(&watch->lock);
+
+    if (watch->valid == true) {
+        rc = sdi_sysfs_codec_str_parse(watch->value, sizeof(watch->value), val, SDI_MAX_NAME_LEN);
+        pthread_mutex_unlock(&watch->lock);
+        return rc;
+    }
+
+    pthread_mutex_unlock(&watch->lock);
+
+    return sdi_sysfs_hdl_str_get_timed(watch->hdl, timeout_ms, val);
+}
+
+/**
+ * Gets the cached string values of several watched attributes at once.
+ *
+ * items[in,out] - attributes to get, the values and results are stored in them.
+ * count[in] - number of items.
+ *
+ * return STD_ERR_OK if all values were retrieved, otherwise the result of the first
+ * failed item.
+ */
+t_std_error sdi_sysfs_watch_batch_str_get(sdi_sysfs_watch_batch_item_t *items, size_t count)
+{
+    sdi_sysfs_batch_item_t *misses = NULL;
+    size_t                 *miss_index = NULL;
+    size_t                  miss_count = 0;
+    size_t                  i = 0;
+    bool                    cached = false;
+    t_std_error             rc = STD_ERR_OK;
+
+    STD_ASSERT((items != NULL) || (count == 0));
+
+    for (i = 0; i < count; i++) {
+        if (items[i].watch == NULL) {
+            items[i].rc = SDI_ERRCODE(EINVAL); /* Invalid argument */
+            continue;
+        }
+
+        pthread_mutex_lock(&items[i].watch->lock);
+        cached = items[i].watch->valid;
+        if (cached == true) {
+            items[i].rc = sdi_sysfs_codec_str_parse(items[i].watch->value, sizeof(items[i].watch->value),
+                                                    items[i].val, sizeof(items[i].val));
+        }
+        pthread_mutex_unlock(&items[i].watch->lock);
+
+        if (cached == false) {
+            /* The remaining items are the most which may miss */
+            if (miss_index == NULL) {
+                miss_index = (size_t*)calloc(count - i, sizeof(*miss_index));
+                STD_ASSERT(miss_index != NULL);
+            }
+            miss_index[miss_count++] = i;
+        }
+    }
+
+    if (miss_count > 0) {
+        misses = (sdi_sysfs_batch_item_t*)calloc(miss_count, sizeof(*misses));
+        STD_ASSERT(misses != NULL);
+
+        for (i = 0; i < miss_count; i++) {
+            misses[i].hdl = items[miss_index[i]].watch->hdl;
+        }
+
+        /* Read directly, as sdi_sysfs_watch_str_get() does, but in one round */
+        sdi_sysfs_attr_batch_get(misses, miss_count);
+
+        for (i = 0; i < miss_count; i++) {
+            items[miss_index[i]].rc = misses[i].rc;
+            if (misses[i].rc == STD_ERR_OK) {
+                memcpy(items[miss_index[i]].val, misses[i].val.str_val, sizeof(items[miss_index[i]].val));
+            }
+        }
+
+        free(misses);
+    }
+
+    free(miss_index);
+
+    for (i = 0; i < count; i++) {
+        if (items[i].rc != STD_ERR_OK) {
+            rc = items[i].rc;
+            break;
+        }
+    }
+
+    return rc;
+}
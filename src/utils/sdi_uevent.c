@@ -0,0 +1,269 @@
+/*
+ * Copyright Mellanox Technologies, Ltd. 2001-2017.
+ * This software product is licensed under Apache version 2, as detailed in
+ * the LICENSE file.
+ */
+
+
+/**************************************************************************************
+ * Listener of kernel kobject uevents.
+ ***************************************************************************************/
+
+#include "sdi_common.h"
+#include "sdi_uevent.h"
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <linux/netlink.h>
+
+#define SDI_UEVENT_RCVBUF_SIZE (1024 * 1024) /**< receive buffer, big enough for bursts on hotplug */
+
+/**
+ * @struct sdi_uevent_listener_t
+ * Used to hold the state of the listener thread.
+ */
+typedef struct sdi_uevent_listener_s {
+    pthread_mutex_t      lock;    /**< protects the running state */
+    bool                 running; /**< whether the thread is running */
+    pthread_t            thread;  /**< listener thread */
+    int                  fd;      /**< descriptor uevents are received from */
+    int                  stopfd;  /**< eventfd used to stop the thread */
+    sdi_uevent_handler_t handler; /**< callback called for every uevent */
+    void                *data;    /**< user data of the callback */
+} sdi_uevent_listener_t;
+
+static sdi_uevent_listener_t sdi_uevent_listener = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .fd = -1,
+    .stopfd = -1
+};
+
+/**
+ * Opens netlink socket, which receives kernel kobject uevents.
+ *
+ * return descriptor of the socket on success and -1 with errno set on failure.
+ */
+int sdi_uevent_socket_open(void)
+{
+    struct sockaddr_nl addr = {0};
+    int                size = SDI_UEVENT_RCVBUF_SIZE;
+    int                fd = -1;
+    int                err = 0;
+
+    if ((fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT)) == -1) {
+        return -1;
+    }
+
+    /* Group 1 delivers the kernel events, udev re-broadcasts are in group 2 */
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = 1;
+
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+        err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * Parses uevent message.
+ *
+ * buf[in] - message, its last byte is overwritten with NUL.
+ * len[in] - length of the message.
+ * event[out] - parsed uevent.
+ *
+ * return STD_ERR_OK on success, EINVAL if the message is malformed and ENOTSUP if the
+ * action is not handled.
+ */
+t_std_error sdi_uevent_parse(char *buf, size_t len, sdi_uevent_t *event)
+{
+    const char *action = NULL;
+    char       *key = NULL;
+    size_t      pos = 0;
+
+    STD_ASSERT(buf != NULL);
+    STD_ASSERT(event != NULL);
+
+    if (len == 0) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    /* Kernel terminates every field, make sure a truncated message is terminated too */
+    buf[len - 1] = '\0';
+
+    /* Header "action@devpath" is not needed, the same data follows as key-value pairs */
+    if (strchr(buf, '@') == NULL) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    event->devpath = NULL;
+    event->subsystem = "";
+
+    for (pos = strlen(buf) + 1; (pos < len); pos += strlen(key) + 1) {
+        key = &buf[pos];
+
+        if (strncmp(key, "ACTION=", strlen("ACTION=")) == 0) {
+            action = key + strlen("ACTION=");
+        } else if (strncmp(key, "DEVPATH=", strlen("DEVPATH=")) == 0) {
+            event->devpath = key + strlen("DEVPATH=");
+        } else if (strncmp(key, "SUBSYSTEM=", strlen("SUBSYSTEM=")) == 0) {
+            event->subsystem = key + strlen("SUBSYSTEM=");
+        }
+    }
+
+    if ((action == NULL) || (event->devpath == NULL)) {
+        return SDI_ERRCODE(EINVAL); /* Invalid argument */
+    }
+
+    if (strcmp(action, "add") == 0) {
+        event->action = SDI_UEVENT_ADD;
+    } else if (strcmp(action, "remove") == 0) {
+        event->action = SDI_UEVENT_REMOVE;
+    } else if (strcmp(action, "change") == 0) {
+        event->action = SDI_UEVENT_CHANGE;
+    } else {
+        return SDI_ERRCODE(ENOTSUP); /* Operation not supported */
+    }
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Receives one uevent message and passes it to the handler.
+ *
+ * Messages sent over netlink by anybody but the kernel are dropped.
+ *
+ * return None.
+ */
+static void sdi_uevent_receive(void)
+{
+    char               buf[SDI_UEVENT_MSG_MAX_LEN];
+    struct sockaddr_nl addr = {0};
+    struct iovec       iov = {.iov_base = buf, .iov_len = sizeof(buf)};
+    struct msghdr      msg = {.msg_name = &addr, .msg_namelen = sizeof(addr), .msg_iov = &iov, .msg_iovlen = 1};
+    sdi_uevent_t       event;
+    ssize_t            len = -1;
+
+    if ((len = recvmsg(sdi_uevent_listener.fd, &msg, MSG_DONTWAIT)) <= 0) {
+        return;
+    }
+
+    if ((msg.msg_namelen == sizeof(addr)) && (addr.nl_family == AF_NETLINK) && (addr.nl_pid != 0)) {
+        return;
+    }
+
+    if (sdi_uevent_parse(buf, len, &event) == STD_ERR_OK) {
+        sdi_uevent_listener.handler(&event, sdi_uevent_listener.data);
+    }
+}
+
+/**
+ * Main loop of the listener thread.
+ *
+ * arg[in] - unused.
+ *
+ * return NULL.
+ */
+static void * sdi_uevent_thread(void *arg)
+{
+    struct pollfd fds[2] = {
+        {.fd = sdi_uevent_listener.fd, .events = POLLIN},
+        {.fd = sdi_uevent_listener.stopfd, .events = POLLIN}
+    };
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            continue;
+        }
+
+        if (fds[1].revents != 0) {
+            return NULL;
+        }
+
+        if ((fds[0].revents & POLLIN) != 0) {
+            sdi_uevent_receive();
+        } else if (fds[0].revents != 0) {
+            /* Peer of the injected descriptor went away */
+            fds[0].fd = -1;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Starts the thread which receives uevents from the descriptor.
+ *
+ * fd[in] - descriptor to receive uevents from.
+ * handler[in] - callback called for every handled uevent.
+ * data[in] - user data passed to the callback.
+ *
+ * return STD_ERR_OK on success and standard error on failure.
+ */
+t_std_error sdi_uevent_listener_start(int fd, sdi_uevent_handler_t handler, void *data)
+{
+    int err = 0;
+
+    STD_ASSERT(fd >= 0);
+    STD_ASSERT(handler != NULL);
+
+    pthread_mutex_lock(&sdi_uevent_listener.lock);
+
+    if (sdi_uevent_listener.running == true) {
+        pthread_mutex_unlock(&sdi_uevent_listener.lock);
+        return SDI_ERRCODE(EALREADY); /* Operation already in progress */
+    }
+
+    sdi_uevent_listener.fd = fd;
+    sdi_uevent_listener.handler = handler;
+    sdi_uevent_listener.data = data;
+
+    if ((sdi_uevent_listener.stopfd = eventfd(0, EFD_CLOEXEC)) == -1) {
+        err = errno;
+    } else if ((err = pthread_create(&sdi_uevent_listener.thread, NULL, sdi_uevent_thread, NULL)) != 0) {
+        close(sdi_uevent_listener.stopfd);
+        sdi_uevent_listener.stopfd = -1;
+    }
+
+    if (err != 0) {
+        close(fd);
+        sdi_uevent_listener.fd = -1;
+        pthread_mutex_unlock(&sdi_uevent_listener.lock);
+        return SDI_ERRCODE(err);
+    }
+
+    sdi_uevent_listener.running = true;
+    pthread_mutex_unlock(&sdi_uevent_listener.lock);
+
+    return STD_ERR_OK;
+}
+
+/**
+ * Stops the listener thread and closes its descriptor.
+ *
+ * return None.
+ */
+void sdi_uevent_listener_stop(void)
+{
+    pthread_mutex_lock(&sdi_uevent_listener.lock);
+
+    if (sdi_uevent_listener.running == true) {
+        eventfd_write(sdi_uevent_listener.stopfd, 1);
+        pthread_join(sdi_uevent_listener.thread, NULL);
+
+        close(sdi_uevent_listener.stopfd);
+        close(sdi_uevent_listener.fd);
+        sdi_uevent_listener.stopfd = -1;
+        sdi_uevent_listener.fd = -1;
+        sdi_uevent_listener.running = false;
+    }
+
+    pthread_mutex_unlock(&sdi_uevent_listener.lock);
+}
@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+#
+# Copyright Mellanox Technologies, Ltd. 2001-2017.
+# This software product is licensed under Apache version 2, as detailed in
+# the LICENSE file.
+#
+
+"""Builds a simulated SysFs tree from the SDI entity.xml and device.xml.
+
+Every attribute referenced by the configs is created under ROOT with a plausible
+value: entities present and healthy, fans spinning, LEDs off, temperatures at
+45 C and EEPROMs holding valid ONIE or Mellanox blobs. The configs are copied to
+ROOT/etc/opx/sdi. Point the library at the tree with the printed environment:
+
+    SDI_SYSFS_ROOT     - prefix of all SysFs paths
+    SDI_CONFIG_DIR     - directory of entity.xml and device.xml
+    SDI_SYSFS_DELAY_US - latency added to each SysFs access (--delay-us)
+
+Put ROOT on tmpfs (e.g. under /dev/shm), so the tree itself adds no latency.
+"""
+
+import argparse
+import os
+import shutil
+import struct
+import sys
+import xml.etree.ElementTree as ET
+import zlib
+
+TEMPERATURE = '45000'
+FAN_SPEED = '12000'
+FAN_MAX_SPEED = '21000'
+FAN_PWM = '153'
+POWER_RATING = '650000'
+EEPROM_SIZE = 256
+
+
+def onie_eeprom(name):
+    """ONIE TlvInfo system EEPROM."""
+    tlvs = [(0x21, name.encode()), (0x22, b'SIM-PN-0001'), (0x23, b'SIM-SN-0001'),
+            (0x24, bytes([0x00, 0x02, 0xc9, 0x00, 0x00, 0x01])), (0x27, b'A1'),
+            (0x28, b'x86_64-sim-r0'), (0x2a, struct.pack('>H', 128)), (0x2b, b'Simulated')]
+    body = b''.join(struct.pack('BB', t, len(v)) + v for t, v in tlvs)
+    data = b'TlvInfo\x00' + struct.pack('>BH', 1, len(body) + 6) + body + b'\xfe\x04'
+    return data + struct.pack('>I', zlib.crc32(data) & 0xffffffff)
+
+
+def fan_mlnx_eeprom(name):
+    """Mellanox fan EEPROM: block 1 at 32 and block 2 at 160."""
+    data = bytearray(EEPROM_SIZE)
+    data[8:12] = b'MLNX'
+    data[12:16] = bytes([2, 1, 10, 5])
+    data[40:64] = b'SIM-FAN-SN-0001'.ljust(24, b'\x00')
+    data[64:84] = b'SIM-FAN-PN-0001'.ljust(20, b'\x00')
+    data[84:88] = b'A1'.ljust(4, b'\x00')
+    data[92:156] = name.encode()[:63].ljust(64, b'\x00')
+    data[174] = 1  # normal air flow
+    return bytes(data)
+
+
+def psu_mlnx_eeprom(name):
+    """Mellanox PSU EEPROM: serial, part number and revision after the sanity string."""
+    data = bytearray(EEPROM_SIZE)
+    data[16:20] = b'MLNX'
+    data[20:44] = b'SIM-PSU-SN-0001'.ljust(24, b'\x00')
+    data[44:64] = b'SIM-PSU-PN-0001'.ljust(20, b'\x00')
+    data[64:68] = b'A1'.ljust(4, b'\x00')
+    return bytes(data)
+
+
+EEPROMS = {
+    'SDI_EEPROM_SYS_ONIE': onie_eeprom,
+    'SDI_EEPROM_FAN_MLNX': fan_mlnx_eeprom,
+    'SDI_EEPROM_PSU_MLNX': psu_mlnx_eeprom,
+}
+
+
+class Tree(object):
+    def __init__(self, root):
+        self.root = root
+        self.count = 0
+
+    def write(self, path, name, value):
+        full = os.path.join(self.root, path.lstrip('/'), name)
+        os.makedirs(os.path.dirname(full), exist_ok=True)
+        with open(full, 'wb') as f:
+            f.write(value if isinstance(value, bytes) else value.encode())
+        self.count += 1
+
+
+def child_by_name(node, name):
+    """Same exact-match lookup as sdi_settings_get_child_by_name(), the first duplicate wins."""
+    for child in node:
+        if child.get('name') == name:
+            return child
+    sys.exit('device.xml: no settings named "%s" under "%s"' % (name, node.get('name')))
+
+
+def add_resource(tree, res_type, node):
+    path = node.get('path')
+
+    if res_type == 'SDI_RESOURCE_TEMPERATURE':
+        tree.write(path, node.get('name'), TEMPERATURE)
+    elif res_type == 'SDI_RESOURCE_LED':
+        tree.write(path, node.get('name'), list(node)[0].get('off'))
+    elif res_type == 'SDI_RESOURCE_ENTITY_INFO':
+        tree.write(path, node.get('name'), EEPROMS[node.get('type')](node.get('name')))
+    elif res_type == 'SDI_RESOURCE_MEDIA':
+        tree.write(path, node.get('status'), '0' if node.get('not_present') != '0' else '1')
+    elif res_type == 'SDI_RESOURCE_FAN':
+        for child in node:
+            if child.tag == 'speed':
+                for attr, value in (('set', FAN_PWM), ('get', FAN_SPEED), ('max_get', FAN_MAX_SPEED)):
+                    if child.get(attr) is not None:
+                        tree.write(path, child.get(attr), value)
+            elif (child.tag == 'status') and (child.get('get') is not None):
+                tree.write(path, child.get('get'), '0' if child.get('fault') != '0' else '1')
+
+
+def add_entity(tree, entity, settings_root, absent):
+    alias = entity.get('alias')
+    settings = child_by_name(settings_root, alias)
+
+    presence = entity.get('presence')
+    if presence != 'fixed':
+        node = child_by_name(settings, presence)
+        state = 'not_present' if alias in absent else 'present'
+        tree.write(node.get('path'), node.get('name'), node.get(state))
+
+    if entity.get('fault') is not None:
+        node = child_by_name(settings, entity.get('fault'))
+        tree.write(node.get('path'), node.get('name'), node.get('ok'))
+
+    if entity.get('type') == 'SDI_ENTITY_PSU_TRAY':
+        for node in settings:
+            if node.tag == 'power':
+                tree.write(node.get('path'), node.get('name'), node.get('present'))
+            elif node.tag == 'rating':
+                tree.write(node.get('path'), node.get('name'), POWER_RATING)
+
+    if entity.get('power_ctl') is not None:
+        node = child_by_name(settings, entity.get('power_ctl'))
+        if node.get('reset') is not None:
+            tree.write(node.get('path'), node.get('reset'), '0')
+        if node.get('powerhdl') is not None:
+            tree.write(node.get('path'), node.get('powerhdl'), node.get('power_on', '1'))
+
+    for resource in entity:
+        node = child_by_name(settings, resource.get('reference'))
+        add_resource(tree, resource.get('type'), node)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('root', help='directory of the simulated tree, preferably on tmpfs')
+    parser.add_argument('--config-dir', default='/etc/opx/sdi', help='directory of entity.xml and device.xml')
+    parser.add_argument('--absent', action='append', default=[], metavar='ALIAS',
+                        help='create the entity as not present, may be repeated')
+    parser.add_argument('--delay-us', type=int, default=0, help='latency added to each SysFs access')
+    args = parser.parse_args()
+
+    entity_file = os.path.join(args.config_dir, 'entity.xml')
+    device_file = os.path.join(args.config_dir, 'device.xml')
+    tree = Tree(os.path.abspath(args.root))
+
+    settings_root = ET.parse(device_file).getroot()
+    for entity in ET.parse(entity_file).getroot():
+        add_entity(tree, entity, settings_root, args.absent)
+
+    config_dir = os.path.join(tree.root, 'etc', 'opx', 'sdi')
+    os.makedirs(config_dir, exist_ok=True)
+    shutil.copy(entity_file, config_dir)
+    shutil.copy(device_file, config_dir)
+
+    sys.stderr.write('Created %d attributes under %s\n' % (tree.count, tree.root))
+    print('export SDI_SYSFS_ROOT=%s' % tree.root)
+    print('export SDI_CONFIG_DIR=%s' % config_dir)
+    print('export SDI_SYSFS_DELAY_US=%d' % args.delay_us)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+#
+# Copyright Mellanox Technologies, Ltd. 2001-2017.
+# This software product is licensed under Apache version 2, as detailed in
+# the LICENSE file.
+#
+
+"""Compiles the SDI entity.xml and device.xml into a binary snapshot.
+
+The configs are validated the way sdi_config_reload() validates them, with the
+required attributes read from sdi_config_required.txt next to the compiler, the
+file the library's table is generated from. Then their elements and
+attributes are written as flat tables, in the layout of
+include/sdi_config_snapshot.h, to CONFIG_DIR/platform.sdb by default. The library
+maps the snapshot instead of parsing the XML while the snapshot is not older than
+either file; rerun the compiler after editing them.
+
+The snapshot uses the byte order of the machine running the compiler.
+
+With --c-source the same tables are written as C source defining
+sdi_config_builtin instead, for the library built with --with-platform-config.
+
+With --c-required only the table of the required attributes is written, as a C
+header for the library build.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import xml.etree.ElementTree as ET
+import zlib
+
+MAGIC = b'SDISNAP\x00'
+VERSION = 1
+NONE = 0xffffffff
+HDR = struct.Struct('=8s8I')
+NODE = struct.Struct('=5I')
+ATTR = struct.Struct('=2I')
+
+ENTITY_TYPES = ('SDI_ENTITY_SYSTEM_BOARD', 'SDI_ENTITY_FAN_TRAY', 'SDI_ENTITY_PSU_TRAY')
+REQUIRED_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'sdi_config_required.txt')
+
+
+def load_required(path):
+    """Attributes required by each kind of settings, in the order of the file."""
+    required = []
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            fields = line.split('#', 1)[0].split()
+            if not fields:
+                continue
+            if (len(fields) < 2) or any(re.match(r'^\w+$', field) is None for field in fields):
+                sys.exit('%s:%d: expected a kind and its required attributes' % (path, number))
+            required.append((fields[0], tuple(fields[1:])))
+    return required
+
+
+def build_required_c(required):
+    """C header defining the table of sdi_config_required_check()."""
+    lines = ['/* Generated by tools/sdi_snapshot_compile.py from tools/sdi_config_required.txt, do not edit */',
+             '',
+             '#define SDI_CONFIG_REQUIRED_MAX %u /**< maximal number of attributes required by one kind of settings */'
+             % max(len(attrs) for kind, attrs in required),
+             '',
+             '#define SDI_CONFIG_REQUIRED_TABLE \\']
+    width = max(len(kind) for kind, attrs in required) + 3
+    for kind, attrs in required:
+        lines.append('    { %-*s { %s } }, \\' % (width, '"%s",' % kind, ', '.join('"%s"' % a for a in attrs)))
+    lines += ['', '']
+    return '\n'.join(lines).encode()
+
+
+class Checker(object):
+    def __init__(self, required):
+        self.errors = []
+        self.required = dict(required)
+
+    def error(self, msg):
+        self.errors.append(msg)
+
+    def require(self, node, attrs, where):
+        for attr in attrs:
+            if node.get(attr) is None:
+                self.error('%s: missing attribute "%s"' % (where, attr))
+
+    def index(self, parent, where):
+        """Named children of the node, as indexed by sdi_settings_index_build()."""
+        children = {}
+        for child in parent:
+            name = child.get('name')
+            if name is None:
+                continue
+            if name in children:
+                self.error('%s: duplicate settings "%s"' % (where, name))
+            else:
+                children[name] = child
+        return children
+
+    def settings(self, node, kind, where):
+        """Same as sdi_config_required_check()."""
+        if kind not in self.required:
+            self.error('%s: unsupported %s' % (where, kind))
+        elif node is None:
+            self.error('%s: no settings for %s' % (where, kind))
+        else:
+            self.require(node, self.required[kind], '%s: %s' % (where, node.get('name')))
+
+    def check(self, entities, settings):
+        """Same as sdi_config_entity_check(), for every entity."""
+        by_alias = self.index(settings, 'device.xml')
+
+        for entity in entities:
+            where = 'entity.xml: %s' % entity.tag
+            self.require(entity, ('instance', 'type', 'presence', 'alias'), where)
+            if entity.get('type') not in ENTITY_TYPES:
+                self.error('%s: unknown type "%s"' % (where, entity.get('type')))
+
+            node = by_alias.get(entity.get('alias'))
+            if node is None:
+                self.error('%s: no settings for alias "%s"' % (where, entity.get('alias')))
+                continue
+
+            where = 'device.xml: %s' % entity.get('alias')
+            children = self.index(node, where)
+
+            for attr in ('presence', 'fault', 'power_ctl'):
+                name = entity.get(attr)
+                if (name is None) or ((attr == 'presence') and (name == 'fixed')):
+                    continue
+                self.settings(children.get(name), attr, where)
+
+            if entity.get('type') == 'SDI_ENTITY_PSU_TRAY':
+                if not (node.get('type') or '').startswith(('AC', 'DC')):
+                    self.error('%s: power type must be AC or DC' % where)
+                for child in node:
+                    if child.tag in ('power', 'rating'):
+                        self.settings(child, child.tag, where)
+
+            for resource in entity:
+                res_where = '%s: %s' % (where, resource.get('name'))
+                self.require(resource, ('reference', 'name', 'type'), res_where)
+                child = children.get(resource.get('reference'))
+                self.settings(child, resource.get('type'), res_where)
+
+                # The LED states are in the first child
+                if (resource.get('type') == 'SDI_RESOURCE_LED') and (child is not None):
+                    states = child[0] if len(child) > 0 else None
+                    if (states is None) or (states.get('on') is None) or (states.get('off') is None):
+                        self.error('%s: LED lacks the on and off states' % res_where)
+
+
+class Snapshot(object):
+    def __init__(self):
+        self.nodes = []
+        self.attrs = []
+        self.strings = bytearray()
+        self.offsets = {}
+
+    def string(self, value):
+        if value not in self.offsets:
+            self.offsets[value] = len(self.strings)
+            self.strings += value.encode() + b'\x00'
+        return self.offsets[value]
+
+    def add(self, elem):
+        """Adds the element and its subtree in document order, returns its index."""
+        index = len(self.nodes)
+        node = [self.string(elem.tag), len(self.attrs), len(elem.attrib), NONE, NONE]
+        self.nodes.append(node)
+        for name, value in elem.attrib.items():
+            self.attrs.append((self.string(name), self.string(value)))
+
+        prev = None
+        for child in elem:
+            child_index = self.add(child)
+            if prev is None:
+                node[3] = child_index
+            else:
+                self.nodes[prev][4] = child_index
+            prev = child_index
+        return index
+
+    def build(self, roots):
+        body = b''.join(NODE.pack(*node) for node in self.nodes)
+        body += b''.join(ATTR.pack(*attr) for attr in self.attrs)
+        body += bytes(self.strings)
+        size = HDR.size + len(body)
+        return HDR.pack(MAGIC, VERSION, size, zlib.crc32(body) & 0xffffffff, len(self.nodes),
+                        len(self.attrs), len(self.strings), *roots) + body
+
+    def c_string(self, offset):
+        end = self.strings.index(b'\x00', offset)
+        chars = []
+        for c in self.strings[offset:end]:
+            if (c < 0x20) or (c > 0x7e) or (c in b'"\\?'):
+                chars.append('\\%03o' % c)
+            else:
+                chars.append(chr(c))
+        return ''.join(chars)
+
+    def build_c(self, roots, config_dir):
+        lines = ['/* Generated by tools/sdi_snapshot_compile.py from %s, do not edit */' % config_dir,
+                 '',
+                 '#include "sdi_config_snapshot.h"',
+                 '',
+                 'static const sdi_config_snapshot_node_t sdi_config_builtin_nodes[] = {']
+        for node in self.nodes:
+            fields = ['%5u' % v if v != NONE else 'SDI_CONFIG_SNAPSHOT_NONE' for v in node]
+            lines.append('    { %s }, /* %s */' % (', '.join(fields), self.c_string(node[0])))
+        lines += ['};', '', 'static const sdi_config_snapshot_attr_t sdi_config_builtin_attrs[] = {']
+        for attr in (self.attrs or [(0, 0)]):
+            lines.append('    { %5u, %5u },' % attr)
+        lines += ['};', '', 'static const char sdi_config_builtin_strings[] =']
+        offset = 0
+        while offset < len(self.strings):
+            lines.append('    "%s\\0" /* %u */' % (self.c_string(offset), offset))
+            offset = self.strings.index(b'\x00', offset) + 1
+        lines[-1] += ';'
+        lines += ['',
+                  'const sdi_config_snapshot_tables_t sdi_config_builtin = {',
+                  '    .nodes      = sdi_config_builtin_nodes,',
+                  '    .attrs      = sdi_config_builtin_attrs,',
+                  '    .strings    = sdi_config_builtin_strings,',
+                  '    .node_count = %u,' % len(self.nodes),
+                  '    .roots      = { %u, %u }' % roots,
+                  '};',
+                  '']
+        return '\n'.join(lines).encode()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--config-dir', default='/etc/opx/sdi', help='directory of entity.xml and device.xml')
+    parser.add_argument('-o', '--output', help='snapshot file, CONFIG_DIR/platform.sdb by default')
+    parser.add_argument('--c-source', metavar='FILE', help='write the tables as C source instead of the snapshot')
+    parser.add_argument('--c-required', metavar='FILE', help='write only the required attributes as a C header')
+    args = parser.parse_args()
+
+    required = load_required(REQUIRED_FILE)
+    if args.c_required is not None:
+        with open(args.c_required + '.tmp', 'wb') as f:
+            f.write(build_required_c(required))
+        os.rename(args.c_required + '.tmp', args.c_required)
+        return
+
+    entities = ET.parse(os.path.join(args.config_dir, 'entity.xml')).getroot()
+    settings = ET.parse(os.path.join(args.config_dir, 'device.xml')).getroot()
+
+    checker = Checker(required)
+    checker.check(entities, settings)
+    if checker.errors:
+        sys.exit('\n'.join(checker.errors))
+
+    snapshot = Snapshot()
+    roots = (snapshot.add(entities), snapshot.add(settings))
+    if args.c_source is not None:
+        output = args.c_source
+        data = snapshot.build_c(roots, args.config_dir)
+    else:
+        output = args.output or os.path.join(args.config_dir, 'platform.sdb')
+        data = snapshot.build(roots)
+
+    with open(output + '.tmp', 'wb') as f:
+        f.write(data)
+    os.rename(output + '.tmp', output)
+
+    sys.stderr.write('%s: %d nodes, %d attributes, %d bytes\n' % (output, len(snapshot.nodes),
+                                                                 len(snapshot.attrs), len(data)))
+
+
+if __name__ == '__main__':
+    main()
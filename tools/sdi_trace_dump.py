@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+#
+# Copyright Mellanox Technologies, Ltd. 2001-2017.
+# This software product is licensed under Apache version 2, as detailed in
+# the LICENSE file.
+#
+
+"""Summarizes a trace of the hardware accesses recorded by SDI_TRACE_RECORD.
+
+Prints the number of accesses, failures and the total and maximum latency of each
+accessed attribute or register, sorted by the total latency. With --list every
+access is printed in the recorded order instead.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b'SDITRACE'
+VERSION = 1
+OPS = {1: 'read', 2: 'write', 3: 'reg_get', 4: 'reg_set'}
+NAME = struct.Struct('=BIH')
+ACCESS = struct.Struct('=BIQIiI')
+
+
+def records(data):
+    """Yields (op, name, time_ns, latency_ns, rc, payload) of every access."""
+    if (data[:8] != MAGIC) or (struct.unpack_from('=I', data, 8)[0] != VERSION):
+        sys.exit('not a version %d trace' % VERSION)
+
+    names = []
+    pos = 16
+    while pos < len(data):
+        if data[pos] == 0:
+            _, _, length = NAME.unpack_from(data, pos)
+            pos += NAME.size
+            names.append(data[pos:pos + length].decode(errors='replace'))
+            pos += length
+            continue
+
+        op, name_id, time_ns, lat_ns, rc, length = ACCESS.unpack_from(data, pos)
+        pos += ACCESS.size
+        yield OPS.get(op, str(op)), names[name_id], time_ns, lat_ns, rc, data[pos:pos + length]
+        pos += length
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('trace', help='recorded trace file')
+    parser.add_argument('--list', action='store_true', help='print every access')
+    args = parser.parse_args()
+
+    with open(args.trace, 'rb') as f:
+        data = f.read()
+
+    if args.list:
+        for op, name, time_ns, lat_ns, rc, payload in records(data):
+            print('%12.6f %-7s %-60s %8.1f us rc=%d %r' % (time_ns / 1e9, op, name, lat_ns / 1e3, rc, payload[:32]))
+        return
+
+    stats = {}
+    for op, name, _, lat_ns, rc, _ in records(data):
+        entry = stats.setdefault((op, name), [0, 0, 0, 0])
+        entry[0] += 1
+        entry[1] += (rc != 0)
+        entry[2] += lat_ns
+        entry[3] = max(entry[3], lat_ns)
+
+    print('%-7s %-60s %8s %6s %12s %10s' % ('op', 'name', 'calls', 'errors', 'total us', 'max us'))
+    for (op, name), (calls, errors, total, worst) in sorted(stats.items(), key=lambda i: -i[1][2]):
+        print('%-7s %-60s %8d %6d %12.1f %10.1f' % (op, name, calls, errors, total / 1e3, worst / 1e3))
+    print('total: %d accesses' % sum(entry[0] for entry in stats.values()))
+
+
+if __name__ == '__main__':
+    main()